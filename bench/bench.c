@@ -0,0 +1,389 @@
+/**
+ * @file bench.c
+ * @author M3tex
+ * @brief Programme de benchmark des moteurs (voir 'make bench').
+ *
+ * Chaque cas (un motif de templates/ ou une configuration aléatoire, avec un
+ * moteur) est lancé dans un processus à part: on mesure la durée de chaque
+ * appel à maj_grille(), et la mémoire maximale utilisée par le processus.
+ * Les résultats sont écrits dans un fichier JSON (un cas par ligne), qui peut
+ * servir de référence pour détecter les régressions lors des lancements suivants.
+ * @version 0.1
+ * @date 2022-12-20
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <glob.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "types.h"
+#include "logique.h"
+#include "affichage.h"
+#include "simd.h"
+#include "table.h"
+#include "regle.h"
+#include "utilitaires.h"
+
+
+
+// Nombre maximal de cas, et de générations mesurées par cas
+#define NB_CAS_MAX 256
+#define NB_GENERATIONS_MAX 100000
+
+// Générations calculées avant de commencer à mesurer
+#define NB_ECHAUFFEMENT 5
+
+
+
+/**
+ * @brief Un cas du benchmark et ses résultats.
+ *
+ * nom: le nom du cas ('motif/moteur' ou 'soupe-taille-densité/moteur')
+ *
+ * fichier: le motif à charger au centre de la grille (NULL pour une configuration aléatoire)
+ *
+ * densite: la proportion de cellules vivantes de la configuration aléatoire
+ *
+ * mediane_ms, p95_ms: la médiane et le 95ème centile de la durée d'une génération
+ *
+ * cellules_par_s: le nombre de cellules de la grille mises à jour par seconde
+ *
+ * rss_max_ko: la mémoire maximale utilisée par le processus
+ */
+typedef struct Cas {
+    char nom[128];
+    const char *fichier;
+    unsigned int taille;
+    double densite;
+    Moteur moteur;
+
+    double mediane_ms;
+    double p95_ms;
+    double cellules_par_s;
+    long int rss_max_ko;
+} Cas;
+
+
+
+// Dans l'ordre de l'énumération Moteur
+static const char *noms_moteurs[NB_MOTEURS] = {"scalaire", "bitboard", "simd", "hashlife", "univers", "table"};
+
+
+
+
+/**
+ * @brief Fonction de comparaison pour qsort() sur des double.
+ */
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *) a, y = *(const double *) b;
+    return (x > y) - (x < y);
+}
+
+
+
+/**
+ * @brief Retourne la largeur d'un motif (1ère ligne d'un fichier.gol), 0 si
+ * le fichier ne peut pas être lu.
+ */
+static unsigned int largeur_motif(const char *fichier)
+{
+    FILE *f = fopen(fichier, "r");
+    if (f == NULL) return 0;
+
+    unsigned int largeur = 0;
+    if (fscanf(f, "%u", &largeur) != 1) largeur = 0;
+    fclose(f);
+    return largeur;
+}
+
+
+
+/**
+ * @brief Lance un cas (dans le processus courant) et remplit ses résultats,
+ * sauf rss_max_ko.
+ */
+static void lance_cas(Cas *cas, unsigned int nb_generations, unsigned int nb_threads)
+{
+    Jeu *jeu = init_jeu(cas -> taille, cas -> taille, cas -> taille);
+    jeu -> moteur = cas -> moteur;
+    jeu -> nb_threads = nb_threads;
+
+    if (cas -> fichier != NULL)
+    {
+        unsigned int milieu = (cas -> taille - largeur_motif(cas -> fichier)) / 2;
+        if (!file2grid(cas -> fichier, jeu, milieu, milieu)) quitter("Impossible de charger le motif\n", 1);
+    }
+    else
+    {
+        srandom(42);
+        long int seuil = (long int) (cas -> densite * RAND_MAX);
+        for (unsigned int i = 0; i < cas -> taille; i++)
+        {
+            for (unsigned int j = 0; j < cas -> taille; j++)
+            {
+                if (random() < seuil) CELLULE(jeu -> grille, i, j) = (1 << 7) + 1;
+            }
+        }
+    }
+
+    init_moteur(jeu);
+    for (unsigned int g = 0; g < NB_ECHAUFFEMENT; g++) maj_grille(jeu);
+
+    double *durees = (double *) malloc(sizeof(double) * nb_generations);
+    if (durees == NULL) quitter("Impossible d'allouer de la mémoire pour les mesures\n", 2);
+
+    double total = 0;
+    for (unsigned int g = 0; g < nb_generations; g++)
+    {
+        struct timespec debut, fin;
+        clock_gettime(CLOCK_MONOTONIC, &debut);
+        maj_grille(jeu);
+        clock_gettime(CLOCK_MONOTONIC, &fin);
+        durees[g] = (fin.tv_sec - debut.tv_sec) * 1e3 + (fin.tv_nsec - debut.tv_nsec) * 1e-6;
+        total += durees[g];
+    }
+
+    qsort(durees, nb_generations, sizeof(double), compare_double);
+    cas -> mediane_ms = durees[nb_generations / 2];
+    cas -> p95_ms = durees[(nb_generations * 95) / 100];
+    cas -> cellules_par_s = (double) cas -> taille * cas -> taille * nb_generations / (total * 1e-3);
+
+    free(durees);
+    free_jeu(jeu);
+}
+
+
+
+/**
+ * @brief Lance un cas dans un processus fils (pour mesurer sa mémoire
+ * maximale indépendamment des autres cas).
+ *
+ * @return char 1 si le cas s'est bien déroulé, 0 sinon
+ */
+static char lance_cas_isole(Cas *cas, unsigned int nb_generations, unsigned int nb_threads)
+{
+    int tube[2];
+    if (pipe(tube) != 0) return 0;
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) return 0;
+    if (pid == 0)
+    {
+        // Le fils n'affiche rien (file2grid() écrit sur stdout)
+        close(tube[0]);
+        if (freopen("/dev/null", "w", stdout) == NULL) _exit(1);
+        lance_cas(cas, nb_generations, nb_threads);
+        if (write(tube[1], cas, sizeof(Cas)) != sizeof(Cas)) _exit(1);
+        _exit(0);
+    }
+
+    close(tube[1]);
+    char ok = read(tube[0], cas, sizeof(Cas)) == sizeof(Cas);
+    close(tube[0]);
+
+    int statut;
+    struct rusage ressources;
+    if (wait4(pid, &statut, 0, &ressources) < 0 || !WIFEXITED(statut) || WEXITSTATUS(statut) != 0) ok = 0;
+    cas -> rss_max_ko = ressources.ru_maxrss;
+    return ok;
+}
+
+
+
+/**
+ * @brief Écrit les résultats dans un fichier JSON (un cas par ligne, pour
+ * pouvoir être relu par lit_reference()).
+ */
+static void ecrit_json(const char *chemin, Cas *cas, unsigned int nb_cas, unsigned int nb_generations)
+{
+    FILE *f = fopen(chemin, "w");
+    if (f == NULL) quitter("Impossible d'écrire le fichier de résultats\n", 1);
+
+    fprintf(f, "{\n  \"generations\": %u,\n  \"resultats\": [\n", nb_generations);
+    for (unsigned int i = 0; i < nb_cas; i++)
+    {
+        fprintf(f, "    {\"nom\": \"%s\", \"taille\": %u, \"mediane_ms\": %.6f, \"p95_ms\": %.6f, "
+                   "\"cellules_par_s\": %.6e, \"rss_max_ko\": %ld}%s\n",
+                cas[i].nom, cas[i].taille, cas[i].mediane_ms, cas[i].p95_ms,
+                cas[i].cellules_par_s, cas[i].rss_max_ko, i + 1 < nb_cas ? "," : "");
+    }
+    fprintf(f, "  ]\n}\n");
+    fclose(f);
+}
+
+
+
+/**
+ * @brief Cherche la médiane d'un cas dans un fichier de référence écrit par
+ * ecrit_json().
+ *
+ * @return double La médiane de référence (en ms), -1 si le cas n'y est pas
+ */
+static double lit_reference(FILE *reference, const char *nom)
+{
+    char ligne[512], cle[160];
+    snprintf(cle, sizeof(cle), "{\"nom\": \"%s\",", nom);
+
+    rewind(reference);
+    while (fgets(ligne, sizeof(ligne), reference) != NULL)
+    {
+        char *debut = strstr(ligne, cle);
+        char *mediane = strstr(ligne, "\"mediane_ms\": ");
+        if (debut != NULL && mediane != NULL) return atof(mediane + strlen("\"mediane_ms\": "));
+    }
+    return -1;
+}
+
+
+
+/**
+ * @brief Affiche l'aide du programme et quitte.
+ */
+static void aide_bench()
+{
+    printf("Utilisation: ./bench_gol [options]\n");
+    printf("'--generations N' -> Nombre de générations mesurées par cas (200 par défaut)\n");
+    printf("'--threads N' -> Nombre de threads des moteurs (1 par défaut)\n");
+    printf("'--moteurs m1,m2,...' -> Moteurs à mesurer parmi scalaire, bitboard, simd, hashlife, univers, table (tous par défaut)\n");
+    printf("'--sortie F' -> Fichier JSON où écrire les résultats (bench/resultats.json par défaut)\n");
+    printf("'--reference F' -> Compare les résultats à un fichier JSON précédent\n");
+    printf("'--tolerance P' -> Ralentissement (en %%) au delà duquel un cas est une régression (10 par défaut)\n");
+    quitter("Commande incorrecte\n", 1);
+}
+
+
+
+int main(int argc, char **argv)
+{
+    unsigned int nb_generations = 200, nb_threads = 1, tolerance = 10;
+    const char *sortie = "bench/resultats.json", *reference = NULL;
+    char moteurs[NB_MOTEURS];
+    memset(moteurs, 1, sizeof(moteurs));
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--generations") && i + 1 < argc)
+        {
+            if (!string2uint(argv[++i], &nb_generations) || nb_generations == 0 || nb_generations > NB_GENERATIONS_MAX) aide_bench();
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            if (!string2uint(argv[++i], &nb_threads) || nb_threads == 0) aide_bench();
+        }
+        else if (!strcmp(argv[i], "--tolerance") && i + 1 < argc)
+        {
+            if (!string2uint(argv[++i], &tolerance)) aide_bench();
+        }
+        else if (!strcmp(argv[i], "--sortie") && i + 1 < argc) sortie = argv[++i];
+        else if (!strcmp(argv[i], "--reference") && i + 1 < argc) reference = argv[++i];
+        else if (!strcmp(argv[i], "--moteurs") && i + 1 < argc)
+        {
+            memset(moteurs, 0, sizeof(moteurs));
+            for (char *nom = strtok(argv[++i], ","); nom != NULL; nom = strtok(NULL, ","))
+            {
+                unsigned int m = 0;
+                while (m < NB_MOTEURS && strcmp(nom, noms_moteurs[m])) m++;
+                if (m == NB_MOTEURS) aide_bench();
+                moteurs[m] = 1;
+            }
+        }
+        else aide_bench();
+    }
+    if (moteurs[MOTEUR_SIMD]) init_simd(NULL);
+    if (moteurs[MOTEUR_TABLE])
+    {
+        // Les cas utilisent la règle par défaut de init_jeu()
+        Regle regle = regle_vie();
+        init_table(&regle);
+    }
+
+    // Les cas: les motifs de templates/, puis des configurations aléatoires
+    Cas *cas = (Cas *) calloc(NB_CAS_MAX, sizeof(Cas));
+    if (cas == NULL) quitter("Impossible d'allouer de la mémoire pour les cas\n", 2);
+
+    static const unsigned int tailles[] = {256, 1024, 2048};
+    static const double densites[] = {0.2, 0.5};
+    glob_t motifs;
+    if (glob("templates/*.gol", 0, NULL, &motifs) != 0) motifs.gl_pathc = 0;
+
+    unsigned int nb_cas = 0;
+    for (unsigned int m = 0; m < NB_MOTEURS; m++)
+    {
+        if (!moteurs[m]) continue;
+        for (size_t f = 0; f < motifs.gl_pathc && nb_cas < NB_CAS_MAX; f++)
+        {
+            if (largeur_motif(motifs.gl_pathv[f]) == 0 || largeur_motif(motifs.gl_pathv[f]) > 1024) continue;
+
+            const char *nom = strrchr(motifs.gl_pathv[f], '/') + 1;
+            snprintf(cas[nb_cas].nom, sizeof(cas[nb_cas].nom), "%.*s/%s", (int) (strlen(nom) - 4), nom, noms_moteurs[m]);
+            cas[nb_cas].fichier = motifs.gl_pathv[f];
+            cas[nb_cas].taille = 1024;
+            cas[nb_cas].moteur = m;
+            nb_cas++;
+        }
+        for (unsigned int t = 0; t < sizeof(tailles) / sizeof(tailles[0]); t++)
+        {
+            for (unsigned int d = 0; d < sizeof(densites) / sizeof(densites[0]) && nb_cas < NB_CAS_MAX; d++)
+            {
+                snprintf(cas[nb_cas].nom, sizeof(cas[nb_cas].nom), "soupe-%u-d%02u/%s", tailles[t],
+                         (unsigned int) (densites[d] * 100), noms_moteurs[m]);
+                cas[nb_cas].taille = tailles[t];
+                cas[nb_cas].densite = densites[d];
+                cas[nb_cas].moteur = m;
+                nb_cas++;
+            }
+        }
+    }
+
+    FILE *f_reference = NULL;
+    if (reference != NULL && (f_reference = fopen(reference, "r")) == NULL) quitter("Impossible de lire le fichier de référence\n", 1);
+
+    // On lance tous les cas
+    unsigned int nb_regressions = 0;
+    printf("%-32s %12s %12s %14s %12s\n", "cas", "médiane (ms)", "p95 (ms)", "cellules/s", "RSS (Ko)");
+    for (unsigned int i = 0; i < nb_cas; i++)
+    {
+        if (!lance_cas_isole(&cas[i], nb_generations, nb_threads))
+        {
+            printf("%-32s échec\n", cas[i].nom);
+            continue;
+        }
+        printf("%-32s %12.4f %12.4f %14.3e %12ld", cas[i].nom, cas[i].mediane_ms, cas[i].p95_ms, cas[i].cellules_par_s, cas[i].rss_max_ko);
+
+        // Comparaison avec la référence
+        double mediane_ref = f_reference != NULL ? lit_reference(f_reference, cas[i].nom) : -1;
+        if (mediane_ref > 0)
+        {
+            double ecart = 100 * (cas[i].mediane_ms - mediane_ref) / mediane_ref;
+            printf("  %+6.1f%%", ecart);
+            if (ecart > tolerance)
+            {
+                print_redb("  RÉGRESSION");
+                nb_regressions++;
+            }
+        }
+        printf("\n");
+    }
+
+    ecrit_json(sortie, cas, nb_cas, nb_generations);
+    printf("\nRésultats écrits dans %s\n", sortie);
+
+    if (f_reference != NULL) fclose(f_reference);
+    globfree(&motifs);
+    free(cas);
+
+    if (nb_regressions > 0)
+    {
+        printf("%u régression(s) de plus de %u%% par rapport à %s\n", nb_regressions, tolerance, reference);
+        return 1;
+    }
+    return 0;
+}
@@ -32,17 +32,18 @@ static const unsigned int hauteur_f = 800;
 
 char file2grid(const char *fichier, Jeu *jeu, int x, int y);
 void affiche_grille(Jeu *jeu);
+void dessine_grille(Jeu *jeu);
 void init_fichier(Jeu *jeu);
 void init_terminal(Jeu *jeu);
-void init_rdm(Jeu *jeu);
+void init_aleatoire(Jeu *jeu, const Soupe *soupe);
+void init_rdm(Jeu *jeu, const Soupe *soupe);
+void init_fenetre(Jeu *jeu);
 void init_GUI(Jeu *jeu);
 void watch_events(SDL_Event *event, Jeu *jeu, char *gameloop, char estConfig);
 void update_camera(Camera *cam);
+void regle_zoom(Jeu *jeu, unsigned int largeur);
 void affiche_aide();
 void affiche_commandes(Jeu *jeu, char estConfig);
-void get_color(cellule cell, unsigned char *r, unsigned char *g, unsigned char *b);
-
-void spectral_color(double *r,double *g,double *b,double l);
 
 
 #endif
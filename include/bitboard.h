@@ -0,0 +1,26 @@
+/**
+ * @file bitboard.h
+ * @author M3tex
+ * @brief Header pour bitboard.c
+ * @version 0.1
+ * @date 2022-12-10
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef BITBOARD_HEADER
+#define BITBOARD_HEADER
+
+
+#include "types.h"
+
+
+void grille2bitgrille(Grille *grille, BitGrille *bitgrille);
+void bitgrille2grille(BitGrille *bitgrille, Grille *grille);
+char suivi_age_bitgrille(BitGrille *bitgrille, char actif);
+char maj_bitgrille(BitGrille *bitgrille, const Zone *zone, Stats *partielles, const Regle *regle);
+void echange_bitgrille(BitGrille *bitgrille);
+void bloc_suivant(const uint64_t fenetre[TAILLE_BLOC + 2][3], uint64_t *bloc, const Regle *regle);
+
+
+#endif
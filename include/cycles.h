@@ -0,0 +1,53 @@
+/**
+ * @file cycles.h
+ * @author M3tex
+ * @brief Header pour cycles.c
+ * @version 0.1
+ * @date 2022-12-29
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef CYCLES_HEADER
+#define CYCLES_HEADER
+
+
+#include "types.h"
+
+
+/**
+ * @brief Mélange les bits d'un entier (finaliseur de splitmix64).
+ */
+static inline uint64_t melange(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    return x ^ (x >> 31);
+}
+
+/**
+ * @brief La contribution d'un mot de 64 cellules à l'empreinte de la grille
+ * (voir Cycles): l'empreinte est le XOR des contributions de tous les mots,
+ * cle identifie la position du mot. Un mot vide ne contribue pas.
+ */
+static inline uint64_t empreinte_mot(uint64_t mot, uint64_t cle)
+{
+    return mot ? melange(mot ^ melange(cle)) : 0;
+}
+
+/**
+ * @brief La clé de la ligne r d'un bloc de l'univers non borné (voir empreinte_mot()).
+ */
+static inline uint64_t cle_bloc(const Bloc *bloc, unsigned int r)
+{
+    return ((uint64_t) bloc -> bx * 0x9E3779B97F4A7C15ULL) ^ ((uint64_t) bloc -> by * 0xC2B2AE3D27D4EB4FULL) ^ r;
+}
+
+
+Cycles *init_cycles(Jeu *jeu);
+void maj_cycles(Jeu *jeu);
+char saute_generations(Jeu *jeu, unsigned long int cible);
+void free_cycles(Cycles *cycles);
+
+
+#endif
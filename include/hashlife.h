@@ -0,0 +1,29 @@
+/**
+ * @file hashlife.h
+ * @author M3tex
+ * @brief Header pour hashlife.c
+ * @version 0.1
+ * @date 2022-12-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef HASHLIFE_HEADER
+#define HASHLIFE_HEADER
+
+
+#include "types.h"
+
+
+HashLife *init_hashlife(size_t budget, const Regle *regle);
+void free_hashlife(HashLife *hl);
+
+void grille2hashlife(Grille *grille, HashLife *hl);
+void hashlife2grille(HashLife *hl, Grille *grille, int64_t x, int64_t y);
+void ajoute_grille_hashlife(HashLife *hl, Grille *grille, int64_t x, int64_t y);
+void blocs_hashlife(HashLife *hl, RappelBloc rappel, void *contexte);
+void avance_hashlife(HashLife *hl, unsigned long int nb_generations);
+unsigned long int population_hashlife(HashLife *hl);
+
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file journal.h
+ * @author M3tex
+ * @brief Header pour journal.c
+ * @version 0.1
+ * @date 2022-12-28
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef JOURNAL_HEADER
+#define JOURNAL_HEADER
+
+
+#include "types.h"
+
+
+Journal *ouvre_journal(const char *fichier, const Stats *statistiques);
+void ecrit_journal(Journal *journal, const Stats *statistiques);
+void ferme_journal(Journal *journal, unsigned long int originelles);
+
+
+#endif
@@ -12,10 +12,51 @@
 #define LOGIQUE_HEADER
 
 
+#include <string.h>
 #include "types.h"
 
+
+/**
+ * @brief Transforme n cellules consécutives (n <= 64) en un mot: le bit j
+ * vaut 1 si la cellule j est vivante, comme dans la BitGrille.
+ */
+static inline uint64_t masque_vivantes(const cellule *cellules, unsigned int n)
+{
+    uint64_t mot = 0;
+    unsigned int j = 0;
+
+    // 8 cellules à la fois: le bit de poids fort de chaque octet de t indique si la cellule est vivante
+    for (; j + 8 <= n; j += 8)
+    {
+        uint64_t x;
+        memcpy(&x, cellules + j, 8);
+        uint64_t t = (((x & 0x7F7F7F7F7F7F7F7FULL) + 0x7F7F7F7F7F7F7F7FULL) | x) & 0x8080808080808080ULL;
+
+        // On rassemble les 8 bits dans l'octet de poids fort
+        mot |= (((t >> 7) * 0x0102040810204080ULL) >> 56) << j;
+    }
+    for (; j < n; j++) mot |= (uint64_t) (cellules[j] != 0) << j;
+    return mot;
+}
+
+/**
+ * @brief L'inverse de masque_vivantes() pour 8 cellules: l'octet j du résultat
+ * vaut 0xFF si le bit j de bits vaut 1, 0 sinon.
+ */
+static inline uint64_t etale_octets(uint64_t bits)
+{
+    uint64_t octets = ((bits & 0xFF) * 0x0101010101010101ULL) & 0x8040201008040201ULL;
+    return ((((octets + 0x7F7F7F7F7F7F7F7FULL) | octets) & 0x8080808080808080ULL) >> 7) * 0xFF;
+}
+
+
 unsigned char compte_voisin(Grille *grille, unsigned int x, unsigned int y);
+char generation_suivante(Grille *courante, Grille *suivante, const Zone *zone, Stats *statistiques, const Regle *regle);
 void maj_grille(Jeu *jeu);
+void init_moteur(Jeu *jeu);
+void synchronise_grille(Jeu *jeu);
+unsigned long int compte_originelles(Jeu *jeu);
+void active_tuiles(Tuiles *tuiles);
 
 
 #endif
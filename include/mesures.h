@@ -0,0 +1,59 @@
+/**
+ * @file mesures.h
+ * @author M3tex
+ * @brief Header pour mesures.c
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef MESURES_HEADER
+#define MESURES_HEADER
+
+
+#include <time.h>
+#include "types.h"
+
+
+Mesures *init_mesures(unsigned int nb_bandes, const char *fichier_trace);
+void enregistre_mesure(Mesures *mesures, Phase phase, unsigned int indice, uint64_t debut, uint64_t fin);
+void dessine_hud(SDL_Renderer *renderer, const Mesures *mesures);
+void affiche_mesures(const Mesures *mesures);
+void free_mesures(Mesures *mesures);
+
+
+/**
+ * @brief L'horloge monotone, en ns.
+ */
+static inline uint64_t horloge_ns(void)
+{
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t) t.tv_sec * 1000000000ULL + (uint64_t) t.tv_nsec;
+}
+
+
+
+/**
+ * @brief Le début d'un intervalle mesuré (à passer à fin_mesure()). Sans
+ * instrumentation (mesures NULL), on ne lit même pas l'horloge.
+ */
+static inline uint64_t debut_mesure(const Mesures *mesures)
+{
+    return (mesures != NULL) ? horloge_ns() : 0;
+}
+
+
+
+/**
+ * @brief La fin d'un intervalle commencé par debut_mesure(): sa durée est
+ * ajoutée à la série de la phase (la bande indice pour PHASE_BANDE, 0 sinon).
+ */
+static inline void fin_mesure(Mesures *mesures, Phase phase, unsigned int indice, uint64_t debut)
+{
+    if (mesures != NULL) enregistre_mesure(mesures, phase, indice, debut, horloge_ns());
+}
+
+
+#endif
@@ -0,0 +1,22 @@
+/**
+ * @file motifs.h
+ * @author M3tex
+ * @brief Header pour motifs.c
+ * @version 0.1
+ * @date 2022-12-23
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef MOTIFS_HEADER
+#define MOTIFS_HEADER
+
+
+#include <stddef.h>
+#include "types.h"
+
+
+char charge_motif(const char *donnees, size_t taille, Jeu *jeu, int x, int y);
+
+
+#endif
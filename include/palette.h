@@ -0,0 +1,26 @@
+/**
+ * @file palette.h
+ * @author M3tex
+ * @brief Header pour palette.c
+ * @version 0.1
+ * @date 2022-12-21
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef PALETTE_HEADER
+#define PALETTE_HEADER
+
+
+#include "types.h"
+
+
+void init_palettes();
+const uint32_t *table_palette(Palette palette, char estCouleur);
+void cellules2pixels(const cellule *cellules, uint32_t *pixels, unsigned int n, const uint32_t *table);
+void get_color(cellule cell, unsigned char *r, unsigned char *g, unsigned char *b);
+
+void spectral_color(double *r,double *g,double *b,double l);
+
+
+#endif
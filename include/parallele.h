@@ -0,0 +1,23 @@
+/**
+ * @file parallele.h
+ * @author M3tex
+ * @brief Header pour parallele.c
+ * @version 0.1
+ * @date 2022-12-12
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef PARALLELE_HEADER
+#define PARALLELE_HEADER
+
+
+#include "types.h"
+
+
+Pool *init_pool(unsigned int nb_threads);
+void execute_pool(Pool *pool, Tache tache, void *contexte);
+void free_pool(Pool *pool);
+
+
+#endif
@@ -0,0 +1,25 @@
+/**
+ * @file pyramide.h
+ * @author M3tex
+ * @brief Header pour pyramide.c
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef PYRAMIDE_HEADER
+#define PYRAMIDE_HEADER
+
+
+#include "types.h"
+
+
+Pyramide *init_pyramide(unsigned int taille);
+void maj_pyramide(Pyramide *pyramide, const Grille *grille, const unsigned char *modifiees);
+void niveau2pixels(const Pyramide *pyramide, unsigned int k, int64_t ligne, int64_t colonne, uint32_t *pixels,
+                   unsigned int n, const uint32_t *table, char couleur);
+void free_pyramide(Pyramide *pyramide);
+
+
+#endif
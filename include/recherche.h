@@ -0,0 +1,24 @@
+/**
+ * @file recherche.h
+ * @author M3tex
+ * @brief Header pour recherche.c
+ * @version 0.1
+ * @date 2022-12-30
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef RECHERCHE_HEADER
+#define RECHERCHE_HEADER
+
+
+#include "types.h"
+
+
+Recherche *init_recherche(Moteur moteur, Regle regle, Topologie topologie, unsigned int taille, unsigned long int nb_soupes,
+                          unsigned long int max_generations, Soupe soupe, const char *fichier);
+void lance_recherche(Recherche *recherche, unsigned int nb_threads);
+void free_recherche(Recherche *recherche);
+
+
+#endif
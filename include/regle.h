@@ -0,0 +1,72 @@
+/**
+ * @file regle.h
+ * @author M3tex
+ * @brief Header pour regle.c
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef REGLE_HEADER
+#define REGLE_HEADER
+
+
+#include "types.h"
+
+
+/* Exécute 'appel' avec les constantes naissance et survie de la règle: pour
+les règles spécialisées ce sont des constantes connues à la compilation, et
+le noyau appelé (always_inline) est compilé pour cette règle. */
+#define AVEC_REGLE(regle, appel)                                                                        \
+    switch ((regle) -> type)                                                                            \
+    {                                                                                                   \
+    case REGLE_VIE:                                                                                     \
+    {                                                                                                   \
+        const uint16_t naissance = NAISSANCE_VIE, survie = SURVIE_VIE;                                  \
+        appel;                                                                                          \
+        break;                                                                                          \
+    }                                                                                                   \
+    case REGLE_HIGHLIFE:                                                                                \
+    {                                                                                                   \
+        const uint16_t naissance = NAISSANCE_HIGHLIFE, survie = SURVIE_HIGHLIFE;                        \
+        appel;                                                                                          \
+        break;                                                                                          \
+    }                                                                                                   \
+    case REGLE_JOUR_NUIT:                                                                               \
+    {                                                                                                   \
+        const uint16_t naissance = NAISSANCE_JOUR_NUIT, survie = SURVIE_JOUR_NUIT;                      \
+        appel;                                                                                          \
+        break;                                                                                          \
+    }                                                                                                   \
+    case REGLE_GRAINES:                                                                                 \
+    {                                                                                                   \
+        const uint16_t naissance = NAISSANCE_GRAINES, survie = SURVIE_GRAINES;                          \
+        appel;                                                                                          \
+        break;                                                                                          \
+    }                                                                                                   \
+    default:                                                                                            \
+    {                                                                                                   \
+        const uint16_t naissance = (regle) -> naissance, survie = (regle) -> survie;                    \
+        appel;                                                                                          \
+        break;                                                                                          \
+    }                                                                                                   \
+    }
+
+
+/**
+ * @brief Indique si n (le nombre de voisins, de 0 à 8) est dans le masque.
+ */
+static inline __attribute__((always_inline)) char dans_masque(uint16_t masque, unsigned int n)
+{
+    return (masque >> n) & 1;
+}
+
+
+Regle regle_vie();
+Regle regle_masques(uint16_t naissance, uint16_t survie);
+char lit_regle(const char *texte, Regle *regle);
+void ecrit_regle(const Regle *regle, char *texte);
+
+
+#endif
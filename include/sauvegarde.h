@@ -0,0 +1,24 @@
+/**
+ * @file sauvegarde.h
+ * @author M3tex
+ * @brief Header pour sauvegarde.c
+ * @version 0.1
+ * @date 2022-12-27
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef SAUVEGARDE_HEADER
+#define SAUVEGARDE_HEADER
+
+
+#include "types.h"
+
+
+char ecrit_sauvegarde(const char *fichier, Jeu *jeu);
+char charge_sauvegarde(const char *fichier, Jeu *jeu);
+unsigned int taille_sauvegarde(const char *fichier);
+void sauvegarde_periodique(Jeu *jeu);
+
+
+#endif
@@ -0,0 +1,23 @@
+/**
+ * @file simd.h
+ * @author M3tex
+ * @brief Header pour simd.c
+ * @version 0.1
+ * @date 2022-12-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef SIMD_HEADER
+#define SIMD_HEADER
+
+
+#include "types.h"
+
+
+void init_simd(const char *force);
+const char *nom_simd();
+char generation_suivante_simd(Grille *courante, Grille *suivante, const Zone *zone, Stats *partielles, const Regle *regle);
+
+
+#endif
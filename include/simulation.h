@@ -0,0 +1,24 @@
+/**
+ * @file simulation.h
+ * @author M3tex
+ * @brief Header pour simulation.c
+ * @version 0.1
+ * @date 2022-12-22
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef SIMULATION_HEADER
+#define SIMULATION_HEADER
+
+
+#include "types.h"
+
+
+Simulation *lance_simulation(Jeu *jeu, int nb_tours);
+void publie_commandes(Simulation *sim, Jeu *jeu);
+char image_suivante(Simulation *sim, Jeu *jeu);
+void arrete_simulation(Simulation *sim, Jeu *jeu);
+
+
+#endif
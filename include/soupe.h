@@ -0,0 +1,24 @@
+/**
+ * @file soupe.h
+ * @author M3tex
+ * @brief Header pour soupe.c
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef SOUPE_HEADER
+#define SOUPE_HEADER
+
+
+#include "types.h"
+
+
+unsigned long int remplit_soupe(Grille *grille, const Soupe *soupe, Pool *pool);
+char lit_symetrie(const char *nom, Symetrie *symetrie);
+const char *nom_symetrie(Symetrie symetrie);
+void affiche_soupe(const Soupe *soupe);
+
+
+#endif
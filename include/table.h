@@ -0,0 +1,22 @@
+/**
+ * @file table.h
+ * @author M3tex
+ * @brief Header pour table.c
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef TABLE_HEADER
+#define TABLE_HEADER
+
+
+#include "types.h"
+
+
+void init_table(const Regle *regle);
+char generation_suivante_table(Grille *courante, Grille *suivante, const Zone *zone, Stats *partielles, const Regle *regle);
+
+
+#endif
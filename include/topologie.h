@@ -0,0 +1,26 @@
+/**
+ * @file topologie.h
+ * @author M3tex
+ * @brief Header pour topologie.c
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef TOPOLOGIE_HEADER
+#define TOPOLOGIE_HEADER
+
+
+#include "types.h"
+
+
+char lit_topologie(const char *nom, Topologie *topologie);
+const char *nom_topologie(Topologie topologie);
+void maj_bordure_grille(Grille *grille, Topologie topologie);
+void maj_bordure_bitgrille(BitGrille *bitgrille, Topologie topologie);
+void vide_bordure_bitgrille(BitGrille *bitgrille);
+char tuile_bord_a_calculer(const Tuiles *tuiles, Topologie topologie, unsigned int taille, unsigned int tx, unsigned int ty);
+
+
+#endif
@@ -2,12 +2,33 @@
 #define TYPES_HEADER
 
 
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <SDL2/SDL.h>
 
 
 typedef unsigned char cellule;
 
 
+// Nombre de bits utilisés pour stocker l'âge d'une cellule (voir Grille)
+#define NB_BITS_AGE 7
+
+/* Alignement (en octets) des lignes de la matrice d'une Grille.
+C'est aussi la largeur de la bordure à gauche de chaque ligne. */
+#define ALIGNEMENT_GRILLE 64
+
+// Accès à la cellule de la ligne i et de la colonne j d'une Grille
+#define CELLULE(grille, i, j) ((grille) -> matrice[(size_t) (i) * (grille) -> pas + (j)])
+
+// Largeur (et hauteur) d'une tuile en cellules (voir Tuiles), = 1 mot de la BitGrille
+#define TAILLE_TUILE 64
+
+// Largeur (et hauteur) d'un bloc de l'univers non borné en cellules (voir Univers), = 1 mot
+#define TAILLE_BLOC 64
+
+
 /**
  * @brief Structure contenant les statistiques du jeu.
  * nb_cell_nes contient le nombre de cellules nées au total.
@@ -22,6 +43,12 @@ typedef unsigned char cellule;
  * en_vie contient le nombre de cellules actuellement en vie
  * 
  * generations contient le nombre de générations du jeu
+ * 
+ * nb_tuiles_actives contient le nombre de tuiles recalculées à la dernière
+ * génération (voir Tuiles)
+ * 
+ * periode contient la période du cycle atteint par la configuration (0 si
+ * aucun cycle n'a été détecté, voir Cycles), qui a commencé à la génération debut_cycle
  */
 typedef struct Stats {
     unsigned long int nb_cell_nes;
@@ -30,8 +57,123 @@ typedef struct Stats {
     unsigned long int nb_cellules_depart;
     unsigned long int en_vie;
     unsigned long int generations;
+    unsigned long int nb_tuiles_actives;
+    unsigned long int periode;
+    unsigned long int debut_cycle;
 } Stats;
 
+/**
+ * @brief Une zone rectangulaire de la grille: les colonnes [x, x + largeur)
+ * des lignes [y, y + hauteur).
+ */
+typedef struct Zone {
+    unsigned int x;
+    unsigned int y;
+    unsigned int largeur;
+    unsigned int hauteur;
+} Zone;
+
+
+
+/**
+ * @brief Structure permettant de ne recalculer que les parties de la grille
+ * où il se passe quelque chose.
+ * 
+ * La grille est découpée en tuiles de TAILLE_TUILE x TAILLE_TUILE cellules.
+ * Une tuile qui n'a pas changé à la dernière génération, et dont les 8 tuiles
+ * voisines n'ont pas changé non plus, ne peut pas changer à la génération
+ * suivante: on ne la recalcule pas.
+ * 
+ * Comme les 2 grilles (ou les 2 ensembles de plans de la BitGrille) échangent
+ * leur rôle à chaque génération, une tuile inactive contient déjà le bon état
+ * dans la grille suivante: il n'y a rien à copier.
+ * 
+ * nb: le nombre de tuiles sur une ligne (ou une colonne)
+ * 
+ * active: active[ty * nb + tx] vaut 1 si la tuile (tx, ty) a changé à la
+ * dernière génération
+ * 
+ * prochaine: les mêmes indicateurs, écrits pendant le calcul de la génération
+ * suivante (puis échangés avec active)
+ * 
+ * en_vie, originelles: le nombre de cellules vivantes / originelles de chaque
+ * tuile au dernier calcul (pour les stats des tuiles qu'on ne recalcule pas)
+ */
+typedef struct Tuiles {
+    unsigned int nb;
+    unsigned char *active;
+    unsigned char *prochaine;
+    unsigned long int *en_vie;
+    unsigned long int *originelles;
+} Tuiles;
+
+
+
+/**
+ * @brief Les statistiques calculées par un thread sur sa bande de lignes.
+ * Alignées sur une ligne de cache pour que 2 threads n'écrivent jamais sur
+ * la même ligne de cache (faux partage).
+ * 
+ * Ici, en_vie et nb_cell_originelles sont des comptes partiels qui seront
+ * additionnés à la fin de la génération (voir maj_grille()).
+ */
+typedef struct StatsThread {
+    _Alignas(64) Stats stats;
+} StatsThread;
+
+
+
+/**
+ * @brief Une tâche exécutée par chaque thread d'un Pool.
+ * 
+ * contexte: Les données partagées par tous les threads
+ * 
+ * indice: Le numéro du thread qui exécute la tâche (entre 0 et nb_threads - 1)
+ */
+typedef void (*Tache)(void *contexte, unsigned int indice);
+
+/**
+ * @brief Une fonction appelée pour chaque carré non vide d'un univers non
+ * borné (voir blocs_hashlife()).
+ * 
+ * contexte: Les données de l'appelant
+ * 
+ * x, y: Le coin supérieur gauche du carré
+ */
+typedef void (*RappelBloc)(void *contexte, int64_t x, int64_t y);
+
+/**
+ * @brief Structure représentant un 'pool' de threads persistants: les threads
+ * sont créés une seule fois, puis attendent qu'on leur donne une tâche à
+ * exécuter (voir parallele.c).
+ * 
+ * Le thread qui appelle execute_pool() exécute lui aussi la tâche (avec
+ * l'indice 0): on ne crée donc que nb_threads - 1 threads.
+ * 
+ * lot: Le numéro de la dernière tâche donnée aux threads
+ * 
+ * restants: Le nombre de threads qui n'ont pas encore fini la tâche actuelle
+ * 
+ * arret: 1 si les threads doivent s'arrêter
+ */
+typedef struct Pool {
+    pthread_t *threads;
+    struct ArgThread *args;
+    unsigned int nb_threads;
+
+    pthread_mutex_t verrou;
+    pthread_cond_t debut;
+    pthread_cond_t fin;
+
+    Tache tache;
+    void *contexte;
+    unsigned long int lot;
+    unsigned int restants;
+    char arret;
+} Pool;
+
+
+
 /**
  * @brief Structure représentant la grille
  * du jeu.
@@ -57,14 +199,545 @@ typedef struct Stats {
  *  La disposition (bit de poids faible à droite):
  *  O A A A A A A A
  *  Avec A les 7bits d'âge et O le bit 'd'origine'.
+ *  
+ *  La matrice est stockée en une seule allocation, ligne par ligne (on accède
+ *  à une cellule avec la macro CELLULE). Chaque ligne commence à une adresse
+ *  alignée sur ALIGNEMENT_GRILLE octets et fait 'pas' octets.
+ *  La matrice est entourée d'une bordure de cellules 'fantômes', mortes dans une
+ *  grille bornée: une ligne au dessus et en dessous, et au moins une colonne à gauche
+ *  et à droite. On peut donc lire les 8 voisins de n'importe quelle cellule sans tester
+ *  si on sort de la grille. Avec les autres topologies, la bordure reçoit une copie
+ *  du bord opposé avant chaque génération (voir topologie.c).
+ *  
+ *  matrice pointe sur la cellule (0, 0), à l'intérieur de la bordure.
  */
 typedef struct Grille {
-    cellule **matrice;
+    cellule *matrice;
     unsigned int taille;
+    unsigned int pas;
 } Grille;
 
 
 
+/**
+ * @brief Un ensemble de "plans de bits" décrivant l'état de la grille.
+ * 
+ * Chaque plan est une matrice de bits (1 bit par cellule), stockée ligne par
+ * ligne dans des mots de 64 bits: le bit j du mot w de la ligne y correspond à
+ * la cellule (64 * w + j, y).
+ * 
+ * vivantes: 1 si la cellule est vivante
+ * 
+ * originelles: 1 si la cellule est vivante et originelle (bit de poids fort de
+ * la cellule dans Grille)
+ * 
+ * age: les 7 bits d'âge de la cellule, découpés en 7 plans (age[0] contient les
+ * bits de poids faible). NULL tant que l'âge n'est pas suivi.
+ */
+typedef struct PlansBits {
+    uint64_t *vivantes;
+    uint64_t *originelles;
+    uint64_t *age[NB_BITS_AGE];
+} PlansBits;
+
+/**
+ * @brief Structure représentant la grille sous forme de 'bitboard'.
+ * 
+ * Une cellule n'occupe plus qu'un bit (au lieu d'un octet dans Grille), ce qui
+ * permet de calculer la génération suivante de 64 cellules à la fois avec des
+ * opérations bit à bit (voir bitboard.c).
+ * 
+ * Chaque plan possède une bordure d'un mot à gauche et à droite de chaque ligne
+ * et d'une ligne en haut et en bas, à 0 dans une grille bornée: on peut donc lire
+ * les voisins de n'importe quelle cellule sans tester si on sort de la grille.
+ * Avec les autres topologies, la bordure de vivantes reçoit une copie du bord
+ * opposé avant chaque génération (voir topologie.c).
+ * 
+ * courant: les plans de la génération actuelle
+ * 
+ * suivant: les plans où l'on écrit la génération suivante (échangés ensuite
+ * avec courant)
+ * 
+ * nb_mots: le nombre de mots utiles par ligne
+ * 
+ * pas: le nombre de mots entre 2 lignes (nb_mots + 2 avec la bordure)
+ * 
+ * masque_fin: les bits du dernier mot de chaque ligne qui sont dans la grille
+ * 
+ * suivi_age: 1 si les plans d'âge sont alloués et mis à jour, 0 sinon
+ */
+typedef struct BitGrille {
+    PlansBits courant;
+    PlansBits suivant;
+    unsigned int taille;
+    unsigned int nb_mots;
+    unsigned int pas;
+    uint64_t masque_fin;
+    char suivi_age;
+} BitGrille;
+
+
+
+/**
+ * @brief Un bloc de TAILLE_BLOC x TAILLE_BLOC cellules de l'univers non borné.
+ * Le bit j de la ligne r correspond à la cellule (TAILLE_BLOC * bx + j, TAILLE_BLOC * by + r).
+ * 
+ * (bx, by): les coordonnées du bloc (en blocs)
+ * 
+ * vivantes: les cellules vivantes, vivantes[courant] pour la génération actuelle
+ * et l'autre pour la génération suivante (voir Univers)
+ * 
+ * originelles: les cellules vivantes et originelles
+ * 
+ * a_calculer: 1 si le bloc doit être recalculé à la prochaine génération (il
+ * vient d'être créé, ou lui ou un de ses voisins a changé), 0 s'il est stable:
+ * ses 2 générations sont alors identiques
+ */
+typedef struct Bloc {
+    int64_t bx;
+    int64_t by;
+    uint64_t vivantes[2][TAILLE_BLOC];
+    uint64_t originelles[TAILLE_BLOC];
+    char a_calculer;
+} Bloc;
+
+/**
+ * @brief L'univers non borné (voir univers.c): seuls les blocs contenant des
+ * cellules vivantes (et leurs voisins qui vont en recevoir) sont alloués, la
+ * mémoire utilisée dépend donc de la surface occupée et non de l'étendue du motif.
+ * 
+ * blocs: tous les blocs alloués (nb_blocs, place pour capacite)
+ * 
+ * table: table de hachage (adressage ouvert) des blocs selon leurs coordonnées,
+ * taille_table cases (puissance de 2), NULL pour une case vide
+ * 
+ * courant: l'indice de la génération actuelle dans Bloc.vivantes
+ */
+typedef struct Univers {
+    Bloc **blocs;
+    size_t nb_blocs;
+    size_t capacite;
+    Bloc **table;
+    size_t taille_table;
+    unsigned int courant;
+} Univers;
+
+
+
+/**
+ * @brief Les différents moteurs permettant de calculer la génération suivante.
+ * 
+ * MOTEUR_SCALAIRE: cellule par cellule sur la Grille (compte_voisin)
+ * 
+ * MOTEUR_BITBOARD: 64 cellules à la fois sur la BitGrille
+ * 
+ * MOTEUR_SIMD: 16 à 64 cellules à la fois sur la Grille (instructions vectorielles)
+ * 
+ * MOTEUR_TABLE: 2 x 2 cellules à la fois sur la Grille, lues dans une table
+ * précalculée (voir table.c)
+ * 
+ * MOTEUR_HASHLIFE: arbre quaternaire mémoïsé, permet d'avancer de nombreuses
+ * générations d'un coup (voir hashlife.c)
+ * 
+ * MOTEUR_UNIVERS: blocs de 64 x 64 cellules créés à la demande, sans limite de taille
+ * (voir univers.c)
+ * 
+ * NB_MOTEURS: le nombre de moteurs (pour dimensionner les tableaux indexés par moteur)
+ */
+typedef enum Moteur {
+    MOTEUR_SCALAIRE,
+    MOTEUR_BITBOARD,
+    MOTEUR_SIMD,
+    MOTEUR_HASHLIFE,
+    MOTEUR_UNIVERS,
+    MOTEUR_TABLE,
+    NB_MOTEURS
+} Moteur;
+
+
+
+/**
+ * @brief Les palettes utilisables pour afficher le jeu en couleur
+ * (voir palette.c).
+ * 
+ * PALETTE_SPECTRE: spectre du visible en fonction de l'âge (bleu -> rouge)
+ * 
+ * PALETTE_CHALEUR: du rouge sombre au blanc en fonction de l'âge
+ * 
+ * PALETTE_ORIGINE: cellules originelles en orange, les autres en bleu
+ * (plus clair avec l'âge)
+ */
+typedef enum Palette {
+    PALETTE_SPECTRE,
+    PALETTE_CHALEUR,
+    PALETTE_ORIGINE,
+    NB_PALETTES
+} Palette;
+
+
+
+/**
+ * @brief Les façons de rythmer le calcul des générations (voir simulation.c).
+ * 
+ * CADENCE_DELAI: une génération, puis on attend delay_ms
+ * 
+ * CADENCE_IMAGE: autant de générations que possible en budget_ms, puis on
+ * attend que l'affichage ait pris l'image avant de recommencer
+ * 
+ * CADENCE_MAX: les générations sont calculées sans jamais attendre
+ */
+typedef enum Cadence {
+    CADENCE_DELAI,
+    CADENCE_IMAGE,
+    CADENCE_MAX,
+    NB_CADENCES
+} Cadence;
+
+
+
+/**
+ * @brief Les statistiques calculées par les moteurs.
+ * 
+ * STATS_AUCUNES: aucune (seul le numéro de génération est suivi), les noyaux
+ * de calcul n'en ont plus le coût
+ * 
+ * STATS_TOTAUX: les totaux de Stats, affichés à la fin
+ * 
+ * STATS_GENERATION: les totaux, et les chiffres de chaque génération écrits
+ * dans un Journal
+ */
+typedef enum NiveauStats {
+    STATS_AUCUNES,
+    STATS_TOTAUX,
+    STATS_GENERATION,
+    NB_NIVEAUX_STATS
+} NiveauStats;
+
+
+
+/**
+ * @brief Les règles qui ont un noyau spécialisé (voir regle.c): les masques
+ * sont alors des constantes, que le compilateur intègre dans le calcul.
+ * 
+ * REGLE_VIE: B3/S23, le jeu de la vie de Conway
+ * 
+ * REGLE_HIGHLIFE: B36/S23
+ * 
+ * REGLE_JOUR_NUIT: B3678/S34678 (Day & Night)
+ * 
+ * REGLE_GRAINES: B2/S (Seeds)
+ * 
+ * REGLE_GENERIQUE: toutes les autres, les masques sont lus dans la Regle
+ */
+typedef enum TypeRegle {
+    REGLE_VIE,
+    REGLE_HIGHLIFE,
+    REGLE_JOUR_NUIT,
+    REGLE_GRAINES,
+    REGLE_GENERIQUE
+} TypeRegle;
+
+// Les masques des règles spécialisées (bit n: n voisins)
+#define NAISSANCE_VIE 0x008
+#define SURVIE_VIE 0x00C
+#define NAISSANCE_HIGHLIFE 0x048
+#define SURVIE_HIGHLIFE 0x00C
+#define NAISSANCE_JOUR_NUIT 0x1C8
+#define SURVIE_JOUR_NUIT 0x1D8
+#define NAISSANCE_GRAINES 0x004
+#define SURVIE_GRAINES 0x000
+
+/**
+ * @brief Une règle 'Life-like' en notation B/S (voir https://conwaylife.com/wiki/Rulestring).
+ * 
+ * naissance: Le bit n vaut 1 si une cellule morte avec n voisins naît (n de 0 à 8)
+ * 
+ * survie: Le bit n vaut 1 si une cellule vivante avec n voisins survit
+ * 
+ * type: La règle spécialisée correspondant aux masques, REGLE_GENERIQUE sinon
+ */
+typedef struct Regle {
+    uint16_t naissance;
+    uint16_t survie;
+    TypeRegle type;
+} Regle;
+
+
+
+/**
+ * @brief Ce qu'il y a au-delà des bords de la grille (voir topologie.c).
+ * 
+ * TOPOLOGIE_BORNEE: rien, les cellules hors de la grille sont toujours mortes
+ * 
+ * TOPOLOGIE_TORE: le bord droit touche le bord gauche, et le bas touche le haut
+ * 
+ * TOPOLOGIE_KLEIN: comme le tore, mais le haut et le bas se touchent après un
+ * retournement horizontal (bouteille de Klein): la colonne x du bas touche la
+ * colonne taille - 1 - x du haut
+ */
+typedef enum Topologie {
+    TOPOLOGIE_BORNEE,
+    TOPOLOGIE_TORE,
+    TOPOLOGIE_KLEIN
+} Topologie;
+
+
+
+/**
+ * @brief Les symétries d'une configuration aléatoire (voir soupe.c): seule une
+ * partie de la grille est tirée, le reste en est le reflet.
+ * 
+ * SYMETRIE_AUCUNE: toute la grille est tirée
+ * 
+ * SYMETRIE_MIROIR: la moitié droite est le reflet de la moitié gauche
+ * 
+ * SYMETRIE_ROTATION: la grille ne change pas si on la fait tourner d'un
+ * demi-tour (la moitié du bas est la moitié du haut retournée)
+ * 
+ * SYMETRIE_QUADRUPLE: reflets gauche-droite et haut-bas (seul le quart en haut
+ * à gauche est tiré)
+ */
+typedef enum Symetrie {
+    SYMETRIE_AUCUNE,
+    SYMETRIE_MIROIR,
+    SYMETRIE_ROTATION,
+    SYMETRIE_QUADRUPLE
+} Symetrie;
+
+// La densité d'une Soupe est une probabilité en 65536èmes
+#define DENSITE_MAX 65536
+
+/**
+ * @brief Une configuration aléatoire, ou 'soupe' (voir soupe.c). Elle ne
+ * dépend que de ses paramètres et de la taille de la grille.
+ * 
+ * graine: La graine du générateur pseudo-aléatoire
+ * 
+ * densite: La probabilité qu'une cellule soit vivante, en 65536èmes
+ * (DENSITE_MAX: toutes les cellules sont vivantes)
+ * 
+ * symetrie: La symétrie de la configuration
+ */
+typedef struct Soupe {
+    uint64_t graine;
+    uint32_t densite;
+    Symetrie symetrie;
+} Soupe;
+
+
+
+/**
+ * @brief Le fichier où sont écrites les statistiques de chaque génération
+ * (voir journal.c). Les lignes sont préparées dans tampon et écrites par
+ * blocs.
+ * 
+ * binaire: 1 pour des enregistrements binaires, 0 pour du CSV
+ * 
+ * nes, mortes: Les totaux de la génération précédente (pour en déduire ceux de la génération)
+ * 
+ * en_attente: 1 si la ligne de la dernière génération calculée n'est pas encore
+ * écrite: les moteurs comptent les cellules originelles avant le calcul, on ne
+ * connaît donc celles d'après qu'à la génération suivante (ou à la fermeture)
+ * 
+ * generation, nes_generation, mortes_generation, en_vie: Cette ligne
+ */
+typedef struct Journal {
+    FILE *fichier;
+    char binaire;
+    char *tampon;
+    size_t taille;
+    unsigned long int nes;
+    unsigned long int mortes;
+
+    char en_attente;
+    unsigned long int generation;
+    unsigned long int nes_generation;
+    unsigned long int mortes_generation;
+    unsigned long int en_vie;
+} Journal;
+
+
+
+// Nombre d'empreintes gardées par Cycles (puissance de 2)
+#define TAILLE_HISTORIQUE 4096
+
+/**
+ * @brief Une génération déjà vue: son empreinte, et les totaux de naissances
+ * et de morts à ce moment (pour extrapoler les stats lors d'un saut).
+ */
+typedef struct EntreeCycle {
+    uint64_t empreinte;
+    unsigned long int generation;
+    unsigned long int nes;
+    unsigned long int mortes;
+    char occupee;
+} EntreeCycle;
+
+/**
+ * @brief La détection de cycles (voir cycles.c).
+ * 
+ * empreinte: L'empreinte (hash sur 64 bits) des cellules vivantes de la
+ * génération actuelle, mise à jour à chaque génération à partir des cellules
+ * qui ont changé
+ * 
+ * historique: Les empreintes des générations précédentes, rangées selon leurs
+ * bits de poids faible (une nouvelle empreinte remplace l'ancienne)
+ * 
+ * nes_periode, mortes_periode: Les naissances et les morts d'une période, une
+ * fois le cycle détecté
+ */
+typedef struct Cycles {
+    uint64_t empreinte;
+    EntreeCycle *historique;
+    unsigned long int nes_periode;
+    unsigned long int mortes_periode;
+} Cycles;
+
+
+
+/**
+ * @brief Les phases mesurées par l'instrumentation (voir mesures.c).
+ * 
+ * PHASE_IMAGE: Un tour complet de la boucle d'affichage
+ * 
+ * PHASE_EVENEMENTS: La gestion des évènements (watch_events()) et l'envoi des
+ * commandes à la simulation
+ * 
+ * PHASE_DESSIN: L'écriture de la grille dans la texture et sa copie (dessine_grille())
+ * 
+ * PHASE_PRESENTATION: SDL_RenderPresent() (l'attente de la synchro verticale comprise)
+ * 
+ * PHASE_GENERATION: Le calcul d'une génération (maj_grille())
+ * 
+ * PHASE_BANDE: La part d'un thread dans le calcul d'une génération (sa bande
+ * de lignes), une série par thread
+ */
+typedef enum Phase {
+    PHASE_IMAGE,
+    PHASE_EVENEMENTS,
+    PHASE_DESSIN,
+    PHASE_PRESENTATION,
+    PHASE_GENERATION,
+    PHASE_BANDE,
+    NB_PHASES
+} Phase;
+
+// Nombre de durées gardées par Serie pour les moyennes et les centiles (puissance de 2)
+#define NB_ECHANTILLONS 256
+
+// Nombre d'évènements gardés par Serie avant d'être écrits dans la trace
+#define TAILLE_TRACE 4096
+
+/**
+ * @brief Un intervalle de temps mesuré, pour la trace: son début (en ns
+ * depuis l'origine des Mesures) et sa durée (en ns).
+ */
+typedef struct EvenementTrace {
+    uint64_t debut;
+    uint64_t duree;
+} EvenementTrace;
+
+/**
+ * @brief Les mesures d'une phase (ou de la bande d'un thread). Une Serie n'est
+ * écrite que par un seul thread, l'affichage peut la lire en même temps.
+ * Alignée sur une ligne de cache (voir StatsThread).
+ * 
+ * nb: Le nombre de durées mesurées depuis le début
+ * 
+ * durees: Les NB_ECHANTILLONS dernières durées (en ns, saturées à 4 s),
+ * la durée i est dans la case i % NB_ECHANTILLONS
+ * 
+ * trace: Les évènements pas encore écrits dans la trace (NULL sans trace)
+ */
+typedef struct Serie {
+    _Alignas(64) atomic_ulong nb;
+    atomic_uint durees[NB_ECHANTILLONS];
+    EvenementTrace *trace;
+    unsigned int nb_trace;
+} Serie;
+
+/**
+ * @brief L'instrumentation (voir mesures.c): la durée de chaque phase du
+ * calcul et de l'affichage.
+ * 
+ * series: Une Serie par phase, puis une par thread pour PHASE_BANDE (la bande
+ * i est series[PHASE_BANDE + i])
+ * 
+ * nb_bandes: Le nombre de threads qui se partagent une génération
+ * 
+ * origine: L'instant (en ns) du début des mesures
+ * 
+ * trace: Le fichier de la trace au format 'Chrome trace event' (NULL sinon)
+ * 
+ * verrou: Protège l'écriture dans la trace
+ * 
+ * nb_ecrits: Le nombre d'évènements écrits dans la trace
+ * 
+ * hud: 1 si les mesures sont affichées dans la fenêtre (touche 'h')
+ */
+typedef struct Mesures {
+    Serie *series;
+    unsigned int nb_bandes;
+    uint64_t origine;
+
+    FILE *trace;
+    pthread_mutex_t verrou;
+    unsigned long int nb_ecrits;
+
+    char hud;
+} Mesures;
+
+
+
+/**
+ * @brief Un niveau de la Pyramide: chaque case résume un carré de 2^k x 2^k
+ * cellules (k le numéro du niveau).
+ * 
+ * taille: Le nombre de cases sur une ligne (ou une colonne)
+ * 
+ * densite: La proportion de cellules vivantes de chaque case, sur 255
+ * 
+ * cellule: Le résumé des cellules de chaque case (voir Grille): 0 si la case
+ * est vide, sinon l'âge de la plus vieille cellule, avec le bit d'origine si
+ * l'une des cellules est originelle
+ */
+typedef struct NiveauPyramide {
+    unsigned int taille;
+    uint8_t *densite;
+    cellule *cellule;
+} NiveauPyramide;
+
+/**
+ * @brief La pyramide de densité d'une grille (voir pyramide.c), pour afficher
+ * plusieurs cellules par pixel: le niveau k résume des carrés de 2^k x 2^k
+ * cellules, chaque niveau est calculé à partir du précédent (la grille pour le
+ * niveau 1).
+ * 
+ * taille: La taille de la grille résumée
+ * 
+ * nb_niveaux: Le nombre de niveaux (le dernier n'a qu'une case)
+ * 
+ * niveaux: niveaux[k - 1] est le niveau k
+ * 
+ * obsolete: 1 si la pyramide doit être entièrement recalculée avant d'être
+ * affichée (la grille a changé sans qu'on sache où)
+ */
+typedef struct Pyramide {
+    unsigned int taille;
+    unsigned int nb_niveaux;
+    NiveauPyramide *niveaux;
+    char obsolete;
+} Pyramide;
+
+
+
+/**
+ * @brief L'univers du moteur hashlife. Sa structure n'est connue que de hashlife.c
+ */
+typedef struct HashLife HashLife;
+
+
+
 /**
  * @brief Structure représentant la 'caméra' dans la grille.
  * Permet d'afficher qu'une partie de la grille, pour simuler un zoom.
@@ -76,16 +749,26 @@ typedef struct Grille {
  * width est la largeur de la caméra, i.e la longueur/hauteur de la sous grille à afficher
  * 
  * max_width est la largeur maximale, i.e la taille réelle de la grille.
+ * 
+ * pixels est la largeur (et la hauteur) en pixels de la zone d'affichage. Si
+ * width la dépasse, un pixel représente plusieurs cellules (voir Pyramide).
+ * 
+ * Les coordonnées sont signées sur 64 bits: avec les moteurs non bornés
+ * (est_bornee à 0), la caméra peut se déplacer n'importe où dans l'univers.
+ * Sinon, elle reste dans la grille.
  */
 typedef struct Camera {
-    unsigned int centre_x;
-    unsigned int centre_y;
+    int64_t centre_x;
+    int64_t centre_y;
 
     unsigned int width;
     unsigned int max_width;
+    unsigned int pixels;
 
-    unsigned int origin_x;
-    unsigned int origin_y;
+    int64_t origin_x;
+    int64_t origin_y;
+
+    char est_bornee;
 } Camera;
 
 
@@ -106,37 +789,286 @@ typedef struct Camera {
  * 
  * de même pour renderer
  * 
+ * texture: La texture (1 pixel par cellule) où l'on dessine la partie de la
+ * grille vue par la caméra, avant de l'afficher agrandie (voir affiche_grille())
+ * 
  * estPause: 1 si le jeu est 'en pause', 0 sinon
  * 
  * estCouleur: 1 si le jeu est affiché en couleur, 0 sinon
  * 
+ * palette: La palette utilisée si le jeu est affiché en couleur
+ * 
  * estQuadrille: 1 si on affiche le quadrillage, 0 sinon
  * 
- * delay_ms: Le délai en ms entre 2 affichages de la grille
+ * delay_ms: Le délai en ms entre 2 générations (avec CADENCE_DELAI)
+ * 
+ * cadence: La façon de rythmer le calcul des générations
+ * 
+ * budget_ms: Le temps de calcul en ms accordé à chaque image affichée (avec CADENCE_IMAGE)
  * 
  * largeur_cell: La largeur d'une cellule dans la fenetre (diminue quand on dezoom)
  * 
+ * niveau_detail: Le niveau de détail affiché: 0 si une cellule fait au moins un pixel,
+ * sinon un pixel représente 2^niveau x 2^niveau cellules (et largeur_cell vaut 1)
+ * 
+ * pyramide: La pyramide de densité de la grille affichée, créée au premier
+ * dézoom sous 1 pixel par cellule (NULL avant, et pour le thread de simulation)
+ * 
+ * tampon: La grille où les moteurs scalaire et simd écrivent l'itération suivante (échangée
+ * ensuite avec grille). NULL si le moteur n'en a pas besoin.
+ * 
+ * moteur: Le moteur utilisé pour calculer la génération suivante
+ * 
+ * bitgrille: La grille utilisée par MOTEUR_BITBOARD (NULL sinon)
+ * 
+ * grille_obsolete: 1 si grille n'est plus à jour par rapport à bitgrille
+ * (voir synchronise_grille())
+ * 
+ * nb_threads: Le nombre de threads utilisés pour calculer la génération
+ * suivante. La grille est découpée en nb_threads bandes de lignes.
+ * 
+ * pool: Les threads utilisés si nb_threads > 1 (NULL sinon)
+ * 
+ * stats_threads: Les statistiques partielles de chaque thread
+ * 
+ * tuiles: Les tuiles actives de la grille (voir Tuiles)
+ * 
+ * hashlife: L'univers utilisé par MOTEUR_HASHLIFE (NULL sinon)
+ * 
+ * univers: L'univers utilisé par MOTEUR_UNIVERS (NULL sinon)
+ * 
+ * fenetre_x, fenetre_y: Les coordonnées dans l'univers de la cellule (0, 0) de
+ * grille. Toujours 0 pour les moteurs bornés, suit la caméra sinon (voir synchronise_grille())
+ * 
+ * saut: Le nombre de générations calculées à chaque étape par MOTEUR_HASHLIFE
+ * 
+ * budget_hashlife: La mémoire (en octets) utilisable par hashlife (noeuds et
+ * table de hachage) avant le passage du ramasse-miettes
+ * 
+ * fichier_sauvegarde: Le fichier où sauvegarder la partie (NULL si pas de sauvegarde)
+ * 
+ * sauvegarde_tous: On sauvegarde toutes les sauvegarde_tous générations (0 pour jamais)
+ * 
+ * derniere_sauvegarde: La génération de la dernière sauvegarde
+ * 
+ * demandes_sauvegarde: Le nombre de sauvegardes demandées par l'utilisateur (touche 's')
+ * 
+ * niveau_stats: Les statistiques calculées par les moteurs
+ * 
+ * journal: Le fichier des statistiques de chaque génération (avec STATS_GENERATION, NULL sinon)
+ * 
+ * regle: La règle du jeu (B3/S23 par défaut, voir regle.c)
+ * 
+ * topologie: Ce qu'il y a au-delà des bords de la grille (TOPOLOGIE_BORNEE par
+ * défaut, les moteurs hashlife et univers ne sont pas bornés)
+ * 
+ * cycles: La détection de cycles (NULL si désactivée)
+ * 
+ * generation_demandee: La dernière génération où l'utilisateur a demandé à
+ * aller une fois le cycle détecté (touche 'a', 0 si aucune)
+ * 
+ * saisie_active: 1 si l'utilisateur est en train de taper cette génération dans
+ * la fenêtre (après la touche 'a', jusqu'à Entrée ou Échap)
+ * 
+ * generation_saisie: La génération tapée jusqu'ici (affichée dans le titre)
+ * 
+ * mesures: La durée de chaque phase du calcul et de l'affichage (NULL si
+ * l'instrumentation est désactivée)
+ * 
  */ 
 typedef struct Jeu {
     Camera *cam;     // ? Stocker pointeurs ou struct direct ?
     Grille *grille;
+    Grille *tampon;
+    BitGrille *bitgrille;
     Stats *statistiques;
     SDL_Window *fenetre;
     SDL_Renderer *renderer;
+    SDL_Texture *texture;
 
     char estPause;
     char estCouleur;
+    Palette palette;
     char estQuadrille;
     unsigned int delay_ms;
+    Cadence cadence;
+    unsigned int budget_ms;
     unsigned int largeur_cell;
+    unsigned int niveau_detail;
+    Pyramide *pyramide;
+
+    Moteur moteur;
+    char grille_obsolete;
+
+    unsigned int nb_threads;
+    Pool *pool;
+    StatsThread *stats_threads;
+    Tuiles *tuiles;
+
+    HashLife *hashlife;
+    unsigned long int saut;
+    size_t budget_hashlife;
+
+    Univers *univers;
+    int64_t fenetre_x;
+    int64_t fenetre_y;
+
+    const char *fichier_sauvegarde;
+    unsigned long int sauvegarde_tous;
+    unsigned long int derniere_sauvegarde;
+    unsigned int demandes_sauvegarde;
+
+    NiveauStats niveau_stats;
+    Journal *journal;
+
+    Regle regle;
+    Topologie topologie;
+    Cycles *cycles;
+    unsigned long int generation_demandee;
+    char saisie_active;
+    unsigned long int generation_saisie;
+
+    Mesures *mesures;
 } Jeu;
 
 
 
+/**
+ * @brief Une image de la grille publiée par le thread de simulation pour
+ * l'affichage (voir Simulation).
+ * 
+ * grille: Une copie de la grille du moteur
+ * 
+ * statistiques: Les statistiques du jeu à cette génération
+ * 
+ * fenetre_x, fenetre_y: Les coordonnées dans l'univers de la cellule (0, 0) de grille
+ * 
+ * modifiees: Les tuiles (voir Tuiles) qui ont changé depuis l'image précédente,
+ * pour mettre à jour la Pyramide de l'affichage
+ * 
+ * toutes_modifiees: 1 si toute la grille a pu changer depuis l'image précédente
+ * (modifiees n'est alors pas lu)
+ */
+typedef struct Image {
+    Grille *grille;
+    Stats statistiques;
+    int64_t fenetre_x;
+    int64_t fenetre_y;
+    unsigned char *modifiees;
+    char toutes_modifiees;
+} Image;
+
+// Bit de Simulation.etat: l'image du milieu n'a pas encore été prise par l'affichage
+#define IMAGE_NOUVELLE 4
+
+/**
+ * @brief Structure représentant le thread de simulation (voir simulation.c):
+ * il calcule les générations pendant que le thread principal gère les
+ * évènements et l'affichage.
+ * 
+ * Les générations sont transmises par un triple tampon sans verrou: le thread
+ * de simulation écrit dans l'image 'arriere', l'affichage lit l'image 'avant',
+ * et la troisième (celle du 'milieu') est échangée atomiquement par l'un ou
+ * l'autre. Aucun des deux threads n'attend jamais l'autre.
+ * 
+ * calcul: Le Jeu utilisé par le thread de simulation (il possède le moteur)
+ * 
+ * etat: L'indice de l'image du milieu, et IMAGE_NOUVELLE si elle n'a pas été lue
+ * 
+ * arriere: L'indice de l'image écrite par la simulation (utilisé par elle seule)
+ * 
+ * avant: L'indice de l'image affichée (utilisé par l'affichage seul)
+ * 
+ * arret, pause, couleur, delay_ms, cadence, budget_ms, saut, origine_x, origine_y, largeur, demandes_sauvegarde,
+ * generation_demandee: Les commandes de l'utilisateur, recopiées par l'affichage à chaque image (voir publie_commandes())
+ * 
+ * nb_tours: Le nombre de générations à calculer (-1 si pas de limite)
+ * 
+ * modifiees, toutes_modifiees: Les tuiles qui ont changé depuis la dernière
+ * image publiée (utilisés par la simulation seule, recopiés dans l'Image)
+ */
+typedef struct Simulation {
+    pthread_t thread;
+    Jeu *calcul;
+
+    Image images[3];
+    atomic_uint etat;
+    unsigned int arriere;
+    unsigned int avant;
+
+    atomic_char arret;
+    atomic_char pause;
+    atomic_char couleur;
+    atomic_uint delay_ms;
+    atomic_int cadence;
+    atomic_uint budget_ms;
+    atomic_ulong saut;
+    _Atomic int64_t origine_x;
+    _Atomic int64_t origine_y;
+    atomic_uint largeur;
+    atomic_uint demandes_sauvegarde;
+    atomic_ulong generation_demandee;
+    long int nb_tours;
+
+    unsigned char *modifiees;
+    char toutes_modifiees;
+} Simulation;
+
+/**
+ * @brief Une recherche de soupes (voir recherche.c): des milliers de
+ * configurations aléatoires, chacune calculée dans sa propre grille jusqu'à ce
+ * qu'elle devienne périodique (ou jusqu'à max_generations).
+ * 
+ * moteur, regle, topologie, taille: Le moteur (borné), la règle, la topologie et la taille de la grille de chaque soupe
+ * 
+ * nb_soupes: Le nombre de soupes à calculer
+ * 
+ * max_generations: Le nombre de générations après lequel on abandonne une soupe
+ * 
+ * soupe: Les paramètres des soupes, soupe.graine est la graine de la première
+ * (la soupe i a la graine soupe.graine + i)
+ * 
+ * resultats: Le fichier où chaque soupe ajoute une ligne (graine, population
+ * finale, durée de vie, période, topologie)
+ * 
+ * suivante: Le numéro de la prochaine soupe à calculer (partagé par les threads)
+ * 
+ * verrou: Protège le résumé de la recherche (les champs suivants)
+ * 
+ * stabilisees: Le nombre de soupes devenues périodiques avant max_generations
+ * 
+ * plus_longue, graine_plus_longue: La plus longue durée de vie, et sa soupe
+ * 
+ * periode_max, graine_periode_max: La plus grande période trouvée, et sa soupe
+ */
+typedef struct Recherche {
+    Moteur moteur;
+    Regle regle;
+    Topologie topologie;
+    unsigned int taille;
+    unsigned long int nb_soupes;
+    unsigned long int max_generations;
+    Soupe soupe;
+    FILE *resultats;
+
+    atomic_ulong suivante;
+    pthread_mutex_t verrou;
+    unsigned long int stabilisees;
+    unsigned long int plus_longue;
+    uint64_t graine_plus_longue;
+    unsigned long int periode_max;
+    uint64_t graine_periode_max;
+} Recherche;
+
+
+
 Stats *init_stats();
 Grille *init_grille(unsigned int taille);
-cellule **init_matrice(unsigned int taille);
+BitGrille *init_bitgrille(unsigned int taille);
+cellule *init_matrice(unsigned int taille, unsigned int *pas);
 Camera *init_camera(unsigned int taille, unsigned int taille_max);
+Tuiles *init_tuiles(unsigned int taille);
+Univers *init_univers();
 Jeu *init_jeu(unsigned int taille_choisie, unsigned int largeur_f, unsigned int hauteur_f);
 
 Grille *copie_grille(Grille *grille);
@@ -144,7 +1076,12 @@ void free_jeu(Jeu *jeu);
 void affiche_stats(Stats *statistiques);
 
 void free_grille(Grille *grille);
-void free_matrice(cellule **matrice, unsigned int taille);
+void free_tuiles(Tuiles *tuiles);
+void free_univers(Univers *univers);
+void free_bitgrille(BitGrille *bitgrille);
+uint64_t *init_plan(unsigned int taille, unsigned int pas);
+void free_plan(uint64_t *plan, unsigned int pas);
+void free_matrice(cellule *matrice, unsigned int pas);
 
 
 #endif
@@ -0,0 +1,24 @@
+/**
+ * @file univers.h
+ * @author M3tex
+ * @brief Header pour univers.c
+ * @version 0.1
+ * @date 2022-12-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#ifndef UNIVERS_HEADER
+#define UNIVERS_HEADER
+
+
+#include "types.h"
+
+
+void maj_univers(Univers *univers, const Regle *regle, Stats *partielles, uint64_t *empreinte);
+unsigned long int originelles_univers(const Univers *univers);
+void grille2univers(Grille *grille, Univers *univers, int64_t x, int64_t y);
+void univers2grille(Univers *univers, Grille *grille, int64_t x, int64_t y);
+
+
+#endif
@@ -12,12 +12,16 @@
 #define UTILS_HEADER
 
 
+#include <stdint.h>
+
+
 void print_redb(const char *msg);
 void quitter(const char *msg, int code_err);
 
 char is_int(char *s);
 char string2int(char *s, int *result);
 char string2uint(char *s, unsigned int *result);
+char string2uint64(char *s, uint64_t *result);
 char mult_int(int x, int y, int *result);
 char mult_uint(unsigned int x, unsigned int y, unsigned int *result);
 char add_int(int x, int y, int *result);
@@ -11,10 +11,17 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <limits.h>
 #include <SDL2/SDL.h>
 #include "utilitaires.h"
 #include "logique.h"
 #include "affichage.h"
+#include "palette.h"
+#include "motifs.h"
+#include "soupe.h"
+#include "parallele.h"
+#include "mesures.h"
+#include "pyramide.h"
 #include "types.h"
 
 
@@ -22,7 +29,7 @@
 
 /**
  * @brief Permet de charger une configuration pré-enregistrée
- * dans un fichier.gol
+ * dans un fichier (.gol, RLE ou Life 1.06, voir motifs.c)
  *
  * @param fichier Le chemin vers le fichier à ouvrir
  * @param jeu Un pointeur sur le Jeu
@@ -32,161 +39,181 @@
  */
 char file2grid(const char *fichier, Jeu *jeu, int x, int y)
 {
-    // + lisible
-    unsigned int taille = jeu -> grille -> taille;
-    cellule **matrice = jeu -> grille -> matrice;
-
     printf("Le fichier choisit: %s\n", fichier);
-    FILE *f = fopen(fichier, "r");
+    FILE *f = fopen(fichier, "rb");
     if (f == NULL)
     {
         print_redb("Impossible de charger le fichier. Vérifiez que le nom est correct.\n");
         return 0;
     }
 
-    /* La première ligne contient la taille des lignes suivantes.
-    On considère que la taille sera inférieure à 10^10 */
-    char *nb_str = (char *) malloc(sizeof(char) * (10 + 1));
-    if (nb_str == NULL) quitter("Impossible d'allouer de la mémoire pour lire le fichier", 2);
-
-    char c = getc(f);
-    unsigned char cpt = 0;
-    while (c != '\n')
+    // On lit tout le fichier d'un coup
+    fseek(f, 0, SEEK_END);
+    long taille = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    if (taille < 0)
     {
-        nb_str[cpt] = (unsigned char) c;
-        c = getc(f);
-        cpt++;
+        fclose(f);
+        return 0;
     }
 
-    // On passe au suivant car le char actuel est '\n'
-    c = getc(f);
-    nb_str[cpt] = '\0';
-    
-    unsigned int nb = 0;
-    if (!string2uint(nb_str, &nb)) return 0;
-    free(nb_str);
-    nb_str = NULL;
+    char *donnees = (char *) malloc(taille + 1);
+    if (donnees == NULL) quitter("Impossible d'allouer de la mémoire pour lire le fichier", 2);
+    size_t lus = fread(donnees, 1, taille, f);
+    fclose(f);
+    donnees[lus] = '\0';
 
-    // On vérifie que le paterne rentre bien aux coordonées données
-    if (x + nb > taille || y + nb > taille) return 0;
+    char resultat = charge_motif(donnees, lus, jeu, x, y);
+    free(donnees);
+    return resultat;
+}
 
 
-    // On parcourt ensuite les autres lignes
-    char *ligne = (char *) malloc(sizeof(char) * (nb + 1));     // +1 pour le \0
-    if (ligne == NULL) quitter("Impossible d'allouer de la mémoire pour lire le fichier", 2);
 
-    ligne[nb] = '\0';
-    unsigned int i = 0;
-    unsigned int nb_lignes = 0;
-    while (c != EOF)
-    {
-        // Si on change de ligne, on charge la ligne dans la grille
-        if (c == '\n' && i != 0)
-        {
-            for (unsigned int j = 0; j < nb; j++)
-            {
-                if (ligne[j] == '1')
-                {
-                    matrice[nb_lignes + y][j + x] = (1 << 7) + 1;  // 1 << 7 car cell originelle
-                    jeu -> statistiques -> nb_cellules_depart++;
-                }
-                ligne[j] = 'X';     // marqueur pour + tard (pour savoir si il reste une ligne)
-            }
-            c = getc(f);
-            i = 0;
-            nb_lignes++;
-            continue;
-        }
 
-        ligne[i++] = c;
-        c = getc(f);
-    }
-    // On rajoute la dernière ligne si besoin
-    if (ligne[0] != 'X')
+/**
+ * @brief Affiche la grille dans la fenetre SDL, après l'avoir mise à jour
+ * par rapport au moteur.
+ * 
+ * @param jeu Un pointeur sur le Jeu
+ */
+void affiche_grille(Jeu *jeu)
+{
+    // La caméra doit rester dans la grille (une seule fois par image)
+    update_camera(jeu -> cam);
+
+    // On s'assure que la grille à afficher est à jour par rapport au moteur
+    synchronise_grille(jeu);
+    dessine_grille(jeu);
+}
+
+
+
+/**
+ * @brief Écrit dans la texture (déjà verrouillée) les taille_cam x taille_cam
+ * pixels vus par la caméra quand un pixel représente plusieurs cellules: un
+ * pixel par case du niveau jeu -> niveau_detail de la pyramide (voir
+ * pyramide.c), créée ou recalculée ici si besoin.
+ */
+static void dessine_pyramide(Jeu *jeu, void *pixels, int pitch, unsigned int taille_cam, const uint32_t *table)
+{
+    // + lisible
+    unsigned int k = jeu -> niveau_detail;
+    Camera *cam = jeu -> cam;
+
+    if (jeu -> pyramide == NULL) jeu -> pyramide = init_pyramide(jeu -> grille -> taille);
+    if (jeu -> pyramide -> obsolete) maj_pyramide(jeu -> pyramide, jeu -> grille, NULL);
+
+    // Le pixel (i, j) est la case ((dy >> k) + i, (dx >> k) + j) du niveau k
+    int64_t dx = cam -> origin_x - jeu -> fenetre_x, dy = cam -> origin_y - jeu -> fenetre_y;
+    for (unsigned int i = 0; i < taille_cam; i++)
     {
-        for (unsigned int j = 0; j < nb; j++)
-        {
-            if (ligne[j] == '1')
-            {
-                matrice[i - 1 + y][j + x] = (1 << 7) + 1;
-                jeu -> statistiques -> nb_cellules_depart++;
-            }
-        }
+        uint32_t *ligne = (uint32_t *) ((char *) pixels + (size_t) i * pitch);
+        niveau2pixels(jeu -> pyramide, k, (dy >> k) + i, dx >> k, ligne, taille_cam, table, jeu -> estCouleur);
     }
-    free(ligne);
-    return 1;
 }
 
 
 
-
 /**
- * @brief Affiche la grille dans la fenetre SDL
+ * @brief Dessine jeu -> grille telle quelle dans la fenetre SDL.
+ * 
+ * Les cellules vues par la caméra sont écrites dans une texture (1 pixel par
+ * cellule), qui est ensuite affichée agrandie en un seul appel. Le quadrillage
+ * est lui aussi dessiné en un seul appel.
+ * 
+ * Si la caméra voit plus de cellules que la fenêtre n'a de pixels, chaque
+ * pixel résume un carré de cellules (voir dessine_pyramide()): le dessin ne
+ * dépend alors que de la taille de la fenêtre.
+ * 
+ * Avec un moteur non borné, la grille peut avoir été calculée pour une
+ * position précédente de la caméra (voir simulation.c): ce qui n'y est pas
+ * est affiché en noir.
  * 
  * @param jeu Un pointeur sur le Jeu
  */
-void affiche_grille(Jeu *jeu)
+void dessine_grille(Jeu *jeu)
 {
+    uint64_t debut_dessin = debut_mesure(jeu -> mesures);
+
     // + lisible (évite les jeu -> XXX -> XXX)
     SDL_Renderer *renderer = jeu -> renderer;
     unsigned int largeur_cell = jeu -> largeur_cell;
-    unsigned int taille_cam = jeu -> cam -> width;
-    cellule **matrice = jeu -> grille -> matrice;
+    unsigned int niveau = jeu -> niveau_detail;
+    Grille *grille = jeu -> grille;
     Camera *cam = jeu -> cam;
 
+    // Le nombre de pixels de la caméra (sur une ligne): une case de la pyramide par pixel sous 1 pixel par cellule
+    unsigned int taille_cam = (unsigned int) (((uint64_t) cam -> width + ((uint64_t) 1 << niveau) - 1) >> niveau);
 
-    // On met la couleur du fond en noir
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
-    SDL_RenderClear(renderer);
-
-    SDL_Rect tmp_rect;
-    tmp_rect.h = largeur_cell;
-    tmp_rect.w = largeur_cell;
+    // On écrit les cellules dans la texture: noir si morte, blanc (ou sa couleur) si vivante
+    SDL_Rect source = {0, 0, taille_cam, taille_cam};
+    void *pixels;
+    int pitch;
+    if (SDL_LockTexture(jeu -> texture, &source, &pixels, &pitch) != 0)
+    {
+        printf("Erreur SDL: %s\n", SDL_GetError());
+        quitter("Impossible de continuer suite à l'erreur.", 3);
+    }
 
-    // On affiche les cellules en blanc par défaut
-    unsigned char r = 255, g = 255, b = 255;
-    SDL_SetRenderDrawColor(renderer, r, g, b, SDL_ALPHA_OPAQUE);
-    for (unsigned int i = 0; i < taille_cam; i++)
+    // Les couleurs de chaque octet de cellule sont précalculées (voir palette.c)
+    const uint32_t *table = table_palette(jeu -> palette, jeu -> estCouleur);
+    if (niveau > 0) dessine_pyramide(jeu, pixels, pitch, taille_cam, table);
+
+    // La grille commence en (fenetre_x, fenetre_y): colonnes [debut, fin) de la caméra présentes dans la grille
+    int64_t dx = cam -> origin_x - jeu -> fenetre_x, dy = cam -> origin_y - jeu -> fenetre_y;
+    int64_t debut = (dx < 0) ? -dx : 0;
+    int64_t fin = (int64_t) grille -> taille - dx;
+    if (debut > taille_cam) debut = taille_cam;
+    if (fin > taille_cam) fin = taille_cam;
+    if (fin < debut) fin = debut;
+    for (unsigned int i = 0; i < taille_cam && niveau == 0; i++)
     {
-        for (unsigned int j = 0; j < taille_cam; j++)
+        uint32_t *ligne = (uint32_t *) ((char *) pixels + (size_t) i * pitch);
+        if (dy + i < 0 || dy + i >= grille -> taille)
         {
-            /* Permet de s'assurer que on aura pas de segfault et que la caméra
-            reste bien dans la grille */
-            update_camera(cam);
-
-            // On affiche que les cellules vivantes
-            if (matrice[cam -> origin_y + i][cam -> origin_x + j])
-            {
-                tmp_rect.x = j * largeur_cell;
-                tmp_rect.y = i * largeur_cell;
+            for (unsigned int j = 0; j < taille_cam; j++) ligne[j] = table[0];
+            continue;
+        }
 
-                if (jeu -> estCouleur) get_color(matrice[cam -> origin_y + i][cam -> origin_x + j], &r, &g, &b);
+        for (int64_t j = 0; j < debut; j++) ligne[j] = table[0];
+        cellules2pixels(&CELLULE(grille, dy + i, dx + debut), ligne + debut, fin - debut, table);
+        for (int64_t j = fin; j < taille_cam; j++) ligne[j] = table[0];
+    }
+    SDL_UnlockTexture(jeu -> texture);
 
-                /* On vérifie que la couleur ne soit pas noir, si c'est le cas
-                on la met en blanc (pour éviter d'avoir du noir sur du noir) */
-                if (r == 0 && g == 0 && b == 0) r = 255, g = 255, b = 255;
+    // On affiche la texture agrandie sur un fond noir: chaque pixel devient une cellule de largeur_cell pixels
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, SDL_ALPHA_OPAQUE);
+    SDL_RenderClear(renderer);
+    SDL_Rect destination = {0, 0, taille_cam * largeur_cell, taille_cam * largeur_cell};
+    SDL_RenderCopy(renderer, jeu -> texture, &source, &destination);
 
-                SDL_SetRenderDrawColor(renderer, r, g, b, SDL_ALPHA_OPAQUE);
-                SDL_RenderFillRect(renderer, &tmp_rect);
-            }
-        }
+    // Affichage du quadrillage si choisit par l'utilisateur (lignes verticales puis horizontales), pas sous 1 pixel par cellule
+    if (jeu -> estQuadrille && niveau == 0)
+    {
+        SDL_Rect *lignes = (SDL_Rect *) malloc(sizeof(SDL_Rect) * 2 * taille_cam);
+        if (lignes == NULL) quitter("Impossible d'allouer de la mémoire pour le quadrillage\n", 2);
 
-        // Affichage du quadrillage si choisit par l'utilisateur
-        if (jeu -> estQuadrille)
+        for (unsigned int i = 0; i < taille_cam; i++)
         {
-            // On affiche les lignes en blanc
-            SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
-            
-            // Lignes verticales
-            SDL_RenderDrawLine(renderer, i * largeur_cell, 0, i * largeur_cell, cam -> max_width);
-
-            // Lignes horizontales
-            SDL_RenderDrawLine(renderer, 0, i * largeur_cell, cam -> max_width, i * largeur_cell);
+            lignes[i] = (SDL_Rect) {i * largeur_cell, 0, 1, cam -> pixels};
+            lignes[taille_cam + i] = (SDL_Rect) {0, i * largeur_cell, cam -> pixels, 1};
         }
+
+        // On affiche les lignes en blanc
+        SDL_SetRenderDrawColor(renderer, 255, 255, 255, SDL_ALPHA_OPAQUE);
+        SDL_RenderFillRects(renderer, lignes, 2 * taille_cam);
+        free(lignes);
     }
 
+    // Les mesures (voir mesures.c) par-dessus la grille
+    if (jeu -> mesures != NULL) dessine_hud(renderer, jeu -> mesures);
+    fin_mesure(jeu -> mesures, PHASE_DESSIN, 0, debut_dessin);
+
     // On affiche tout d'un coup
+    uint64_t debut_presentation = debut_mesure(jeu -> mesures);
     SDL_RenderPresent(renderer);
+    fin_mesure(jeu -> mesures, PHASE_PRESENTATION, 0, debut_presentation);
 }
 
 
@@ -204,7 +231,7 @@ void init_fichier(Jeu *jeu)
 
     char file[50];      // On considère qu'un nom de fichier ne dépassera pas 50 caractères.
     system(CLEAR);
-    printf("Choisissez un fichier (au format templates/[nom fichier.gol]) avec nom fichier parmi:\n");
+    printf("Choisissez un fichier (au format templates/[nom fichier.gol], ou un fichier RLE / Life 1.06) avec nom fichier parmi:\n");
     system(LS);
     print_redb("\nPour spacefiller: très joli en couleur mais:\n");
     print_redb("attention aux performances si grille > 500x500 (zoomer pour aller + vite)\n");
@@ -234,7 +261,7 @@ void init_fichier(Jeu *jeu)
 void init_terminal(Jeu *jeu)
 {
     // + lisible
-    cellule **matrice = jeu -> grille -> matrice;
+    Grille *grille = jeu -> grille;
     Camera *cam = jeu -> cam;
 
     unsigned int nb_cell_debut = get_uint("Combien de cellules de départ ?");
@@ -246,7 +273,7 @@ void init_terminal(Jeu *jeu)
         // idem on ramène aux vraies coordonnés dans la grille complète
         x = (cam -> origin_x) + x;
         y = (cam -> origin_y) + y;
-        matrice[y][x] = (1 << 7) + 1;       // 1 << 7 car cellule originelle
+        CELLULE(grille, y, x) = (1 << 7) + 1;       // 1 << 7 car cellule originelle
     }
     jeu -> statistiques -> nb_cellules_depart = nb_cell_debut;
     init_GUI(jeu);
@@ -255,44 +282,45 @@ void init_terminal(Jeu *jeu)
 
 
 /**
- * @brief Permet d'obtenir une configuration de départ aléatoire, à l'image
- * des 'soup search' utilisés pour trouver de nouvelles structures
- * (voir https://conwaylife.com/wiki/Soup)
+ * @brief Remplit toute la grille avec une soupe (voir soupe.c), sans rien
+ * afficher. Les lignes sont tirées par le pool du jeu s'il utilise plusieurs
+ * threads (init_moteur() le réutilise).
  * 
  * @param jeu Un pointeur sur le jeu concerné
+ * @param soupe Un pointeur sur les paramètres de la soupe
  */
-void init_rdm(Jeu *jeu)
+void init_aleatoire(Jeu *jeu, const Soupe *soupe)
 {
-    // + lisible
-    Camera *cam = jeu -> cam;
-    unsigned int taille = cam -> width;
-    cellule **matrice = jeu -> grille -> matrice;
+    if (jeu -> nb_threads > 1 && jeu -> pool == NULL) jeu -> pool = init_pool(jeu -> nb_threads);
+    jeu -> statistiques -> nb_cellules_depart = remplit_soupe(jeu -> grille, soupe, jeu -> pool);
+}
 
-    // On parcourt la sous-grille de taille sélectionnée par l'utilisateur
-    for (unsigned int i = 0; i < taille; i++)
-    {
-        for (unsigned int j = 0; j < taille; j++)
-        {
-            if (random() & 1)
-            {
-                matrice[cam -> origin_y + i][cam -> origin_x + j] = (1 << 7) + 1;
-                jeu -> statistiques -> nb_cellules_depart++;
-            }
-        }
-    }
 
+
+/**
+ * @brief Permet d'obtenir une configuration de départ aléatoire, à l'image
+ * des 'soup search' utilisés pour trouver de nouvelles structures
+ * (voir https://conwaylife.com/wiki/Soup). Les paramètres sont affichés pour
+ * pouvoir la reproduire.
+ * 
+ * @param jeu Un pointeur sur le jeu concerné
+ * @param soupe Un pointeur sur les paramètres de la soupe
+ */
+void init_rdm(Jeu *jeu, const Soupe *soupe)
+{
+    affiche_soupe(soupe);
+    init_aleatoire(jeu, soupe);
     init_GUI(jeu);
 }
 
 
 
 /**
- * @brief Permet de demander une configuration initiale à l'utilisateur.
- * La configuration sera demandée depuis le GUI.
+ * @brief Crée la fenêtre, le renderer et la texture du jeu.
  * 
  * @param jeu Un pointeur sur le jeu concerné
  */
-void init_GUI(Jeu *jeu)
+void init_fenetre(Jeu *jeu)
 {
     jeu -> fenetre = SDL_CreateWindow("Configuration initiale", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, largeur_f, hauteur_f, 0);
     if (jeu -> fenetre == NULL)
@@ -308,6 +336,28 @@ void init_GUI(Jeu *jeu)
         quitter("Impossible de continuer suite à l'erreur.", 3);
     }
 
+    // La texture couvre toute la zone d'affichage (la caméra n'en utilise qu'une partie si on zoome)
+    jeu -> texture = SDL_CreateTexture(jeu -> renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING,
+                                       jeu -> cam -> pixels, jeu -> cam -> pixels);
+    if (jeu -> texture == NULL)
+    {
+        printf("Erreur SDL: %s\n", SDL_GetError());
+        quitter("Impossible de continuer suite à l'erreur.", 3);
+    }
+}
+
+
+
+/**
+ * @brief Permet de demander une configuration initiale à l'utilisateur.
+ * La configuration sera demandée depuis le GUI.
+ * 
+ * @param jeu Un pointeur sur le jeu concerné
+ */
+void init_GUI(Jeu *jeu)
+{
+    init_fenetre(jeu);
+
     // On affiche les commandes spécifiques à la configuration initiale et on lance la boucle d'affichage
     affiche_commandes(jeu, 1);
     char affiche = 1;
@@ -324,6 +374,42 @@ void init_GUI(Jeu *jeu)
 
 
 
+/**
+ * @brief Gère une touche pendant la saisie de la génération où aller (touche
+ * 'a'): la génération est tapée dans la fenêtre, sans bloquer l'affichage
+ * comme le ferait une lecture dans le terminal. Entrée la transmet à la
+ * simulation (voir publie_commandes()), Échap annule.
+ * 
+ * @param jeu Un pointeur sur le Jeu concerné
+ * @param touche La touche pressée
+ * @return char 1 si la touche sert à la saisie, 0 sinon (elle garde alors son rôle habituel)
+ */
+static char saisie_generation(Jeu *jeu, SDL_Keycode touche)
+{
+    switch (touche)
+    {
+    case SDLK_0: case SDLK_1: case SDLK_2: case SDLK_3: case SDLK_4:
+    case SDLK_5: case SDLK_6: case SDLK_7: case SDLK_8: case SDLK_9:
+        // On ignore les chiffres qui feraient déborder la génération
+        if (jeu -> generation_saisie <= (ULONG_MAX - 9) / 10) jeu -> generation_saisie = jeu -> generation_saisie * 10 + (touche - SDLK_0);
+        return 1;
+    case SDLK_BACKSPACE:
+        jeu -> generation_saisie /= 10;
+        return 1;
+    case SDLK_RETURN:
+        jeu -> generation_demandee = jeu -> generation_saisie;
+        jeu -> saisie_active = 0;
+        return 1;
+    case SDLK_ESCAPE:
+        jeu -> saisie_active = 0;
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+
+
 /**
  * @brief Permet de gérér les évènements SDL:
  * Par exemple permet de quitter la boucle de jeu
@@ -340,7 +426,7 @@ void watch_events(SDL_Event *event, Jeu *jeu, char *gameloop, char estConfig)
     // + lisible
     unsigned int largeur_cell = jeu -> largeur_cell;
     Camera *cam = jeu -> cam;
-    cellule **matrice = jeu -> grille -> matrice;
+    Grille *grille = jeu -> grille;
     
     // ? casser en plusieurs sous-fonction car trop grosse ?
 
@@ -365,25 +451,31 @@ void watch_events(SDL_Event *event, Jeu *jeu, char *gameloop, char estConfig)
         // Si l'utilisateur fait un click on récupère les coordonées du click
         case SDL_MOUSEBUTTONDOWN:
             clicked = event -> button;
-            click_x = cam -> origin_x + (clicked.x / largeur_cell), click_y = cam -> origin_y + (clicked.y / largeur_cell);
+
+            // Sous 1 pixel par cellule, on prend la première cellule du carré représenté par le pixel
+            click_x = cam -> origin_x + ((clicked.x / largeur_cell) << jeu -> niveau_detail);
+            click_y = cam -> origin_y + ((clicked.y / largeur_cell) << jeu -> niveau_detail);
+            if (click_x >= grille -> taille || click_y >= grille -> taille) break;
 
             // On regarde quel bouton est pressé et on agit en conséquence
             switch (clicked.button)
             {
                 case SDL_BUTTON_LEFT:
                     // Si appui sur bouton gauche on ajoute une cellule (menu config seulement)
-                    if (estConfig && !matrice[click_y][click_x])
+                    if (estConfig && !CELLULE(grille, click_y, click_x))
                     {
-                        matrice[click_y][click_x] = (1 << 7) + 1;     // (1 << 7) + 1 pour stats sur cellules originelles.
+                        CELLULE(grille, click_y, click_x) = (1 << 7) + 1;     // (1 << 7) + 1 pour stats sur cellules originelles.
                         jeu -> statistiques -> nb_cellules_depart++;
+                        if (jeu -> pyramide != NULL) jeu -> pyramide -> obsolete = 1;
                     }
                     break;
                 case SDL_BUTTON_RIGHT:
                     // Si appui sur bouton droit on supprime la cellule (menu config seulement)
-                    if (estConfig && matrice[click_y][click_x])
+                    if (estConfig && CELLULE(grille, click_y, click_x))
                     {
-                        matrice[click_y][click_x] = 0;
+                        CELLULE(grille, click_y, click_x) = 0;
                         jeu -> statistiques -> nb_cellules_depart--;
+                        if (jeu -> pyramide != NULL) jeu -> pyramide -> obsolete = 1;
                     }
                     break;
                 default:
@@ -403,70 +495,70 @@ void watch_events(SDL_Event *event, Jeu *jeu, char *gameloop, char estConfig)
             scrolled = event -> wheel;
             old_width = cam -> width;
 
-            /* On vérifie qu'on peut réduire la largeur des cellules.
-            scrolled.y vaut 1 ou -1 en fonction du sens de rotation de la molette */
-            if (largeur_cell + scrolled.y >= 1 && largeur_cell + scrolled.y < cam -> max_width)
+            /* Sous 1 pixel par cellule, on dézoome par puissances de 2 (voir dessine_pyramide()),
+            tant que la caméra ne voit pas toute la grille. scrolled.y vaut 1 ou -1 en fonction du sens
+            de rotation de la molette */
+            if (jeu -> niveau_detail > 0 || (largeur_cell == 1 && scrolled.y < 0))
+            {
+                if (scrolled.y > 0) regle_zoom(jeu, cam -> pixels << (jeu -> niveau_detail - 1));
+                else if (cam -> width < cam -> max_width) regle_zoom(jeu, cam -> pixels << (jeu -> niveau_detail + 1));
+            }
+            // Sinon on vérifie qu'on peut réduire la largeur des cellules
+            else if (largeur_cell + scrolled.y >= 1 && largeur_cell + scrolled.y < cam -> pixels)
             {
                 largeur_cell += scrolled.y;
-                cam -> width = cam -> max_width / largeur_cell;
+                cam -> width = min_uint(cam -> pixels / largeur_cell, cam -> max_width);
 
                 /* Évite des mouvements de caméra brusques (honnêtement je ne sais pas pourquoi il 
                 y a des mouvements brusques si je mets jeu -> largeur_cell += scrolled.y directement)*/
                 jeu -> largeur_cell = largeur_cell;
+            }
 
-                // On met à jour la caméra seulement si la largeur change (inutile sinon)
-                if (cam -> width != old_width && cam -> centre_x >= (cam -> width / 2) && cam -> centre_y >= (cam -> width / 2))
-                {
-                    cam -> origin_x = cam -> centre_x - (cam -> width / 2);
-                    cam -> origin_y = cam -> centre_y - (cam -> width / 2);
-                    update_camera(cam);
-                }
+            // On met à jour la caméra seulement si la largeur change (inutile sinon)
+            if (cam -> width != old_width)
+            {
+                cam -> origin_x = cam -> centre_x - (cam -> width / 2);
+                cam -> origin_y = cam -> centre_y - (cam -> width / 2);
+                update_camera(cam);
             }
             break;
         
         case SDL_KEYDOWN:
+            // Pendant la saisie d'une génération (touche 'a'), les chiffres, Entrée, Retour arrière et Échap servent à la saisie
+            if (jeu -> saisie_active && saisie_generation(jeu, (event -> key).keysym.sym)) break;
+
             // Détecte les touches pressées
             switch ((event -> key).keysym.sym)
             {
             case SDLK_UP:
-                // On translate notre origine vers le haut
-                if (cam -> origin_y - 1 <= cam -> max_width && cam -> origin_y - 1 + cam -> width < cam -> max_width)    // 1ère condition car 0 - 1 = UINT_MAX
-                {
-                    cam -> origin_y--;
-                    update_camera(jeu -> cam);
-                }
+                /* On translate notre origine vers le haut (update_camera() nous garde dans la grille),
+                d'un pixel: plusieurs cellules sous 1 pixel par cellule */
+                cam -> origin_y -= (int64_t) 1 << jeu -> niveau_detail;
+                update_camera(cam);
                 break;
             case SDLK_DOWN:
                 // On translate notre origine vers le bas
-                if (cam -> origin_y + 1 <= cam -> max_width && cam -> origin_y + 1 + cam -> width < cam -> max_width)
-                {
-                    cam -> origin_y++;
-                    update_camera(cam);
-                }
+                cam -> origin_y += (int64_t) 1 << jeu -> niveau_detail;
+                update_camera(cam);
                 break;
             case SDLK_LEFT:
                 // On translate notre origine vers la gauche
-                if (cam -> origin_x - 1 <= cam -> max_width && cam -> origin_x - 1 + cam -> width < cam -> max_width)
-                {
-                    cam -> origin_x--;
-                    update_camera(cam);
-                }
+                cam -> origin_x -= (int64_t) 1 << jeu -> niveau_detail;
+                update_camera(cam);
                 break;
             case SDLK_RIGHT:
                 // On translate notre origine vers la droite
-                if (cam -> origin_x + 1 <= cam -> max_width && cam -> origin_x + 1 + cam -> width < cam -> max_width)
-                {
-                    cam -> origin_x++;
-                    update_camera(cam);
-                }
+                cam -> origin_x += (int64_t) 1 << jeu -> niveau_detail;
+                update_camera(cam);
                 break;
             
             // On reset la grille si menu de config et touche R pressée
             case SDLK_r:
                 if (estConfig)
                 {
-                    free_matrice(jeu -> grille -> matrice, jeu -> grille -> taille);
-                    jeu -> grille -> matrice = init_matrice(jeu -> grille -> taille);
+                    free_matrice(grille -> matrice, grille -> pas);
+                    grille -> matrice = init_matrice(grille -> taille, &(grille -> pas));
+                    if (jeu -> pyramide != NULL) jeu -> pyramide -> obsolete = 1;
                 }
                 break;
             
@@ -485,17 +577,62 @@ void watch_events(SDL_Event *event, Jeu *jeu, char *gameloop, char estConfig)
                 jeu -> estQuadrille = !(jeu -> estQuadrille);
                 break;
             
-            // On augmente / diminue le délais si la touche i / k est pressée.
+            // On augmente / diminue le délais (ou le temps de calcul par image) si la touche i / k est pressée.
             case SDLK_i:
-                jeu -> delay_ms++;
+                if (jeu -> cadence == CADENCE_IMAGE) jeu -> budget_ms++;
+                else jeu -> delay_ms++;
                 break;
             case SDLK_k:
-                if (jeu -> delay_ms - 1 < jeu -> delay_ms) jeu -> delay_ms--;
+                if (jeu -> cadence == CADENCE_IMAGE && jeu -> budget_ms > 1) jeu -> budget_ms--;
+                else if (jeu -> cadence != CADENCE_IMAGE && jeu -> delay_ms - 1 < jeu -> delay_ms) jeu -> delay_ms--;
+                break;
+            
+            // On passe à la cadence suivante (délai, temps par image, vitesse max) si la touche m est pressée
+            case SDLK_m:
+                jeu -> cadence = (jeu -> cadence + 1) % NB_CADENCES;
                 break;
             
             // On met le jeu en couleur si la touche c est pressée
             case SDLK_c:
                 jeu -> estCouleur = !(jeu -> estCouleur);
+                break;
+            
+            // On passe à la palette de couleurs suivante si la touche v est pressée
+            case SDLK_v:
+                jeu -> palette = (jeu -> palette + 1) % NB_PALETTES;
+                break;
+            
+            // On double / divise par 2 le saut du moteur hashlife si la touche j / n est pressée
+            case SDLK_j:
+                if (jeu -> saut * 2 > jeu -> saut) jeu -> saut *= 2;
+                break;
+            case SDLK_n:
+                if (jeu -> saut > 1) jeu -> saut /= 2;
+                break;
+            
+            // On sauvegarde la partie si la touche s est pressée (voir --sauvegarde)
+            case SDLK_s:
+                if (!estConfig && jeu -> fichier_sauvegarde != NULL) jeu -> demandes_sauvegarde++;
+                break;
+            
+            /* On va directement à une génération si la touche a est pressée et qu'un cycle a été détecté (voir --cycles).
+            La génération est tapée dans la fenêtre (voir saisie_generation()) */
+            case SDLK_a:
+                if (estConfig || jeu -> cycles == NULL) break;
+                if (!(jeu -> statistiques -> periode))
+                {
+                    printf("Aucun cycle n'a encore été détecté\n");
+                    break;
+                }
+                jeu -> saisie_active = 1;
+                jeu -> generation_saisie = 0;
+                printf("Tapez la génération où aller dans la fenêtre, puis Entrée (Échap pour annuler)\n");
+                break;
+            
+            // On affiche / cache les mesures si la touche h est pressée (voir --mesures)
+            case SDLK_h:
+                if (jeu -> mesures != NULL) jeu -> mesures -> hud = !(jeu -> mesures -> hud);
+                break;
             default:
                 break;
             }
@@ -516,10 +653,51 @@ void watch_events(SDL_Event *event, Jeu *jeu, char *gameloop, char estConfig)
 void affiche_aide()
 {
     printf("Utilisation:\n");
-    printf("'./gol -f' -> Charge une configuration de départ depuis un fichier.gol\n");
+    printf("'./gol -f' -> Charge une configuration de départ depuis un fichier (.gol, RLE ou Life 1.06)\n");
     printf("'./gol -t' -> Demande une configuration de départ dans le terminal\n");
     printf("'./gol -r' -> Configuration de départ aléatoire\n");
-    printf("'./gol -g' -> Demande une configuration de départ depuis le GUI\n\n");
+    printf("'./gol -g' -> Demande une configuration de départ depuis le GUI\n");
+    printf("'./gol --headless' -> Calcule les générations sans affichage (ni SDL) et affiche le débit\n");
+    printf("'./gol --recherche' -> Calcule des milliers de soupes aléatoires en parallèle, jusqu'à ce qu'elles deviennent périodiques\n\n");
+    printf("Options:\n");
+    printf("'--moteur bitboard' -> Calcule 64 cellules à la fois, 1 bit par cellule (par défaut)\n");
+    printf("'--moteur scalaire' -> Calcule les cellules une par une\n");
+    printf("'--moteur simd' -> Calcule 16 à 64 cellules à la fois, 1 octet par cellule\n");
+    printf("'--moteur hashlife' -> Avance de nombreuses générations d'un coup sur les motifs réguliers (univers non borné)\n");
+    printf("'--moteur univers' -> Calcule 64 cellules à la fois dans un univers non borné, la mémoire dépend de la surface occupée\n");
+    printf("'--moteur table' -> Calcule 2 x 2 cellules à la fois avec une table précalculée, 1 octet par cellule\n");
+    printf("'--simd avx512|avx2|sse2|scalaire' -> Impose le jeu d'instructions du moteur simd\n");
+    printf("'--threads N' -> Calcule la génération suivante avec N threads (1 par défaut)\n");
+    printf("'--saut N' -> Le moteur hashlife avance de N générations à chaque étape (1 par défaut)\n");
+    printf("'--cadence delai|image|max' -> Délai entre 2 générations (par défaut), autant de générations que possible par image, ou sans limite\n");
+    printf("'--budget-image N' -> Temps de calcul (en ms) accordé à chaque image avec '--cadence image' (10 par défaut)\n");
+    printf("'--palette spectre|chaleur|origine' -> Palette utilisée pour l'affichage en couleur (spectre par défaut)\n");
+    printf("'--hashlife-memoire N' -> Mémoire (en Mo) utilisée par hashlife (noeuds et table) avant de libérer les noeuds inutiles (512 par défaut)\n");
+    printf("'--sauvegarde F' -> Sauvegarde la partie dans le fichier F (touche 's', à la fin, et voir --sauvegarde-tous)\n");
+    printf("'--sauvegarde-tous N' -> Sauvegarde la partie toutes les N générations (avec --sauvegarde)\n");
+    printf("'--reprise F' -> Reprend la partie sauvegardée dans le fichier F (la taille de la grille, la règle et la topologie sont celles de la sauvegarde)\n");
+    printf("'--stats aucunes|totaux|generation' -> Statistiques calculées: aucune (plus rapide), les totaux (par défaut), ou aussi celles de chaque génération (pas avec hashlife)\n");
+    printf("'--stats-fichier F' -> Fichier des statistiques de chaque génération: CSV, ou binaire si F finit par .bin (statistiques.csv par défaut)\n");
+    printf("'--regle Bx/Sy' -> Règle du jeu en notation B/S, par exemple B36/S23 (B3/S23 par défaut)\n");
+    printf("'--topologie bornee|tore|klein' -> Au-delà des bords: des cellules mortes (par défaut), le bord opposé (tore), ou le bord opposé retourné pour le haut et le bas (bouteille de Klein)\n");
+    printf("'--cycles' -> Détecte quand la configuration devient périodique: le mode headless s'arrête, le GUI peut aller directement à n'importe quelle génération\n");
+    printf("'--mesures' -> Mesure la durée de chaque phase (évènements, dessin, présentation, génération, bande de chaque thread): affichée dans la fenêtre (touche 'h') et à la fin\n");
+    printf("'--trace F' -> Écrit aussi chaque intervalle mesuré dans le fichier F, au format 'Chrome trace event' (chrome://tracing ou ui.perfetto.dev)\n");
+    printf("'--taille N' -> Taille de la grille du GUI (celle de la fenêtre par défaut): plus grande, on peut dézoomer jusqu'à plusieurs cellules par pixel\n");
+    printf("'--graine S' -> Graine de la configuration aléatoire (l'heure par défaut), affichée pour pouvoir la reproduire\n");
+    printf("'--densite P' -> Pourcentage de cellules vivantes dans la configuration aléatoire (50 par défaut)\n");
+    printf("'--symetrie aucune|miroir|rotation|quadruple' -> Symétrie de la configuration aléatoire: aucune (par défaut), gauche-droite, demi-tour, ou gauche-droite et haut-bas\n\n");
+    printf("Options du mode headless:\n");
+    printf("'--taille N' -> Taille de la grille (800 par défaut)\n");
+    printf("'--generations N' -> Nombre de générations à calculer (1000 par défaut)\n");
+    printf("'--fichier F' -> Charge la configuration depuis le fichier F: .gol, RLE ou Life 1.06 (aléatoire sinon)\n");
+    printf("'--x X' / '--y Y' -> Coordonnées du coin supérieur gauche du fichier dans la grille (0 par défaut)\n\n");
+    printf("Options de la recherche de soupes (et --moteur, --threads, --regle, --topologie, --graine, --densite, --symetrie):\n");
+    printf("'--soupes N' -> Nombre de soupes à calculer (1000 par défaut), la soupe i a la graine S + i\n");
+    printf("'--taille N' -> Taille de la grille de chaque soupe (128 par défaut)\n");
+    printf("'--generations N' -> Nombre de générations après lequel on abandonne une soupe (20000 par défaut)\n");
+    printf("'--resultats F' -> Fichier CSV où ajouter le résultat de chaque soupe (soupes.csv par défaut)\n");
+    printf("Les soupes sont calculées sur tous les coeurs par défaut\n\n");
     quitter("Commande incorrecte\n", 1);
 }
 
@@ -527,16 +705,20 @@ void affiche_aide()
 
 /**
  * @brief Recalcule le point d'origine en fonction du centre et
- * évite de sortir de la grille.
+ * évite de sortir de la grille (si la caméra est bornée).
  * 
  */
 void update_camera(Camera *cam)
 {
     // On vérifie qu'on ne sort pas de la grille
-    if (cam -> origin_x + cam -> width >= cam -> max_width) cam -> origin_x = cam -> max_width - cam -> width;
-    if (cam -> origin_y + cam -> width >= cam -> max_width) cam -> origin_y = cam -> max_width - cam -> width;
-    if (cam -> origin_x > cam -> max_width) cam -> origin_x = 0;
-    if (cam -> origin_y > cam -> max_width) cam -> origin_y = 0;
+    if (cam -> est_bornee)
+    {
+        int64_t origine_max = (int64_t) cam -> max_width - cam -> width;
+        if (cam -> origin_x > origine_max) cam -> origin_x = origine_max;
+        if (cam -> origin_y > origine_max) cam -> origin_y = origine_max;
+        if (cam -> origin_x < 0) cam -> origin_x = 0;
+        if (cam -> origin_y < 0) cam -> origin_y = 0;
+    }
 
     // On met à jour le centre de la caméra à partir de l'origine
     cam -> centre_x = cam -> origin_x + (cam -> width / 2);
@@ -545,6 +727,40 @@ void update_camera(Camera *cam)
 
 
 
+/**
+ * @brief Règle le zoom pour que la caméra voie (au moins) largeur cellules
+ * sur une ligne, sans dépasser la grille. Si la fenêtre n'a pas assez de
+ * pixels, un pixel représente 2^k x 2^k cellules, avec le plus petit k
+ * possible (voir dessine_pyramide()).
+ * N'appelle pas update_camera().
+ * 
+ * @param jeu Un pointeur sur le Jeu
+ * @param largeur La largeur voulue (en cellules)
+ */
+void regle_zoom(Jeu *jeu, unsigned int largeur)
+{
+    // + lisible
+    Camera *cam = jeu -> cam;
+
+    if (largeur == 0) largeur = 1;
+    if (largeur > cam -> max_width) largeur = cam -> max_width;
+
+    jeu -> niveau_detail = 0;
+    if (largeur <= cam -> pixels)
+    {
+        jeu -> largeur_cell = cam -> pixels / largeur;
+        cam -> width = min_uint(cam -> pixels / jeu -> largeur_cell, cam -> max_width);
+        return;
+    }
+
+    jeu -> largeur_cell = 1;
+    while (((uint64_t) cam -> pixels << jeu -> niveau_detail) < largeur) jeu -> niveau_detail++;
+    uint64_t largeur_niveau = (uint64_t) cam -> pixels << jeu -> niveau_detail;
+    cam -> width = (largeur_niveau < cam -> max_width) ? (unsigned int) largeur_niveau : cam -> max_width;
+}
+
+
+
 /**
  * @brief Affiche les commandes disponibles en fonction du contexte:
  * - commandes de caméra
@@ -557,9 +773,9 @@ void affiche_commandes(Jeu *jeu, char estConfig)
 {
     // Commandes générales
     system(CLEAR);
-    printf("Utilisez la molette pour zoomer / dézoomer\n");
-    printf("Utilisez les touches directionnelles pour déplacer la caméra dans la grille\n");
-    printf("Appuyez sur 'c' pour afficher le jeu en couleur\n");
+    printf("Utilisez la molette pour zoomer / dézoomer (jusqu'à plusieurs cellules par pixel si la grille est plus grande que la fenêtre)\n");
+    printf("Utilisez les touches directionnelles pour déplacer la caméra dans la grille (ou dans l'univers)\n");
+    printf("Appuyez sur 'c' pour afficher le jeu en couleur, 'v' pour changer de palette\n");
     printf("Appuyez sur 'g' pour afficher la grille ");
     print_redb("attention si dezoom au maximum avec la grille activée, tout devient blanc !\n\n");
 
@@ -579,68 +795,11 @@ void affiche_commandes(Jeu *jeu, char estConfig)
 
     // Commandes spécifiques au jeu
     printf("Appuyez sur 'p' pour mettre le jeu en pause\n");
-    printf("Appuyez sur 'i' pour augmenter le délai entre 2 mises à jours de la grille\n");
-    printf("Appuyez sur 'k' pour diminuer le délai entre 2 mises à jour de la grille\n");
+    printf("Appuyez sur 'i' pour augmenter le délai entre 2 mises à jours de la grille (ou le temps de calcul par image)\n");
+    printf("Appuyez sur 'k' pour diminuer le délai entre 2 mises à jour de la grille (ou le temps de calcul par image)\n");
+    printf("Appuyez sur 'm' pour changer de cadence: délai entre 2 générations, temps de calcul par image, ou vitesse max\n");
+    if (jeu -> moteur == MOTEUR_HASHLIFE) printf("Appuyez sur 'j' / 'n' pour doubler / diviser par 2 le nombre de générations calculées d'un coup\n");
+    if (jeu -> fichier_sauvegarde != NULL) printf("Appuyez sur 's' pour sauvegarder la partie dans %s\n", jeu -> fichier_sauvegarde);
+    if (jeu -> cycles != NULL) printf("Appuyez sur 'a' pour aller directement à une génération (une fois un cycle détecté), tapez-la puis Entrée\n");
+    if (jeu -> mesures != NULL) printf("Appuyez sur 'h' pour afficher / cacher les mesures\n");
 }
-
-
-
-/**
- * @brief À partir de l'âge d'une cellule au format:
- * O A A A A A A A, avec A les 7 bits d'âge de la cellule,
- * permet de déterminer la couleur de cette cellule.
- * 
- * @param cell La cellule concernée
- * @param r Un pointeur sur la variable stockant le rouge
- * @param g Un pointeur sur la variable stockant le vert
- * @param b Un pointeur sur la variable stockant le bleu
- */
-void get_color(cellule cell, unsigned char *r, unsigned char *g, unsigned char *b)
-{
-    /* On utilise le spectre du visible pour déterminer la couleur en fonction de l'âge:
-    Une cellule d'âge 0 aura une longueur d'onde de 420nm, une cellule d'âge 1 aura une 
-    longueur d'onde de 422, ..., une cellule d'âge maximal aura une longueur d'onde de 676nm.
-    
-    Attention: j'ai récupéré la fonction permettant de déterminer une couleur rgb256 à partir d'une
-    longueur d'onde sur internet (voir dans README où j'explique + en détail). */
-    double rd, gd, bd;
-    double long_onde = (cell & 127) * 2 + 420;
-    spectral_color(&rd, &gd, &bd, long_onde);   // fonction récupérée sur StackOverflow
-
-    // On convertit en rgb256
-    *r = 256 * rd;
-    *g = 256 * gd;
-    *b = 256 * bd;
-}
-
-
-
-
-// RGB <0,1> <- lambda l <400,700> [nm]
-/**
- * @brief Permet de déterminer une couleur en rgb à partir
- * d'une longueur d'onde en nm.
- * 
- * Fonction récupérée ici:
- * https://stackoverflow.com/questions/3407942/rgb-values-of-visible-spectrum/22681410#22681410
- * 
- * @param r Un pointeur sur la variable stockant le rouge
- * @param g Un pointeur sur la variable stockant le vert
- * @param b Un pointeur sur la variable stockant le bleu
- * @param l La longueur d'onde en nm
- */
-void spectral_color(double *r,double *g,double *b,double l) 
-{
-double t;  
-*r=0.0; *g=0.0; *b=0.0;
-        if ((l>=400.0)&&(l<410.0)) {t=(l-400.0)/(410.0-400.0); *r=    +(0.33*t)-(0.20*t*t); }
-else if ((l>=410.0)&&(l<475.0)) { t=(l-410.0)/(475.0-410.0); *r=0.14         -(0.13*t*t); }
-else if ((l>=545.0)&&(l<595.0)) { t=(l-545.0)/(595.0-545.0); *r=    +(1.98*t)-(     t*t); }
-else if ((l>=595.0)&&(l<650.0)) { t=(l-595.0)/(650.0-595.0); *r=0.98+(0.06*t)-(0.40*t*t); }
-else if ((l>=650.0)&&(l<700.0)) { t=(l-650.0)/(700.0-650.0); *r=0.65-(0.84*t)+(0.20*t*t); }
-        if ((l>=415.0)&&(l<475.0)) { t=(l-415.0)/(475.0-415.0); *g=             +(0.80*t*t); }
-else if ((l>=475.0)&&(l<590.0)) { t=(l-475.0)/(590.0-475.0); *g=0.8 +(0.76*t)-(0.80*t*t); }
-else if ((l>=585.0)&&(l<639.0)) { t=(l-585.0)/(639.0-585.0); *g=0.84-(0.84*t)           ; }
-        if ((l>=400.0)&&(l<475.0)) { t=(l-400.0)/(475.0-400.0); *b=    +(2.20*t)-(1.50*t*t); }
-else if ((l>=475.0)&&(l<560.0)) { t=(l-475.0)/(560.0-475.0); *b=0.7 -(     t)+(0.30*t*t); }
-}
\ No newline at end of file
@@ -0,0 +1,377 @@
+/**
+ * @file bitboard.c
+ * @author M3tex
+ * @brief Fichier contenant le moteur 'bitboard': la grille est stockée avec
+ * 1 bit par cellule et la génération suivante est calculée 64 cellules à la
+ * fois avec des additionneurs bit à bit.
+ * @version 0.1
+ * @date 2022-12-10
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "bitboard.h"
+#include "regle.h"
+#include "types.h"
+
+
+
+
+/**
+ * @brief Additionneur complet sur 64 bits en parallèle:
+ * pour chaque position de bit, somme = a + b + c (sur 2 bits).
+ * 
+ * @param a
+ * @param b
+ * @param c
+ * @param somme Le bit de poids faible de la somme
+ * @param retenue Le bit de poids fort de la somme
+ */
+static inline void additionneur(uint64_t a, uint64_t b, uint64_t c, uint64_t *somme, uint64_t *retenue)
+{
+    uint64_t tmp = a ^ b;
+    *somme = tmp ^ c;
+    *retenue = (a & b) | (tmp & c);
+}
+
+
+
+/**
+ * @brief Calcule l'état suivant des 64 cellules d'un mot à partir du mot
+ * et de ses 8 voisins (le mot est au milieu de la ligne m, h est la ligne du
+ * dessus et b la ligne du dessous).
+ * 
+ * Le bit j d'un mot correspond à la cellule 64 * w + j: le voisin de gauche
+ * d'une cellule est donc obtenu avec un décalage à gauche, en récupérant le
+ * bit de poids fort du mot précédent.
+ * 
+ * Avec une règle spécialisée, regle_b et regle_s sont des constantes (voir
+ * AVEC_REGLE) et le compilateur ne garde que le calcul de cette règle.
+ * 
+ * @param h Un pointeur sur le mot de la ligne du dessus
+ * @param m Un pointeur sur le mot concerné
+ * @param b Un pointeur sur le mot de la ligne du dessous
+ * @param regle_b Le masque des naissances de la règle
+ * @param regle_s Le masque des survies de la règle
+ * @return uint64_t Les 64 cellules à la génération suivante
+ */
+static inline __attribute__((always_inline)) uint64_t mot_suivant(const uint64_t *h, const uint64_t *m, const uint64_t *b,
+                                                                 const uint16_t regle_b, const uint16_t regle_s)
+{
+    // Les 8 voisins de chaque cellule, 64 cellules à la fois
+    uint64_t hg = (h[0] << 1) | (h[-1] >> 63), hd = (h[0] >> 1) | (h[1] << 63);
+    uint64_t mg = (m[0] << 1) | (m[-1] >> 63), md = (m[0] >> 1) | (m[1] << 63);
+    uint64_t bg = (b[0] << 1) | (b[-1] >> 63), bd = (b[0] >> 1) | (b[1] << 63);
+
+    /* On compte les voisins ligne par ligne (2 bits par ligne), puis on additionne
+    les 3 lignes. On a au plus 8 voisins: 4 bits (s3 s2 s1 s0) */
+    uint64_t h0, h1, b0, b1;
+    additionneur(hg, h[0], hd, &h0, &h1);
+    additionneur(bg, b[0], bd, &b0, &b1);
+    uint64_t m0 = mg ^ md, m1 = mg & md;
+
+    // Bits de poids 1
+    uint64_t s0, r0;
+    additionneur(h0, b0, m0, &s0, &r0);
+
+    // Bits de poids 2 (r0 est aussi de poids 2)
+    uint64_t t, r1;
+    additionneur(h1, b1, m1, &t, &r1);
+    uint64_t s1 = t ^ r0;
+    uint64_t s2 = r1 ^ (t & r0);
+    uint64_t s3 = r1 & t & r0;
+
+    /* Jeu de la vie: vivante si 3 voisins, ou si 2 voisins et déjà vivante. Pour 2 ou 3
+    voisins, s3 vaut 0 dès que s1 vaut 1 et s2 0: pas besoin de le calculer */
+    if (regle_b == NAISSANCE_VIE && regle_s == SURVIE_VIE) return s1 & ~s2 & (s0 | m[0]);
+
+    // Les autres règles: on teste chaque nombre de voisins présent dans B ou S
+    uint64_t naissance = 0, survie = 0;
+    #pragma GCC unroll 9
+    for (unsigned int n = 0; n <= 8; n++)
+    {
+        if (!dans_masque(regle_b | regle_s, n)) continue;
+        uint64_t egal = ((n & 1) ? s0 : ~s0) & ((n & 2) ? s1 : ~s1) & ((n & 4) ? s2 : ~s2) & ((n & 8) ? s3 : ~s3);
+        if (dans_masque(regle_b, n)) naissance |= egal;
+        if (dans_masque(regle_s, n)) survie |= egal;
+    }
+    return (naissance & ~m[0]) | (survie & m[0]);
+}
+
+
+
+/**
+ * @brief Le calcul de maj_bitgrille(). compte est une constante: le
+ * compilateur en fait une version avec et une version sans statistiques (et
+ * une par règle spécialisée).
+ */
+static inline __attribute__((always_inline)) char calcule_bitgrille(BitGrille *bitgrille, const Zone *zone,
+                                                                    Stats *partielles, const char compte,
+                                                                    const uint16_t regle_b, const uint16_t regle_s)
+{
+    // + lisible
+    unsigned int nb_mots = bitgrille -> nb_mots;
+    unsigned int pas = bitgrille -> pas;
+    PlansBits *cour = &(bitgrille -> courant);
+    PlansBits *suiv = &(bitgrille -> suivant);
+
+    unsigned int debut_w = zone -> x / 64;
+    unsigned int fin_w = (zone -> x + zone -> largeur + 63) / 64;
+
+    uint64_t differences = 0;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0;
+    for (unsigned int y = zone -> y; y < zone -> y + zone -> hauteur; y++)
+    {
+        size_t ligne = (size_t) y * pas;
+        const uint64_t *m = cour -> vivantes + ligne;
+        for (unsigned int w = debut_w; w < fin_w; w++)
+        {
+            /* Les bits après la fin de la grille restent à 0 (sauf la colonne fantôme d'une grille
+            refermée, voir maj_bordure_bitgrille()) */
+            uint64_t ancien = m[w];
+            uint64_t nouveau = mot_suivant(m + w - pas, m + w, m + w + pas, regle_b, regle_s);
+            if (w == nb_mots - 1)
+            {
+                ancien &= bitgrille -> masque_fin;
+                nouveau &= bitgrille -> masque_fin;
+            }
+
+            uint64_t survie = ancien & nouveau;
+            uint64_t naissance = nouveau & ~ancien;
+            uint64_t origine = cour -> originelles[ligne + w];
+
+            suiv -> vivantes[ligne + w] = nouveau;
+            suiv -> originelles[ligne + w] = origine & survie;
+
+            // Le bit d'origine ne change que si la cellule meurt
+            differences |= ancien ^ nouveau;
+
+            // On met à jour les stats
+            if (compte)
+            {
+                en_vie += __builtin_popcountll(ancien);
+                originelles += __builtin_popcountll(origine);
+                nes += __builtin_popcountll(naissance);
+                mortes += __builtin_popcountll(ancien & ~nouveau);
+            }
+
+            if (!(bitgrille -> suivi_age)) continue;
+
+            /* On augmente l'âge des cellules survivantes (incrément en parallèle sur
+            les 7 plans), sauf si elles ont déjà l'âge maximal (127 = tous les bits à 1).
+            Les cellules qui naissent ont un âge de 1. */
+            uint64_t sature = ~(uint64_t) 0;
+            for (unsigned int k = 0; k < NB_BITS_AGE; k++) sature &= cour -> age[k][ligne + w];
+
+            uint64_t retenue = ~sature;
+            for (unsigned int k = 0; k < NB_BITS_AGE; k++)
+            {
+                uint64_t a = cour -> age[k][ligne + w];
+                uint64_t nouvel_age = ((a ^ retenue) & survie) | (k == 0 ? naissance : 0);
+                suiv -> age[k][ligne + w] = nouvel_age;
+                differences |= a ^ nouvel_age;
+                retenue &= a;
+            }
+        }
+    }
+
+    if (compte)
+    {
+        partielles -> en_vie += en_vie;
+        partielles -> nb_cell_originelles += originelles;
+        partielles -> nb_cell_nes += nes;
+        partielles -> nb_cell_mortes += mortes;
+    }
+    return differences != 0;
+}
+
+
+
+/**
+ * @brief Utilise les règles du jeu pour calculer l'itération suivante d'une
+ * zone de la bitgrille, dans les plans 'suivant'.
+ * Les colonnes de la zone doivent correspondre à des mots entiers (x multiple
+ * de 64, et largeur multiple de 64 sauf pour le dernier mot de la ligne).
+ * Peut être appelée en parallèle sur des zones disjointes.
+ * 
+ * @param bitgrille Un pointeur sur la bitgrille à mettre à jour
+ * @param zone La zone à calculer
+ * @param partielles Un pointeur sur les statistiques de la zone (additionnées),
+ * NULL pour ne pas les calculer
+ * @param regle Un pointeur sur la règle du jeu
+ * @return char 1 si au moins une cellule de la zone a changé (âge compris), 0 sinon
+ */
+char maj_bitgrille(BitGrille *bitgrille, const Zone *zone, Stats *partielles, const Regle *regle)
+{
+    if (partielles == NULL)
+    {
+        AVEC_REGLE(regle, return calcule_bitgrille(bitgrille, zone, NULL, 0, naissance, survie));
+    }
+    AVEC_REGLE(regle, return calcule_bitgrille(bitgrille, zone, partielles, 1, naissance, survie));
+    return 0;
+}
+
+
+
+/**
+ * @brief Calcule la génération suivante d'un bloc de TAILLE_BLOC x TAILLE_BLOC
+ * cellules (1 mot par ligne), utilisé par l'univers non borné (voir univers.c).
+ * 
+ * La fenêtre contient le bloc et son voisinage: la ligne 0 et la ligne
+ * TAILLE_BLOC + 1 sont les lignes des blocs du dessus et du dessous, les mots 0
+ * et 2 de chaque ligne sont ceux des blocs de gauche et de droite.
+ * 
+ * @param fenetre Le bloc (mot 1 des lignes 1 à TAILLE_BLOC) et ses voisins
+ * @param bloc Le tableau où écrire les TAILLE_BLOC lignes du bloc à la génération suivante
+ * @param regle Un pointeur sur la règle du jeu
+ */
+void bloc_suivant(const uint64_t fenetre[TAILLE_BLOC + 2][3], uint64_t *bloc, const Regle *regle)
+{
+    AVEC_REGLE(regle,
+        for (unsigned int r = 0; r < TAILLE_BLOC; r++)
+        {
+            bloc[r] = mot_suivant(&fenetre[r][1], &fenetre[r + 1][1], &fenetre[r + 2][1], naissance, survie);
+        }
+    );
+}
+
+
+
+/**
+ * @brief Une fois toutes les lignes calculées par maj_bitgrille(), la
+ * génération suivante devient la génération courante.
+ * 
+ * @param bitgrille Un pointeur sur la bitgrille concernée
+ */
+void echange_bitgrille(BitGrille *bitgrille)
+{
+    PlansBits tmp = bitgrille -> courant;
+    bitgrille -> courant = bitgrille -> suivant;
+    bitgrille -> suivant = tmp;
+}
+
+
+
+/**
+ * @brief Active ou désactive le suivi de l'âge des cellules (nécessaire pour
+ * l'affichage en couleur). Quand le suivi est activé, toutes les cellules
+ * vivantes commencent avec un âge de 1.
+ * 
+ * @param bitgrille Un pointeur sur la bitgrille concernée
+ * @param actif 1 pour activer le suivi, 0 pour le désactiver
+ * @return char 1 si le suivi a changé, 0 s'il était déjà dans l'état demandé
+ */
+char suivi_age_bitgrille(BitGrille *bitgrille, char actif)
+{
+    // + lisible
+    unsigned int taille = bitgrille -> taille;
+    unsigned int pas = bitgrille -> pas;
+
+    if (actif == bitgrille -> suivi_age) return 0;
+    bitgrille -> suivi_age = actif;
+
+    for (unsigned int k = 0; k < NB_BITS_AGE; k++)
+    {
+        if (actif)
+        {
+            bitgrille -> courant.age[k] = init_plan(taille, pas);
+            bitgrille -> suivant.age[k] = init_plan(taille, pas);
+        }
+        else
+        {
+            free_plan(bitgrille -> courant.age[k], pas);
+            free_plan(bitgrille -> suivant.age[k], pas);
+            bitgrille -> courant.age[k] = NULL;
+            bitgrille -> suivant.age[k] = NULL;
+        }
+    }
+
+    // Âge de 1 pour toutes les cellules vivantes
+    if (actif) memcpy(bitgrille -> courant.age[0] - pas - 1, bitgrille -> courant.vivantes - pas - 1,
+                      sizeof(uint64_t) * (taille + 2) * pas);
+    return 1;
+}
+
+
+
+/**
+ * @brief Charge le contenu d'une Grille dans une BitGrille de même taille.
+ * L'âge des cellules n'est chargé que si son suivi est activé.
+ * 
+ * @param grille Un pointeur sur la grille à convertir
+ * @param bitgrille Un pointeur sur la bitgrille où écrire le résultat
+ */
+void grille2bitgrille(Grille *grille, BitGrille *bitgrille)
+{
+    // + lisible
+    unsigned int taille = grille -> taille;
+    unsigned int pas = bitgrille -> pas;
+    PlansBits *cour = &(bitgrille -> courant);
+
+    for (unsigned int y = 0; y < taille; y++)
+    {
+        size_t ligne = (size_t) y * pas;
+        const cellule *cellules = &CELLULE(grille, y, 0);
+        for (unsigned int w = 0; w < bitgrille -> nb_mots; w++)
+        {
+            uint64_t vivantes = 0, originelles = 0;
+            uint64_t age[NB_BITS_AGE] = {0};
+            for (unsigned int j = 0; j < 64 && 64 * w + j < taille; j++)
+            {
+                cellule cell = cellules[64 * w + j];
+                if (!cell) continue;
+
+                vivantes |= (uint64_t) 1 << j;
+                originelles |= (uint64_t) (cell >> 7) << j;
+                for (unsigned int k = 0; k < NB_BITS_AGE; k++) age[k] |= (uint64_t) ((cell >> k) & 1) << j;
+            }
+            cour -> vivantes[ligne + w] = vivantes;
+            cour -> originelles[ligne + w] = originelles;
+            if (bitgrille -> suivi_age)
+            {
+                for (unsigned int k = 0; k < NB_BITS_AGE; k++) cour -> age[k][ligne + w] = age[k];
+            }
+        }
+    }
+}
+
+
+
+/**
+ * @brief Écrit le contenu d'une BitGrille dans une Grille de même taille (pour
+ * l'affichage). Si l'âge n'est pas suivi, les cellules vivantes ont un âge de 1.
+ * 
+ * @param bitgrille Un pointeur sur la bitgrille à convertir
+ * @param grille Un pointeur sur la grille où écrire le résultat
+ */
+void bitgrille2grille(BitGrille *bitgrille, Grille *grille)
+{
+    // + lisible
+    unsigned int taille = grille -> taille;
+    unsigned int pas = bitgrille -> pas;
+    PlansBits *cour = &(bitgrille -> courant);
+
+    for (unsigned int y = 0; y < taille; y++)
+    {
+        size_t ligne = (size_t) y * pas;
+        cellule *cellules = &CELLULE(grille, y, 0);
+        for (unsigned int w = 0; w < bitgrille -> nb_mots; w++)
+        {
+            uint64_t vivantes = cour -> vivantes[ligne + w];
+            uint64_t originelles = cour -> originelles[ligne + w];
+            for (unsigned int j = 0; j < 64 && 64 * w + j < taille; j++)
+            {
+                cellule cell = 0;
+                if ((vivantes >> j) & 1)
+                {
+                    cell = (cellule) (((originelles >> j) & 1) << 7);
+                    if (!(bitgrille -> suivi_age)) cell |= 1;
+                    else for (unsigned int k = 0; k < NB_BITS_AGE; k++) cell |= ((cour -> age[k][ligne + w] >> j) & 1) << k;
+                }
+                cellules[64 * w + j] = cell;
+            }
+        }
+    }
+}
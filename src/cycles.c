@@ -0,0 +1,250 @@
+/**
+ * @file cycles.c
+ * @author M3tex
+ * @brief Fichier contenant la détection de cycles: une configuration
+ * aléatoire finit presque toujours en structures stables et en oscillateurs,
+ * qui repassent sans cesse par les mêmes états.
+ *
+ * Chaque génération a une empreinte (hash sur 64 bits de ses cellules
+ * vivantes): le XOR des contributions de chaque mot de 64 cellules (voir
+ * empreinte_mot()). Quand un mot change, il suffit donc de retirer son
+ * ancienne contribution et d'ajouter la nouvelle: on ne regarde que les
+ * tuiles qui viennent de changer (ou, pour l'univers non borné, les lignes
+ * des blocs qui changent pendant le calcul).
+ *
+ * Les empreintes récentes sont gardées dans un historique: si une empreinte
+ * revient, la configuration est périodique (les collisions sur 64 bits sont
+ * négligeables). On peut alors aller directement à n'importe quelle génération
+ * (voir saute_generations()).
+ *
+ * L'âge des cellules n'est pas pris en compte: il ne change pas l'évolution.
+ * Le moteur hashlife n'est pas géré (il avance déjà très vite sur les motifs
+ * périodiques).
+ * @version 0.1
+ * @date 2022-12-29
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "cycles.h"
+#include "logique.h"
+#include "utilitaires.h"
+
+
+
+/**
+ * @brief Calcule l'empreinte de toute la génération actuelle.
+ */
+static uint64_t empreinte_complete(Jeu *jeu)
+{
+    uint64_t empreinte = 0;
+    if (jeu -> moteur == MOTEUR_UNIVERS)
+    {
+        // + lisible
+        Univers *univers = jeu -> univers;
+
+        for (size_t b = 0; b < univers -> nb_blocs; b++)
+        {
+            Bloc *bloc = univers -> blocs[b];
+            for (unsigned int r = 0; r < TAILLE_BLOC; r++)
+            {
+                empreinte ^= empreinte_mot(bloc -> vivantes[univers -> courant][r], cle_bloc(bloc, r));
+            }
+        }
+        return empreinte;
+    }
+
+    // Les moteurs bornés: 1 mot par ligne de chaque tuile, à partir de la grille
+    synchronise_grille(jeu);
+    Grille *grille = jeu -> grille;
+    unsigned int nb = jeu -> tuiles -> nb;
+    for (unsigned int y = 0; y < grille -> taille; y++)
+    {
+        for (unsigned int tx = 0; tx < nb; tx++)
+        {
+            unsigned int x = tx * TAILLE_TUILE;
+            uint64_t mot = masque_vivantes(&CELLULE(grille, y, x), min_uint(TAILLE_TUILE, grille -> taille - x));
+            empreinte ^= empreinte_mot(mot, (uint64_t) y * nb + tx);
+        }
+    }
+    return empreinte;
+}
+
+
+
+/**
+ * @brief Met à jour l'empreinte des moteurs bornés à partir des tuiles qui
+ * viennent de changer: la génération précédente est encore dans jeu -> tampon
+ * (ou dans les plans 'suivant' de la BitGrille).
+ */
+static void maj_empreinte_tuiles(Jeu *jeu)
+{
+    // + lisible
+    Tuiles *tuiles = jeu -> tuiles;
+    unsigned int nb = tuiles -> nb;
+    unsigned int taille = jeu -> grille -> taille;
+    BitGrille *bitgrille = jeu -> bitgrille;
+
+    uint64_t empreinte = jeu -> cycles -> empreinte;
+    for (unsigned int ty = 0; ty < nb; ty++)
+    {
+        for (unsigned int tx = 0; tx < nb; tx++)
+        {
+            if (!tuiles -> active[(size_t) ty * nb + tx]) continue;
+
+            unsigned int x = tx * TAILLE_TUILE;
+            unsigned int largeur = min_uint(TAILLE_TUILE, taille - x);
+            unsigned int fin_y = min_uint((ty + 1) * TAILLE_TUILE, taille);
+            for (unsigned int y = ty * TAILLE_TUILE; y < fin_y; y++)
+            {
+                uint64_t ancien, nouveau;
+                if (jeu -> moteur == MOTEUR_BITBOARD)
+                {
+                    ancien = bitgrille -> suivant.vivantes[(size_t) y * bitgrille -> pas + tx];
+                    nouveau = bitgrille -> courant.vivantes[(size_t) y * bitgrille -> pas + tx];
+                }
+                else
+                {
+                    ancien = masque_vivantes(&CELLULE(jeu -> tampon, y, x), largeur);
+                    nouveau = masque_vivantes(&CELLULE(jeu -> grille, y, x), largeur);
+                }
+                if (ancien == nouveau) continue;
+
+                uint64_t cle = (uint64_t) y * nb + tx;
+                empreinte ^= empreinte_mot(ancien, cle) ^ empreinte_mot(nouveau, cle);
+            }
+        }
+    }
+    jeu -> cycles -> empreinte = empreinte;
+}
+
+
+
+/**
+ * @brief Cherche l'empreinte actuelle dans l'historique: si elle y est, la
+ * période et le début du cycle sont écrits dans les statistiques du jeu, sinon
+ * elle est ajoutée à l'historique.
+ */
+static void cherche_cycle(Jeu *jeu)
+{
+    // + lisible
+    Cycles *cycles = jeu -> cycles;
+    Stats *statistiques = jeu -> statistiques;
+
+    if (statistiques -> periode) return;
+
+    EntreeCycle *entree = &(cycles -> historique[cycles -> empreinte & (TAILLE_HISTORIQUE - 1)]);
+    if (entree -> occupee && entree -> empreinte == cycles -> empreinte && entree -> generation < statistiques -> generations)
+    {
+        statistiques -> periode = statistiques -> generations - entree -> generation;
+        statistiques -> debut_cycle = entree -> generation;
+        cycles -> nes_periode = statistiques -> nb_cell_nes - entree -> nes;
+        cycles -> mortes_periode = statistiques -> nb_cell_mortes - entree -> mortes;
+        return;
+    }
+
+    entree -> empreinte = cycles -> empreinte;
+    entree -> generation = statistiques -> generations;
+    entree -> nes = statistiques -> nb_cell_nes;
+    entree -> mortes = statistiques -> nb_cell_mortes;
+    entree -> occupee = 1;
+}
+
+
+
+/**
+ * @brief Prépare la détection de cycles, à partir de la génération actuelle
+ * (le moteur doit déjà être initialisé).
+ *
+ * @param jeu Un pointeur sur le Jeu
+ * @return Cycles* Un pointeur sur les Cycles, NULL si le moteur ne les gère pas
+ */
+Cycles *init_cycles(Jeu *jeu)
+{
+    if (jeu -> moteur == MOTEUR_HASHLIFE)
+    {
+        print_redb("La détection de cycles n'est pas disponible avec le moteur hashlife\n");
+        return NULL;
+    }
+
+    Cycles *cycles = (Cycles *) malloc(sizeof(Cycles));
+    EntreeCycle *historique = (EntreeCycle *) calloc(TAILLE_HISTORIQUE, sizeof(EntreeCycle));
+    if (cycles == NULL || historique == NULL) quitter("Impossible d'allouer de la mémoire pour la détection de cycles\n", 2);
+
+    cycles -> historique = historique;
+    cycles -> nes_periode = 0;
+    cycles -> mortes_periode = 0;
+    jeu -> statistiques -> periode = 0;
+    jeu -> statistiques -> debut_cycle = 0;
+
+    // La génération actuelle est la première de l'historique
+    jeu -> cycles = cycles;
+    cycles -> empreinte = empreinte_complete(jeu);
+    cherche_cycle(jeu);
+    return cycles;
+}
+
+
+
+/**
+ * @brief Après le calcul d'une génération: met à jour l'empreinte, puis
+ * regarde si elle a déjà été vue (voir cherche_cycle()).
+ *
+ * @param jeu Un pointeur sur le Jeu
+ */
+void maj_cycles(Jeu *jeu)
+{
+    // L'univers non borné met son empreinte à jour pendant le calcul (voir maj_univers())
+    if (jeu -> moteur != MOTEUR_UNIVERS) maj_empreinte_tuiles(jeu);
+    cherche_cycle(jeu);
+}
+
+
+
+/**
+ * @brief Une fois un cycle détecté, va directement à la génération cible: on
+ * calcule au plus periode - 1 générations pour arriver dans la même phase du
+ * cycle que la cible, puis on change le numéro de génération. Les naissances
+ * et les morts sont extrapolées à partir de celles d'une période.
+ *
+ * @param jeu Un pointeur sur le Jeu (celui qui possède le moteur)
+ * @param cible La génération où aller (éventuellement avant la génération actuelle)
+ * @return char 1 si on est allé à la génération cible, 0 si aucun cycle n'est
+ * connu ou si la cible est avant le début du cycle
+ */
+char saute_generations(Jeu *jeu, unsigned long int cible)
+{
+    // + lisible
+    Stats *statistiques = jeu -> statistiques;
+    unsigned long int periode = statistiques -> periode;
+    unsigned long int debut = statistiques -> debut_cycle;
+
+    if (jeu -> cycles == NULL || periode == 0 || cible < debut) return 0;
+
+    // Le nombre de générations à calculer pour être dans la même phase que la cible
+    unsigned long int phase = (statistiques -> generations - debut) % periode;
+    unsigned long int restantes = ((cible - debut) % periode + periode - phase) % periode;
+    for (; restantes > 0; restantes--) maj_grille(jeu);
+
+    // Il reste un nombre entier de périodes (éventuellement négatif) jusqu'à la cible
+    long int nb_periodes = ((long int) cible - (long int) statistiques -> generations) / (long int) periode;
+    statistiques -> nb_cell_nes += (unsigned long int) (nb_periodes * (long int) jeu -> cycles -> nes_periode);
+    statistiques -> nb_cell_mortes += (unsigned long int) (nb_periodes * (long int) jeu -> cycles -> mortes_periode);
+    statistiques -> generations = cible;
+    return 1;
+}
+
+
+
+/**
+ * @brief Libère la mémoire allouée dans init_cycles()
+ *
+ * @param cycles Un pointeur sur les Cycles à libérer
+ */
+void free_cycles(Cycles *cycles)
+{
+    free(cycles -> historique);
+    free(cycles);
+}
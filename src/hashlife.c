@@ -0,0 +1,810 @@
+/**
+ * @file hashlife.c
+ * @author M3tex
+ * @brief Fichier contenant le moteur 'hashlife' (algorithme de Bill Gosper).
+ * 
+ * L'univers est représenté par un arbre quaternaire: un noeud de niveau L
+ * représente un carré de 2^L x 2^L cellules, découpé en 4 noeuds de niveau L - 1.
+ * Les noeuds identiques ne sont stockés qu'une seule fois (table de hachage), et
+ * pour chaque noeud on mémorise son 'résultat': le carré central de 2^(L-1) cellules
+ * de côté, 2^(L-2) générations plus tard. Sur les motifs réguliers (canons,
+ * vaisseaux, ...) on peut ainsi avancer de millions de générations d'un coup.
+ * 
+ * Contrairement aux autres moteurs, l'univers n'est pas limité à la grille:
+ * la grille n'est qu'une fenêtre sur l'univers.
+ * @version 0.1
+ * @date 2022-12-18
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "hashlife.h"
+#include "regle.h"
+#include "utilitaires.h"
+
+
+
+// Indices particuliers: pas de noeud, et les 2 feuilles (niveau 0)
+#define HL_NUL 0
+#define HL_MORTE 1
+#define HL_VIVANTE 2
+
+// Niveau des noeuds libérés par le ramasse-miettes
+#define HL_LIBRE 0xFF
+
+// Niveau maximal d'un noeud (l'univers fait au plus 2^NIVEAU_MAX cellules de côté,
+// les coordonnées tiennent donc sur un int64_t)
+#define NIVEAU_MAX 60
+
+// Nombre de noeuds qu'un appel à resultat() garde sur la pile (lui-même, ses 9
+// sous-carrés et ses 4 quarts), et taille de la pile (+ les 4 fils de noeud())
+#define PILE_PAR_NIVEAU 14
+#define TAILLE_PILE (PILE_PAR_NIVEAU * (NIVEAU_MAX + 1) + 4)
+
+// Taille minimale du tableau de noeuds et de la table de hachage
+#define CAPACITE_MIN (1 << 16)
+
+
+
+/**
+ * @brief Un noeud de l'arbre quaternaire.
+ * 
+ * fils: les 4 quarts du carré (nord-ouest, nord-est, sud-ouest, sud-est)
+ * 
+ * resultat: le carré central 2^pas_resultat générations plus tard, HL_NUL s'il
+ * n'a pas encore été calculé
+ * 
+ * pas_resultat: min(pas_log, L - 2) au moment du calcul du résultat (voir HashLife)
+ * 
+ * suivant: le noeud suivant dans la même case de la table de hachage (ou dans
+ * la liste des noeuds libres)
+ * 
+ * population: le nombre de cellules vivantes dans le carré
+ */
+typedef struct Noeud {
+    uint32_t fils[4];
+    uint32_t resultat;
+    uint32_t suivant;
+    uint64_t population;
+    uint8_t niveau;
+    uint8_t marque;
+    uint8_t pas_resultat;
+} Noeud;
+
+/**
+ * @brief L'univers du moteur hashlife.
+ * 
+ * noeuds: tous les noeuds (on les désigne par leur indice, car le tableau peut
+ * être réalloué)
+ * 
+ * libre: le premier noeud de la liste des noeuds libres
+ * 
+ * table: la table de hachage (taille_table cases, puissance de 2)
+ * 
+ * vide: vide[L] est le noeud vide de niveau L (HL_NUL s'il n'existe pas encore)
+ * 
+ * racine: le noeud représentant tout l'univers, toujours centré sur (0, 0)
+ * 
+ * pas_log: le pas actuel, resultat() avance un noeud de min(2^pas_log, 2^(L-2)) générations
+ * 
+ * budget: la mémoire (en octets) que les noeuds et la table de hachage peuvent
+ * utiliser avant le passage du ramasse-miettes
+ * 
+ * seuil: la mémoire à partir de laquelle on lance le ramasse-miettes: le
+ * budget, ou plus si les noeuds encore utilisés ne tiennent pas dedans (voir
+ * ramasse_miettes())
+ * 
+ * pile, hauteur: les noeuds en cours de calcul (voir resultat()), que le
+ * ramasse-miettes ne doit pas libérer
+ * 
+ * en_calcul: 1 pendant resultat(), le seul moment où noeud() peut lancer le
+ * ramasse-miettes (tous les noeuds utilisés sont alors sur la pile)
+ * 
+ * decalage: la cellule (x, y) de la grille est la cellule (x - decalage, y - decalage)
+ * de l'univers
+ * 
+ * regle: la règle du jeu (les résultats mémorisés en dépendent)
+ */
+struct HashLife {
+    Noeud *noeuds;
+    uint32_t capacite;
+    uint32_t nb_noeuds;
+    uint32_t libre;
+    uint32_t nb_libres;
+
+    uint32_t *table;
+    uint32_t taille_table;
+    uint32_t nb_entrees;
+
+    uint32_t vide[NIVEAU_MAX + 1];
+    uint32_t racine;
+    int pas_log;
+    size_t budget;
+    size_t seuil;
+    uint32_t pile[TAILLE_PILE];
+    unsigned int hauteur;
+    char en_calcul;
+    int64_t decalage;
+    Regle regle;
+};
+
+
+
+
+/**
+ * @brief Fonction de hachage des 4 fils d'un noeud.
+ */
+static inline uint32_t hache(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    uint64_t h = nw;
+    h = h * 0x9E3779B97F4A7C15ull + ne;
+    h = h * 0x9E3779B97F4A7C15ull + sw;
+    h = h * 0x9E3779B97F4A7C15ull + se;
+    return (uint32_t) (h ^ (h >> 32));
+}
+
+
+
+/**
+ * @brief Ajoute un noeud dans la table de hachage.
+ */
+static void insere_table(HashLife *hl, uint32_t n)
+{
+    Noeud *noeud = &(hl -> noeuds[n]);
+    uint32_t h = hache(noeud -> fils[0], noeud -> fils[1], noeud -> fils[2], noeud -> fils[3]) & (hl -> taille_table - 1);
+    noeud -> suivant = hl -> table[h];
+    hl -> table[h] = n;
+    hl -> nb_entrees++;
+}
+
+
+
+/**
+ * @brief Reconstruit la table de hachage avec nouvelle_taille cases, à partir
+ * de tous les noeuds encore utilisés.
+ */
+static void reconstruit_table(HashLife *hl, uint32_t nouvelle_taille)
+{
+    free(hl -> table);
+    hl -> table = (uint32_t *) calloc(nouvelle_taille, sizeof(uint32_t));
+    if (hl -> table == NULL) quitter("Impossible d'allouer de la mémoire pour hashlife\n", 2);
+
+    hl -> taille_table = nouvelle_taille;
+    hl -> nb_entrees = 0;
+    for (uint32_t n = HL_VIVANTE + 1; n < hl -> nb_noeuds; n++)
+    {
+        if (hl -> noeuds[n].niveau != HL_LIBRE) insere_table(hl, n);
+    }
+}
+
+
+
+/**
+ * @brief La mémoire (en octets) utilisée par les noeuds et la table de hachage.
+ */
+static inline size_t memoire(const HashLife *hl)
+{
+    return (size_t) (hl -> nb_noeuds - hl -> nb_libres) * sizeof(Noeud) + (size_t) hl -> taille_table * sizeof(uint32_t);
+}
+
+
+static void ramasse_miettes(HashLife *hl);
+
+
+
+/**
+ * @brief Retourne un noeud inutilisé (pris dans la liste des noeuds libres,
+ * ou en agrandissant le tableau de noeuds).
+ * Attention: les pointeurs sur les noeuds ne sont plus valides après l'appel.
+ */
+static uint32_t alloue_noeud(HashLife *hl)
+{
+    if (hl -> libre != HL_NUL)
+    {
+        uint32_t n = hl -> libre;
+        hl -> libre = hl -> noeuds[n].suivant;
+        hl -> nb_libres--;
+        return n;
+    }
+
+    if (hl -> nb_noeuds == hl -> capacite)
+    {
+        if (hl -> capacite >= UINT32_MAX / 2) quitter("Trop de noeuds pour hashlife\n", 2);
+        hl -> capacite *= 2;
+        hl -> noeuds = (Noeud *) realloc(hl -> noeuds, sizeof(Noeud) * hl -> capacite);
+        if (hl -> noeuds == NULL) quitter("Impossible d'allouer de la mémoire pour hashlife\n", 2);
+    }
+    return hl -> nb_noeuds++;
+}
+
+
+
+/**
+ * @brief Retourne le noeud ayant ces 4 fils (de même niveau), en le créant
+ * s'il n'existe pas encore: 2 carrés identiques sont toujours le même noeud.
+ */
+static uint32_t noeud(HashLife *hl, uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se)
+{
+    uint32_t h = hache(nw, ne, sw, se) & (hl -> taille_table - 1);
+    for (uint32_t n = hl -> table[h]; n != HL_NUL; n = hl -> noeuds[n].suivant)
+    {
+        Noeud *cand = &(hl -> noeuds[n]);
+        if (cand -> fils[0] == nw && cand -> fils[1] == ne && cand -> fils[2] == sw && cand -> fils[3] == se) return n;
+    }
+
+    // Au delà du budget on libère la mémoire avant d'en prendre plus (les 4 fils doivent survivre)
+    if (hl -> en_calcul && memoire(hl) > hl -> seuil)
+    {
+        uint32_t *fils = &(hl -> pile[hl -> hauteur]);
+        fils[0] = nw;
+        fils[1] = ne;
+        fils[2] = sw;
+        fils[3] = se;
+        hl -> hauteur += 4;
+        ramasse_miettes(hl);
+        hl -> hauteur -= 4;
+    }
+
+    // On agrandit la table si elle est trop remplie
+    if (hl -> nb_entrees >= hl -> taille_table) reconstruit_table(hl, hl -> taille_table * 2);
+
+    uint32_t n = alloue_noeud(hl);
+    Noeud *nouveau = &(hl -> noeuds[n]);
+    nouveau -> fils[0] = nw;
+    nouveau -> fils[1] = ne;
+    nouveau -> fils[2] = sw;
+    nouveau -> fils[3] = se;
+    nouveau -> resultat = HL_NUL;
+    nouveau -> marque = 0;
+    nouveau -> niveau = hl -> noeuds[nw].niveau + 1;
+    nouveau -> population = hl -> noeuds[nw].population + hl -> noeuds[ne].population
+                          + hl -> noeuds[sw].population + hl -> noeuds[se].population;
+    insere_table(hl, n);
+    return n;
+}
+
+
+
+/**
+ * @brief Retourne le noeud vide de niveau L.
+ */
+static uint32_t vide(HashLife *hl, unsigned int L)
+{
+    if (L == 0) return HL_MORTE;
+    if (hl -> vide[L] == HL_NUL)
+    {
+        uint32_t fils = vide(hl, L - 1);
+        hl -> vide[L] = noeud(hl, fils, fils, fils, fils);
+    }
+    return hl -> vide[L];
+}
+
+
+
+// Accès au fils i du noeud n (+ lisible)
+#define FILS(hl, n, i) ((hl) -> noeuds[n].fils[i])
+
+
+
+/**
+ * @brief Le carré central d'un noeud (niveau L - 1).
+ */
+static uint32_t centre(HashLife *hl, uint32_t n)
+{
+    uint32_t nw = FILS(hl, n, 0), ne = FILS(hl, n, 1), sw = FILS(hl, n, 2), se = FILS(hl, n, 3);
+    return noeud(hl, FILS(hl, nw, 3), FILS(hl, ne, 2), FILS(hl, sw, 1), FILS(hl, se, 0));
+}
+
+
+
+/**
+ * @brief Le carré à cheval entre 2 noeuds côte à côte (ouest et est).
+ */
+static uint32_t centre_h(HashLife *hl, uint32_t w, uint32_t e)
+{
+    return noeud(hl, FILS(hl, w, 1), FILS(hl, e, 0), FILS(hl, w, 3), FILS(hl, e, 2));
+}
+
+
+
+/**
+ * @brief Le carré à cheval entre 2 noeuds l'un au dessus de l'autre (nord et sud).
+ */
+static uint32_t centre_v(HashLife *hl, uint32_t n, uint32_t s)
+{
+    return noeud(hl, FILS(hl, n, 2), FILS(hl, n, 3), FILS(hl, s, 0), FILS(hl, s, 1));
+}
+
+
+
+/**
+ * @brief Cas de base: un noeud de niveau 2 (4x4 cellules). On calcule
+ * directement le carré central 2x2 à la génération suivante.
+ */
+static uint32_t base(HashLife *hl, uint32_t n)
+{
+    // On récupère les 16 cellules dans un entier: bit (4 * ligne + colonne)
+    unsigned int cellules = 0;
+    for (unsigned int q = 0; q < 4; q++)
+    {
+        uint32_t quart = FILS(hl, n, q);
+        for (unsigned int f = 0; f < 4; f++)
+        {
+            unsigned int ligne = 2 * (q / 2) + f / 2, colonne = 2 * (q % 2) + f % 2;
+            if (FILS(hl, quart, f) == HL_VIVANTE) cellules |= 1u << (4 * ligne + colonne);
+        }
+    }
+
+    uint32_t resultat[4];
+    for (unsigned int f = 0; f < 4; f++)
+    {
+        unsigned int ligne = 1 + f / 2, colonne = 1 + f % 2;
+        unsigned int voisins = 0;
+        for (int i = -1; i <= 1; i++)
+        {
+            for (int j = -1; j <= 1; j++)
+            {
+                if (i == 0 && j == 0) continue;
+                voisins += (cellules >> (4 * (ligne + i) + colonne + j)) & 1;
+            }
+        }
+        unsigned int vivante = (cellules >> (4 * ligne + colonne)) & 1;
+        resultat[f] = dans_masque(vivante ? hl -> regle.survie : hl -> regle.naissance, voisins) ? HL_VIVANTE : HL_MORTE;
+    }
+    return noeud(hl, resultat[0], resultat[1], resultat[2], resultat[3]);
+}
+
+
+
+/**
+ * @brief Calcule (ou retrouve) le résultat d'un noeud de niveau L >= 2: son
+ * carré central min(2^pas_log, 2^(L-2)) générations plus tard.
+ * 
+ * On découpe le noeud en 9 sous-carrés de niveau L - 1 qui se chevauchent, dont
+ * on calcule le résultat (récursivement). On regroupe ces 9 résultats en 4 carrés
+ * de niveau L - 1, dont on prend à nouveau le résultat (si on doit avancer de
+ * 2^(L-2) générations), ou simplement le centre (si on doit avancer de moins).
+ * 
+ * Le ramasse-miettes peut passer pendant le calcul: le noeud, ses sous-carrés
+ * et ses quarts sont donc rangés sur la pile, et non dans des variables locales.
+ */
+static uint32_t resultat(HashLife *hl, uint32_t n)
+{
+    /* Un résultat mémorisé reste valable quand le pas change, tant que le noeud
+    avance du même nombre de générations (toujours le cas pour les petits noeuds) */
+    unsigned int L = hl -> noeuds[n].niveau;
+    unsigned int pas = (hl -> pas_log < (int) L - 2) ? (unsigned int) hl -> pas_log : L - 2;
+    if (hl -> noeuds[n].resultat != HL_NUL && hl -> noeuds[n].pas_resultat == pas) return hl -> noeuds[n].resultat;
+
+    uint32_t r;
+    if (L == 2)
+    {
+        r = base(hl, n);
+    }
+    else
+    {
+        // Le noeud, ses 9 sous-carrés et ses 4 quarts (vides tant qu'ils ne sont pas calculés)
+        uint32_t *pile = &(hl -> pile[hl -> hauteur]);
+        uint32_t *s = pile + 1, *q = pile + 10;
+        for (unsigned int i = 0; i < PILE_PAR_NIVEAU; i++) pile[i] = HL_NUL;
+        pile[0] = n;
+        hl -> hauteur += PILE_PAR_NIVEAU;
+
+        // Les fils sont protégés par le noeud
+        uint32_t nw = FILS(hl, n, 0), ne = FILS(hl, n, 1), sw = FILS(hl, n, 2), se = FILS(hl, n, 3);
+
+        // Les 9 sous-carrés, puis leurs résultats
+        s[0] = nw;
+        s[1] = centre_h(hl, nw, ne);
+        s[2] = ne;
+        s[3] = centre_v(hl, nw, sw);
+        s[4] = centre(hl, n);
+        s[5] = centre_v(hl, ne, se);
+        s[6] = sw;
+        s[7] = centre_h(hl, sw, se);
+        s[8] = se;
+        for (unsigned int i = 0; i < 9; i++) s[i] = resultat(hl, s[i]);
+
+        q[0] = noeud(hl, s[0], s[1], s[3], s[4]);
+        q[1] = noeud(hl, s[1], s[2], s[4], s[5]);
+        q[2] = noeud(hl, s[3], s[4], s[6], s[7]);
+        q[3] = noeud(hl, s[4], s[5], s[7], s[8]);
+        char pleine_vitesse = pas == L - 2;
+        for (unsigned int i = 0; i < 4; i++) q[i] = pleine_vitesse ? resultat(hl, q[i]) : centre(hl, q[i]);
+        r = noeud(hl, q[0], q[1], q[2], q[3]);
+
+        hl -> hauteur -= PILE_PAR_NIVEAU;
+    }
+
+    // Le tableau a pu être réalloué: on ne garde pas de pointeur sur le noeud
+    hl -> noeuds[n].resultat = r;
+    hl -> noeuds[n].pas_resultat = pas;
+    return r;
+}
+
+
+
+/**
+ * @brief Agrandit l'univers: retourne un noeud de niveau L + 1, centré au même
+ * endroit, avec le noeud n au centre et du vide autour.
+ */
+static uint32_t agrandit(HashLife *hl, uint32_t n)
+{
+    unsigned int L = hl -> noeuds[n].niveau;
+    uint32_t e = vide(hl, L - 1);
+    uint32_t nw = FILS(hl, n, 0), ne = FILS(hl, n, 1), sw = FILS(hl, n, 2), se = FILS(hl, n, 3);
+    return noeud(hl, noeud(hl, e, e, e, nw), noeud(hl, e, e, ne, e),
+                     noeud(hl, e, sw, e, e), noeud(hl, se, e, e, e));
+}
+
+
+
+/**
+ * @brief Permet de savoir si toutes les cellules vivantes d'un noeud de niveau
+ * L >= 3 sont dans son carré central de 2^(L-2) cellules de côté. Dans ce cas,
+ * 2^(L-3) générations plus tard, elles seront toutes dans le résultat du noeud.
+ */
+static char centre_contient_tout(HashLife *hl, uint32_t n)
+{
+    // Le carré central est formé d'un arrière-petit-fils de chaque fils (celui qui touche le centre)
+    uint64_t population = 0;
+    for (unsigned int i = 0; i < 4; i++)
+    {
+        uint32_t petit_fils = FILS(hl, FILS(hl, n, i), 3 - i);
+        population += hl -> noeuds[FILS(hl, petit_fils, 3 - i)].population;
+    }
+    return population == hl -> noeuds[n].population;
+}
+
+
+
+/**
+ * @brief Marque un noeud, tous ses descendants et leurs résultats mémorisés
+ * comme utilisés.
+ */
+static void marque(HashLife *hl, uint32_t n)
+{
+    if (n <= HL_VIVANTE || hl -> noeuds[n].marque) return;
+    hl -> noeuds[n].marque = 1;
+    for (unsigned int i = 0; i < 4; i++) marque(hl, FILS(hl, n, i));
+    marque(hl, hl -> noeuds[n].resultat);
+}
+
+
+
+/**
+ * @brief Ramasse-miettes: libère tous les noeuds qui ne sont pas utilisés par
+ * la racine, les noeuds vides ou la pile. Les résultats mémorisés des noeuds
+ * gardés sont gardés aussi: sans eux, un ramasse-miettes au milieu d'une étape
+ * ferait recalculer tous les sous-carrés partagés.
+ * 
+ * Les noeuds libres à la fin du tableau sont rendus (les indices des autres ne
+ * changent pas), et la table de hachage est ramenée au nombre de noeuds restants.
+ * Si ces noeuds occupent déjà plus de la moitié du budget, le prochain passage
+ * n'a lieu qu'au double de leur mémoire, pour ne pas repasser sans cesse.
+ */
+static void ramasse_miettes(HashLife *hl)
+{
+    marque(hl, hl -> racine);
+    for (unsigned int L = 0; L <= NIVEAU_MAX; L++) marque(hl, hl -> vide[L]);
+    for (unsigned int i = 0; i < hl -> hauteur; i++) marque(hl, hl -> pile[i]);
+
+    // Le tableau s'arrête après le dernier noeud utilisé
+    uint32_t fin = HL_VIVANTE + 1;
+    for (uint32_t n = HL_VIVANTE + 1; n < hl -> nb_noeuds; n++)
+    {
+        if (hl -> noeuds[n].marque) fin = n + 1;
+    }
+
+    /* On refait la liste des noeuds libres à l'envers: les premiers noeuds
+    réutilisés sont ceux du début du tableau, qui reste ainsi compact */
+    hl -> libre = HL_NUL;
+    hl -> nb_libres = 0;
+    for (uint32_t n = fin - 1; n > HL_VIVANTE; n--)
+    {
+        Noeud *noeud = &(hl -> noeuds[n]);
+        if (noeud -> marque)
+        {
+            noeud -> marque = 0;
+            continue;
+        }
+        noeud -> niveau = HL_LIBRE;
+        noeud -> suivant = hl -> libre;
+        hl -> libre = n;
+        hl -> nb_libres++;
+    }
+    hl -> nb_noeuds = fin;
+
+    uint32_t capacite = hl -> capacite;
+    while (capacite > CAPACITE_MIN && capacite / 4 >= hl -> nb_noeuds) capacite /= 2;
+    if (capacite != hl -> capacite)
+    {
+        hl -> capacite = capacite;
+        hl -> noeuds = (Noeud *) realloc(hl -> noeuds, sizeof(Noeud) * hl -> capacite);
+        if (hl -> noeuds == NULL) quitter("Impossible d'allouer de la mémoire pour hashlife\n", 2);
+    }
+
+    uint32_t taille_table = CAPACITE_MIN;
+    while (taille_table < hl -> nb_noeuds - hl -> nb_libres) taille_table *= 2;
+    reconstruit_table(hl, taille_table);
+
+    hl -> seuil = 2 * memoire(hl);
+    if (hl -> seuil < hl -> budget) hl -> seuil = hl -> budget;
+}
+
+
+
+/**
+ * @brief Initialise un univers hashlife vide.
+ * 
+ * @param budget La mémoire (en octets) que les noeuds et la table de hachage
+ * peuvent utiliser avant le passage du ramasse-miettes
+ * @param regle Un pointeur sur la règle du jeu (sans naissance à 0 voisin)
+ * @return HashLife* Un pointeur sur l'univers
+ */
+HashLife *init_hashlife(size_t budget, const Regle *regle)
+{
+    HashLife *hl = (HashLife *) malloc(sizeof(HashLife));
+    if (hl == NULL) quitter("Impossible d'allouer de la mémoire pour hashlife\n", 2);
+
+    hl -> capacite = CAPACITE_MIN;
+    hl -> noeuds = (Noeud *) malloc(sizeof(Noeud) * hl -> capacite);
+    if (hl -> noeuds == NULL) quitter("Impossible d'allouer de la mémoire pour hashlife\n", 2);
+
+    // Les 2 feuilles
+    memset(hl -> noeuds, 0, sizeof(Noeud) * (HL_VIVANTE + 1));
+    hl -> noeuds[HL_VIVANTE].population = 1;
+    hl -> nb_noeuds = HL_VIVANTE + 1;
+    hl -> libre = HL_NUL;
+    hl -> nb_libres = 0;
+
+    hl -> table = NULL;
+    reconstruit_table(hl, CAPACITE_MIN);
+
+    for (unsigned int L = 0; L <= NIVEAU_MAX; L++) hl -> vide[L] = HL_NUL;
+    hl -> pas_log = -1;
+    hl -> budget = budget;
+    hl -> seuil = budget;
+    hl -> hauteur = 0;
+    hl -> en_calcul = 0;
+    hl -> decalage = 0;
+    hl -> regle = *regle;
+    hl -> racine = vide(hl, 3);
+    return hl;
+}
+
+
+
+/**
+ * @brief Libère la mémoire allouée dans init_hashlife()
+ * 
+ * @param hl Un pointeur sur l'univers à libérer
+ */
+void free_hashlife(HashLife *hl)
+{
+    free(hl -> noeuds);
+    free(hl -> table);
+    free(hl);
+}
+
+
+
+/**
+ * @brief Construit le noeud de niveau L correspondant au carré de la grille dont
+ * le coin supérieur gauche est (x, y). Les cellules hors de la grille sont mortes.
+ */
+static uint32_t construit(HashLife *hl, Grille *grille, int64_t x, int64_t y, unsigned int L)
+{
+    int64_t cote = (int64_t) 1 << L, taille = grille -> taille;
+    if (x >= taille || y >= taille || x + cote <= 0 || y + cote <= 0) return vide(hl, L);
+    if (L == 0) return CELLULE(grille, y, x) ? HL_VIVANTE : HL_MORTE;
+
+    int64_t moitie = cote / 2;
+    uint32_t nw = construit(hl, grille, x, y, L - 1);
+    uint32_t ne = construit(hl, grille, x + moitie, y, L - 1);
+    uint32_t sw = construit(hl, grille, x, y + moitie, L - 1);
+    uint32_t se = construit(hl, grille, x + moitie, y + moitie, L - 1);
+    return noeud(hl, nw, ne, sw, se);
+}
+
+
+
+/**
+ * @brief Union de 2 noeuds de même niveau: une cellule est vivante si elle
+ * l'est dans l'un des 2 noeuds.
+ */
+static uint32_t fusionne(HashLife *hl, uint32_t a, uint32_t b)
+{
+    if (hl -> noeuds[a].population == 0 || a == b) return b;
+    if (hl -> noeuds[b].population == 0) return a;
+    if (hl -> noeuds[a].niveau == 0) return HL_VIVANTE;
+
+    uint32_t fils[4];
+    for (unsigned int i = 0; i < 4; i++) fils[i] = fusionne(hl, FILS(hl, a, i), FILS(hl, b, i));
+    return noeud(hl, fils[0], fils[1], fils[2], fils[3]);
+}
+
+
+
+/**
+ * @brief Remplace le contenu de l'univers par celui de la grille.
+ * 
+ * @param grille Un pointeur sur la grille à charger
+ * @param hl Un pointeur sur l'univers
+ */
+void grille2hashlife(Grille *grille, HashLife *hl)
+{
+    // Le plus petit carré (de niveau >= 3) qui contient la grille
+    unsigned int L = 3;
+    while ((1ul << L) < grille -> taille) L++;
+
+    hl -> racine = construit(hl, grille, 0, 0, L);
+    hl -> decalage = (int64_t) 1 << (L - 1);
+}
+
+
+
+/**
+ * @brief Ajoute à l'univers les cellules vivantes d'une grille, sans effacer
+ * celles qui y sont déjà. La cellule (0, 0) de la grille devient la cellule
+ * (x, y) (dans les coordonnées de la grille chargée par grille2hashlife()).
+ * 
+ * @param hl Un pointeur sur l'univers
+ * @param grille Un pointeur sur la grille à ajouter
+ * @param x L'abscisse de la colonne 0 de la grille
+ * @param y L'ordonnée de la ligne 0 de la grille
+ */
+void ajoute_grille_hashlife(HashLife *hl, Grille *grille, int64_t x, int64_t y)
+{
+    // On agrandit la racine jusqu'à ce qu'elle contienne toute la grille
+    while (1)
+    {
+        unsigned int L = hl -> noeuds[hl -> racine].niveau;
+        int64_t cote = (int64_t) 1 << L, coin = hl -> decalage - cote / 2;
+        if (x >= coin && y >= coin && x + grille -> taille <= coin + cote && y + grille -> taille <= coin + cote)
+        {
+            hl -> racine = fusionne(hl, hl -> racine, construit(hl, grille, coin - x, coin - y, L));
+            return;
+        }
+
+        if (L >= NIVEAU_MAX) quitter("L'univers hashlife est trop grand\n", 2);
+        hl -> racine = agrandit(hl, hl -> racine);
+    }
+}
+
+
+
+/**
+ * @brief Écrit dans la grille les cellules vivantes du noeud n (de niveau L),
+ * dont le coin supérieur gauche est en (x, y) dans la grille.
+ */
+static void extrait(HashLife *hl, uint32_t n, int64_t x, int64_t y, unsigned int L, Grille *grille)
+{
+    int64_t cote = (int64_t) 1 << L, taille = grille -> taille;
+    if (hl -> noeuds[n].population == 0 || x >= taille || y >= taille || x + cote <= 0 || y + cote <= 0) return;
+    if (L == 0)
+    {
+        CELLULE(grille, y, x) = 1;
+        return;
+    }
+
+    int64_t moitie = cote / 2;
+    extrait(hl, FILS(hl, n, 0), x, y, L - 1, grille);
+    extrait(hl, FILS(hl, n, 1), x + moitie, y, L - 1, grille);
+    extrait(hl, FILS(hl, n, 2), x, y + moitie, L - 1, grille);
+    extrait(hl, FILS(hl, n, 3), x + moitie, y + moitie, L - 1, grille);
+}
+
+
+
+/**
+ * @brief Écrit dans la grille la partie de l'univers dont le coin supérieur
+ * gauche est (x, y) (dans les coordonnées de la grille chargée par
+ * grille2hashlife()). L'âge et l'origine des cellules ne sont pas suivis par
+ * hashlife: toutes les cellules vivantes ont un âge de 1.
+ * 
+ * @param hl Un pointeur sur l'univers
+ * @param grille Un pointeur sur la grille où écrire
+ * @param x L'abscisse de la colonne 0 de la grille
+ * @param y L'ordonnée de la ligne 0 de la grille
+ */
+void hashlife2grille(HashLife *hl, Grille *grille, int64_t x, int64_t y)
+{
+    memset(grille -> matrice - grille -> pas - ALIGNEMENT_GRILLE, 0, (size_t) (grille -> taille + 2) * grille -> pas);
+
+    unsigned int L = hl -> noeuds[hl -> racine].niveau;
+    int64_t coin = hl -> decalage - ((int64_t) 1 << (L - 1));
+    extrait(hl, hl -> racine, coin - x, coin - y, L, grille);
+}
+
+
+
+/**
+ * @brief Appelle rappel pour chaque carré non vide de 64 x 64 cellules de
+ * l'arbre (ou pour la racine si elle est plus petite).
+ */
+static void parcours_blocs(HashLife *hl, uint32_t n, int64_t x, int64_t y, unsigned int L, RappelBloc rappel, void *contexte)
+{
+    if (hl -> noeuds[n].population == 0) return;
+    if (L <= 6)
+    {
+        rappel(contexte, x, y);
+        return;
+    }
+
+    int64_t moitie = (int64_t) 1 << (L - 1);
+    parcours_blocs(hl, FILS(hl, n, 0), x, y, L - 1, rappel, contexte);
+    parcours_blocs(hl, FILS(hl, n, 1), x + moitie, y, L - 1, rappel, contexte);
+    parcours_blocs(hl, FILS(hl, n, 2), x, y + moitie, L - 1, rappel, contexte);
+    parcours_blocs(hl, FILS(hl, n, 3), x + moitie, y + moitie, L - 1, rappel, contexte);
+}
+
+
+
+/**
+ * @brief Parcourt les parties non vides de l'univers: rappel est appelée avec
+ * le coin supérieur gauche (dans les coordonnées de la grille chargée par
+ * grille2hashlife()) de chaque carré de 64 x 64 cellules contenant des cellules
+ * vivantes. On peut les lire avec hashlife2grille().
+ * 
+ * @param hl Un pointeur sur l'univers
+ * @param rappel La fonction à appeler pour chaque carré
+ * @param contexte Donné tel quel à rappel
+ */
+void blocs_hashlife(HashLife *hl, RappelBloc rappel, void *contexte)
+{
+    unsigned int L = hl -> noeuds[hl -> racine].niveau;
+    int64_t coin = hl -> decalage - ((int64_t) 1 << (L - 1));
+    parcours_blocs(hl, hl -> racine, coin, coin, L, rappel, contexte);
+}
+
+
+
+/**
+ * @brief Fait avancer l'univers de nb_generations générations.
+ * 
+ * nb_generations est décomposé en puissances de 2: pour chacune, on agrandit
+ * la racine jusqu'à ce qu'elle soit assez grande, puis on la remplace par son
+ * résultat.
+ * 
+ * @param hl Un pointeur sur l'univers
+ * @param nb_generations Le nombre de générations
+ */
+void avance_hashlife(HashLife *hl, unsigned long int nb_generations)
+{
+    for (int k = 0; nb_generations != 0; k++, nb_generations >>= 1)
+    {
+        if (!(nb_generations & 1)) continue;
+
+        hl -> pas_log = k;
+
+        // La racine doit pouvoir avancer de 2^k générations sans que rien n'en sorte
+        while (hl -> noeuds[hl -> racine].niveau < k + 3 || !centre_contient_tout(hl, hl -> racine))
+        {
+            if (hl -> noeuds[hl -> racine].niveau >= NIVEAU_MAX) quitter("L'univers hashlife est trop grand\n", 2);
+            hl -> racine = agrandit(hl, hl -> racine);
+        }
+        hl -> en_calcul = 1;
+        hl -> racine = resultat(hl, hl -> racine);
+        hl -> en_calcul = 0;
+
+        // Entre 2 étapes la pile est vide: on libère la mémoire si on dépasse le budget
+        if (memoire(hl) > hl -> seuil) ramasse_miettes(hl);
+    }
+}
+
+
+
+/**
+ * @brief Retourne le nombre de cellules vivantes dans tout l'univers.
+ * 
+ * @param hl Un pointeur sur l'univers
+ * @return unsigned long int La population
+ */
+unsigned long int population_hashlife(HashLife *hl)
+{
+    return hl -> noeuds[hl -> racine].population;
+}
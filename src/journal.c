@@ -0,0 +1,188 @@
+/**
+ * @file journal.c
+ * @author M3tex
+ * @brief Fichier contenant le journal des statistiques: les chiffres de
+ * chaque génération (naissances, morts, cellules en vie et originelles) sont
+ * écrits dans un fichier CSV, ou binaire si son nom finit par ".bin".
+ *
+ * Les cellules en vie et originelles d'une ligne sont celles d'après le
+ * calcul de sa génération. Les moteurs les comptent avant le calcul (voir
+ * Stats): la population d'après se déduit des naissances et des morts, mais
+ * les cellules originelles ne sont connues qu'au calcul suivant. Chaque ligne
+ * est donc écrite une génération plus tard (la dernière à la fermeture).
+ *
+ * Les lignes sont préparées dans un tampon et écrites par blocs de
+ * TAILLE_TAMPON_JOURNAL octets: on ne fait pas d'appel à printf() ni
+ * d'écriture à chaque génération.
+ *
+ * Format binaire: "GOLJ", puis pour chaque génération 5 entiers de 8 octets
+ * (little-endian) dans le même ordre que les colonnes du CSV.
+ * @version 0.1
+ * @date 2022-12-28
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "journal.h"
+#include "utilitaires.h"
+
+
+#define TAILLE_TAMPON_JOURNAL 65536
+
+// Une ligne de CSV ou un enregistrement binaire ne dépasse pas cette taille
+#define TAILLE_LIGNE_MAX 128
+
+
+
+/**
+ * @brief Écrit le contenu du tampon dans le fichier et le vide.
+ */
+static void vide_tampon(Journal *journal)
+{
+    if (journal -> taille == 0) return;
+    if (fwrite(journal -> tampon, 1, journal -> taille, journal -> fichier) != journal -> taille)
+    {
+        print_redb("Impossible d'écrire le journal des statistiques\n");
+    }
+    journal -> taille = 0;
+}
+
+
+
+/**
+ * @brief Écrit un entier en décimal à la fin du tampon, suivi de fin (',' ou '\n').
+ */
+static void ajoute_nombre(Journal *journal, unsigned long int n, char fin)
+{
+    // Les chiffres sont obtenus à l'envers
+    char chiffres[20];
+    unsigned int nb = 0;
+    do
+    {
+        chiffres[nb++] = (char) ('0' + n % 10);
+        n /= 10;
+    } while (n > 0);
+
+    char *dst = journal -> tampon + journal -> taille;
+    for (unsigned int i = 0; i < nb; i++) dst[i] = chiffres[nb - 1 - i];
+    dst[nb] = fin;
+    journal -> taille += nb + 1;
+}
+
+
+
+/**
+ * @brief Écrit un entier de 8 octets (en little-endian) à la fin du tampon.
+ */
+static void ajoute_entier(Journal *journal, uint64_t n)
+{
+    for (unsigned int i = 0; i < 8; i++) journal -> tampon[journal -> taille++] = (char) (n >> (8 * i));
+}
+
+
+
+/**
+ * @brief Crée le fichier du journal. Les générations suivantes sont comptées
+ * à partir des statistiques actuelles (0, ou celles d'une partie reprise).
+ *
+ * @param fichier Le chemin du fichier (binaire s'il finit par ".bin", CSV sinon)
+ * @param statistiques Un pointeur sur les statistiques actuelles du jeu
+ * @return Journal* Un pointeur sur le Journal
+ */
+Journal *ouvre_journal(const char *fichier, const Stats *statistiques)
+{
+    Journal *journal = (Journal *) malloc(sizeof(Journal));
+    char *tampon = (char *) malloc(TAILLE_TAMPON_JOURNAL);
+    if (journal == NULL || tampon == NULL) quitter("Impossible d'allouer de la mémoire pour le journal\n", 2);
+
+    journal -> fichier = fopen(fichier, "wb");
+    if (journal -> fichier == NULL) quitter("Impossible de créer le fichier des statistiques\n", 1);
+
+    size_t longueur = strlen(fichier);
+    journal -> binaire = longueur >= 4 && !strcmp(fichier + longueur - 4, ".bin");
+    journal -> tampon = tampon;
+    journal -> nes = statistiques -> nb_cell_nes;
+    journal -> mortes = statistiques -> nb_cell_mortes;
+    journal -> en_attente = 0;
+
+    const char *entete = journal -> binaire ? "GOLJ" : "generation,naissances,morts,en_vie,originelles\n";
+    memcpy(tampon, entete, strlen(entete));
+    journal -> taille = strlen(entete);
+    return journal;
+}
+
+
+
+/**
+ * @brief Écrit la ligne en attente, avec le nombre de cellules originelles
+ * d'après le calcul de sa génération.
+ */
+static void termine_ligne(Journal *journal, unsigned long int originelles)
+{
+    if (journal -> taille + TAILLE_LIGNE_MAX > TAILLE_TAMPON_JOURNAL) vide_tampon(journal);
+    journal -> en_attente = 0;
+
+    if (journal -> binaire)
+    {
+        ajoute_entier(journal, journal -> generation);
+        ajoute_entier(journal, journal -> nes_generation);
+        ajoute_entier(journal, journal -> mortes_generation);
+        ajoute_entier(journal, journal -> en_vie);
+        ajoute_entier(journal, originelles);
+        return;
+    }
+    ajoute_nombre(journal, journal -> generation, ',');
+    ajoute_nombre(journal, journal -> nes_generation, ',');
+    ajoute_nombre(journal, journal -> mortes_generation, ',');
+    ajoute_nombre(journal, journal -> en_vie, ',');
+    ajoute_nombre(journal, originelles, '\n');
+}
+
+
+
+/**
+ * @brief Ajoute la génération qui vient d'être calculée au journal. Les
+ * naissances et les morts sont celles de cette génération, en_vie et
+ * originelles sont comptées après son calcul.
+ *
+ * Les statistiques du moteur sont celles d'avant le calcul: elles terminent
+ * la ligne de la génération précédente, et celle-ci attend le prochain appel
+ * (ou ferme_journal()).
+ *
+ * @param journal Un pointeur sur le Journal
+ * @param statistiques Un pointeur sur les statistiques du jeu
+ */
+void ecrit_journal(Journal *journal, const Stats *statistiques)
+{
+    if (journal -> en_attente) termine_ligne(journal, statistiques -> nb_cell_originelles);
+
+    journal -> generation = statistiques -> generations;
+    journal -> nes_generation = statistiques -> nb_cell_nes - journal -> nes;
+    journal -> mortes_generation = statistiques -> nb_cell_mortes - journal -> mortes;
+    journal -> en_vie = statistiques -> en_vie + journal -> nes_generation - journal -> mortes_generation;
+    journal -> nes = statistiques -> nb_cell_nes;
+    journal -> mortes = statistiques -> nb_cell_mortes;
+    journal -> en_attente = 1;
+}
+
+
+
+/**
+ * @brief Écrit la fin du journal, ferme le fichier et libère la mémoire
+ * allouée dans ouvre_journal().
+ *
+ * @param journal Un pointeur sur le Journal
+ * @param originelles Le nombre de cellules originelles actuel (voir
+ * compte_originelles()), pour la ligne de la dernière génération
+ */
+void ferme_journal(Journal *journal, unsigned long int originelles)
+{
+    if (journal -> en_attente) termine_ligne(journal, originelles);
+    vide_tampon(journal);
+    fclose(journal -> fichier);
+    free(journal -> tampon);
+    free(journal);
+}
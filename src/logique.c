@@ -11,7 +11,19 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "logique.h"
+#include "bitboard.h"
+#include "simd.h"
+#include "table.h"
+#include "hashlife.h"
+#include "univers.h"
+#include "parallele.h"
+#include "journal.h"
+#include "cycles.h"
+#include "regle.h"
+#include "topologie.h"
+#include "mesures.h"
 #include "utilitaires.h"
 
 
@@ -28,102 +40,549 @@
 unsigned char compte_voisin(Grille *grille, unsigned int x, unsigned int y)
 {
     // + lisible (évite les -> partout)
-    unsigned int taille = grille -> taille;
-    cellule **matrice = grille -> matrice;
+    unsigned int pas = grille -> pas;
+    const cellule *m = &CELLULE(grille, x, y);
 
-    /* Obligé de tester car les coords sont en unsigned int -> si x = 0, x - 1 = 2^(sizeof(int) * 8)
-    De même, si x = 2^(sizeof(int) * 8), x + 1 = 0.*/
-    unsigned int debut_x = x - 1 > x ? x : x - 1;
-    unsigned int lim_x = x + 1 < x ? x : x + 1;
+    /* Pas besoin de tester si on sort de la grille: elle est entourée d'une bordure
+    de cellules mortes (voir Grille). h et b pointent sur les voisins du dessus et
+    du dessous. */
+    const cellule *h = m - pas;
+    const cellule *b = m + pas;
+
+    return (h[-1] != 0) + (h[0] != 0) + (h[1] != 0)
+         + (m[-1] != 0)               + (m[1] != 0)
+         + (b[-1] != 0) + (b[0] != 0) + (b[1] != 0);
+}
 
-    // Idem pour y
-    unsigned int debut_y = y - 1 > y ? y : y - 1;
-    unsigned int lim_y = y + 1 < y ? y : y + 1;
 
-    char cpt = 0;
-    for (unsigned int i = debut_x; i <= lim_x; i++)
+
+/**
+ * @brief Le calcul de generation_suivante(). compte est une constante: le
+ * compilateur en fait une version avec et une version sans statistiques. De
+ * même pour naissance et survie avec les règles spécialisées (voir AVEC_REGLE).
+ *
+ * Les statistiques sont comptées dans des variables locales et ajoutées à la
+ * fin: écrire dans *statistiques à chaque cellule obligerait le compilateur à
+ * relire les compteurs après chaque écriture dans la grille (les cellules sont
+ * des char, qui peuvent pointer sur n'importe quoi).
+ */
+static inline __attribute__((always_inline)) char calcule_generation(Grille *courante, Grille *suivante, const Zone *zone,
+                                                                     Stats *statistiques, const char compte,
+                                                                     const uint16_t naissance, const uint16_t survie)
+{
+    /* On va compter le nombre de voisin pour chaque cellule et en
+    déduire l'état de la cellule à l'itération suivante */
+    char tmp_voisins;
+    char change = 0;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0;
+    for (unsigned int i = zone -> y; i < zone -> y + zone -> hauteur; i++)
     {
-        for (unsigned int j = debut_y; j <= lim_y; j++)
+        for (unsigned int j = zone -> x; j < zone -> x + zone -> largeur; j++)
         {
-            // On vérifie qu'on ne sort pas de la grille ou qu'on ne compte pas la cellule actuelle
-            if (!(i < taille && j < taille) || (i == x && j == y)) continue;
-            cpt += matrice[i][j] != 0;  
+            tmp_voisins = compte_voisin(courante, i, j);
+            cellule cell = CELLULE(courante, i, j);
+            cellule *next_it = &CELLULE(suivante, i, j);
+
+            // Si cellule morte: passe à vivante si son nombre de voisins est dans B, reste morte sinon
+            if (!cell)
+            {
+                char nait = dans_masque(naissance, tmp_voisins);
+                *next_it = nait;
+                change |= nait;
+
+                // On met à jour les stats
+                if (compte) nes += nait;
+                continue;
+            }
+
+            // On met à jour les stats
+            if (compte)
+            {
+                en_vie++;
+                originelles += cell >> 7;
+            }
+
+            /* Si vivante et son nombre de voisins est dans S -> elle reste vivante.
+            Dans tous les autres cas elle meurt*/
+            if (!dans_masque(survie, tmp_voisins))
+            {
+                *next_it = 0;
+                change = 1;
+                if (compte) mortes++;
+                continue;
+            }
+
+            /* On augmente l'âge de la cellule.
+            & 127 car 127 en binaire: 01111111 */
+            unsigned char age = (cell & 127) + 1;
+
+            /* Si l'age ne dépasse pas nos 7 bits on met à jour l'âge de la cellule
+            Si ça dépasse elle garde son âge actuel (127 générations).
+            & (1 << 7) pour garder le 8ème bit servant à déterminer si une cellule
+            est originelle ou non. */
+            *next_it = (age & (1 << 7)) ? cell : (cell & (1 << 7)) | age;
+            change |= (*next_it != cell);
         }
     }
-    return cpt;
+
+    if (compte)
+    {
+        statistiques -> en_vie += en_vie;
+        statistiques -> nb_cell_originelles += originelles;
+        statistiques -> nb_cell_nes += nes;
+        statistiques -> nb_cell_mortes += mortes;
+    }
+    return change;
 }
 
 
 
 /**
- * @brief Utilise les règles du jeu pour calculer l'itération
- * suivante à partir de la grille actuelle.
+ * @brief Utilise les règles du jeu pour calculer l'itération suivante d'une
+ * zone de la grille courante, directement dans la grille suivante (qui doit avoir
+ * la même taille). Toutes les cellules de la zone sont écrites: il n'est pas
+ * nécessaire de les remettre à 0 avant.
+ * Peut être appelée en parallèle sur des zones disjointes.
  *
- * @param grille Un pointeur sur la grille à mettre à jour.
- * @param taille La taille de la grille.
+ * @param courante Un pointeur sur la grille à l'itération actuelle.
+ * @param suivante Un pointeur sur la grille où écrire l'itération suivante.
+ * @param zone La zone à calculer.
+ * @param statistiques Un pointeur sur les statistiques de la zone (additionnées),
+ * NULL pour ne pas les calculer.
+ * @param regle Un pointeur sur la règle du jeu
+ * @return char 1 si au moins une cellule de la zone a changé, 0 sinon.
  */
-void maj_grille(Jeu *jeu)
+char generation_suivante(Grille *courante, Grille *suivante, const Zone *zone, Stats *statistiques, const Regle *regle)
+{
+    if (statistiques == NULL)
+    {
+        AVEC_REGLE(regle, return calcule_generation(courante, suivante, zone, NULL, 0, naissance, survie));
+    }
+    AVEC_REGLE(regle, return calcule_generation(courante, suivante, zone, statistiques, 1, naissance, survie));
+    return 0;
+}
+
+
+
+/**
+ * @brief Calcule la génération suivante d'une zone de la grille avec le moteur
+ * choisi.
+ * 
+ * @param jeu Un pointeur sur le Jeu
+ * @param zone La zone à calculer
+ * @param statistiques Un pointeur sur les statistiques de la zone (additionnées),
+ * NULL pour ne pas les calculer
+ * @return char 1 si au moins une cellule de la zone a changé, 0 sinon
+ */
+static char calcule_zone(Jeu *jeu, const Zone *zone, Stats *statistiques)
+{
+    switch (jeu -> moteur)
+    {
+    case MOTEUR_BITBOARD:
+        return maj_bitgrille(jeu -> bitgrille, zone, statistiques, &(jeu -> regle));
+    case MOTEUR_SIMD:
+        return generation_suivante_simd(jeu -> grille, jeu -> tampon, zone, statistiques, &(jeu -> regle));
+    case MOTEUR_TABLE:
+        return generation_suivante_table(jeu -> grille, jeu -> tampon, zone, statistiques, &(jeu -> regle));
+    default:
+        return generation_suivante(jeu -> grille, jeu -> tampon, zone, statistiques, &(jeu -> regle));
+    }
+}
+
+
+
+/**
+ * @brief Permet de savoir si une tuile doit être recalculée, i.e si elle ou une
+ * de ses 8 voisines a changé à la dernière génération.
+ * 
+ * @param tuiles Un pointeur sur les tuiles de la grille
+ * @param tx L'abscisse de la tuile
+ * @param ty L'ordonnée de la tuile
+ * @return char 1 si la tuile doit être recalculée, 0 sinon
+ */
+static char tuile_a_calculer(Tuiles *tuiles, unsigned int tx, unsigned int ty)
 {
     // + lisible
-    unsigned int taille = jeu -> grille -> taille;
-    cellule **matrice = jeu -> grille -> matrice;
-    Stats *statistiques = jeu -> statistiques;
-    
-    Grille *next_it = copie_grille(jeu -> grille);
-    statistiques -> en_vie = 0;
-    statistiques -> nb_cell_originelles = 0;
-    
-    /* On va compter le nombre de voisin pour chaque cellule et en
-    déduire l'état de la cellule à l'itération suivante */
-    char tmp_voisins;
-    for (unsigned int i = 0; i < taille; i++)
+    unsigned int nb = tuiles -> nb;
+
+    unsigned int debut_x = tx > 0 ? tx - 1 : 0, fin_x = tx + 1 < nb ? tx + 1 : tx;
+    unsigned int debut_y = ty > 0 ? ty - 1 : 0, fin_y = ty + 1 < nb ? ty + 1 : ty;
+    for (unsigned int i = debut_y; i <= fin_y; i++)
     {
-        for (unsigned int j = 0; j < taille; j++)
+        for (unsigned int j = debut_x; j <= fin_x; j++)
         {
-            tmp_voisins = compte_voisin(jeu -> grille, i, j);
+            if (tuiles -> active[i * nb + j]) return 1;
+        }
+    }
+    return 0;
+}
+
 
-            // Si cellule morte et 3 voisins -> passe à vivante
-            if (tmp_voisins == 3 && !matrice[i][j])
+
+/**
+ * @brief Calcule la génération suivante de la bande de tuiles d'un thread.
+ * Les lignes de tuiles sont réparties en jeu -> nb_threads bandes.
+ * 
+ * Seules les tuiles actives ou voisines d'une tuile active sont recalculées.
+ * Les autres gardent leur état et leurs stats de la génération précédente.
+ * 
+ * @param contexte Un pointeur sur le Jeu
+ * @param indice Le numéro du thread (donc de la bande)
+ */
+static void calcule_bande(void *contexte, unsigned int indice)
+{
+    // + lisible
+    Jeu *jeu = (Jeu *) contexte;
+    Tuiles *tuiles = jeu -> tuiles;
+    unsigned int taille = jeu -> grille -> taille;
+    unsigned int nb = tuiles -> nb;
+    unsigned int nb_threads = jeu -> nb_threads;
+    char compte = (jeu -> niveau_stats != STATS_AUCUNES);
+    char referme = (jeu -> topologie != TOPOLOGIE_BORNEE);
+
+    unsigned int debut = (unsigned long int) nb * indice / nb_threads;
+    unsigned int fin = (unsigned long int) nb * (indice + 1) / nb_threads;
+
+    // Chaque thread a ses propres stats: pas besoin d'opérations atomiques
+    Stats *partielles = &(jeu -> stats_threads[indice].stats);
+    memset(partielles, 0, sizeof(Stats));
+    uint64_t debut_bande = debut_mesure(jeu -> mesures);
+
+    for (unsigned int ty = debut; ty < fin; ty++)
+    {
+        for (unsigned int tx = 0; tx < nb; tx++)
+        {
+            /* Dans une grille refermée, les tuiles du bord ont aussi des voisines de l'autre côté
+            (voir topologie.c) */
+            size_t t = (size_t) ty * nb + tx;
+            char bord = referme && (tx == 0 || ty == 0 || tx == nb - 1 || ty == nb - 1);
+            if (bord ? !tuile_bord_a_calculer(tuiles, jeu -> topologie, taille, tx, ty) : !tuile_a_calculer(tuiles, tx, ty))
             {
-                (next_it -> matrice)[i][j] = 1;
-                
-                // On met à jour les stats
-                statistiques -> nb_cell_nes += 1;
+                // Rien n'a pu changer: on reprend les stats du dernier calcul
+                tuiles -> prochaine[t] = 0;
+                if (!compte) continue;
+                partielles -> en_vie += tuiles -> en_vie[t];
+                partielles -> nb_cell_originelles += tuiles -> originelles[t];
+                continue;
             }
 
-            /* Si vivante et 2 ou 3 voisins -> elle reste vivante.
-            Dans tous les autres cas elle meurt*/
-            if (matrice[i][j])
+            // Les tuiles du bord droit et du bas peuvent être incomplètes
+            Zone zone;
+            zone.x = tx * TAILLE_TUILE;
+            zone.y = ty * TAILLE_TUILE;
+            zone.largeur = min_uint(TAILLE_TUILE, taille - zone.x);
+            zone.hauteur = min_uint(TAILLE_TUILE, taille - zone.y);
+
+            // Sans statistiques, les noyaux n'ont pas à les compter
+            partielles -> nb_tuiles_actives++;
+            if (!compte)
             {
-                // On met à jour les stats
-                statistiques -> en_vie += 1;
-                if (matrice[i][j] & (1 << 7)) statistiques -> nb_cell_originelles++;
-
-                /* On augmente l'âge de la cellule.
-                & 127 car 127 en binaire: 01111111 */
-                unsigned char age = (matrice[i][j] & 127) + 1;
-
-                /* Si l'age ne dépasse pas nos 7 bits on met à jour l'âge de la cellule
-                Si ça dépasse elle garde son âge actuel (127 générations) */
-                if (!(age & (1 << 7)))
-                {
-                    /* & (1 << 7) pour garder le 8ème bit servant à déterminer si une cellule
-                    est originelle ou non. */
-                    (next_it -> matrice)[i][j] = (matrice[i][j] & (1 << 7)) | age;
-                }
-
-                // On applique la règle du jeu de la vie
-                if (!(tmp_voisins == 2 || tmp_voisins == 3))
-                {
-                    (next_it -> matrice)[i][j] = 0;
-                    statistiques -> nb_cell_mortes += 1;
-                }
+                tuiles -> prochaine[t] = calcule_zone(jeu, &zone, NULL);
+                continue;
             }
+
+            Stats stats_tuile = {0};
+            tuiles -> prochaine[t] = calcule_zone(jeu, &zone, &stats_tuile);
+            tuiles -> en_vie[t] = stats_tuile.en_vie;
+            tuiles -> originelles[t] = stats_tuile.nb_cell_originelles;
+
+            partielles -> en_vie += stats_tuile.en_vie;
+            partielles -> nb_cell_originelles += stats_tuile.nb_cell_originelles;
+            partielles -> nb_cell_nes += stats_tuile.nb_cell_nes;
+            partielles -> nb_cell_mortes += stats_tuile.nb_cell_mortes;
         }
     }
 
-    // On libère l'ancienne grille et on la remplace par la nouvelle
-    free_grille(jeu -> grille);
-    jeu -> grille = next_it;
+    // La part de ce thread dans la génération (voir mesures.c)
+    fin_mesure(jeu -> mesures, PHASE_BANDE, indice, debut_bande);
+}
+
+
+
+/**
+ * @brief Additionne les statistiques partielles de chaque thread une fois la
+ * génération calculée.
+ * 
+ * @param jeu Un pointeur sur le Jeu concerné
+ */
+static void reduit_stats(Jeu *jeu)
+{
+    // + lisible
+    Stats *statistiques = jeu -> statistiques;
+
+    statistiques -> en_vie = 0;
+    statistiques -> nb_cell_originelles = 0;
+    statistiques -> nb_tuiles_actives = 0;
+    for (unsigned int i = 0; i < jeu -> nb_threads; i++)
+    {
+        Stats *partielles = &(jeu -> stats_threads[i].stats);
+        statistiques -> en_vie += partielles -> en_vie;
+        statistiques -> nb_cell_originelles += partielles -> nb_cell_originelles;
+        statistiques -> nb_cell_nes += partielles -> nb_cell_nes;
+        statistiques -> nb_cell_mortes += partielles -> nb_cell_mortes;
+        statistiques -> nb_tuiles_actives += partielles -> nb_tuiles_actives;
+    }
+}
+
+
+
+/**
+ * @brief Calcule l'itération suivante du jeu avec le moteur choisi (voir maj_grille()).
+ * 
+ * @param jeu Un pointeur sur le jeu à mettre à jour.
+ */
+static void avance_moteur(Jeu *jeu)
+{
+    // + lisible
+    char compte = (jeu -> niveau_stats != STATS_AUCUNES);
+
+    if (jeu -> moteur == MOTEUR_HASHLIFE)
+    {
+        /* Génération par génération, la population est celle d'avant le calcul, comme pour les autres
+        moteurs. Un saut peut couvrir des millions de générations: c'est alors celle d'après le saut. */
+        if (compte && jeu -> saut == 1) jeu -> statistiques -> en_vie = population_hashlife(jeu -> hashlife);
+        avance_hashlife(jeu -> hashlife, jeu -> saut);
+        if (compte && jeu -> saut != 1) jeu -> statistiques -> en_vie = population_hashlife(jeu -> hashlife);
+        jeu -> statistiques -> nb_cell_originelles = 0;
+        jeu -> statistiques -> generations += jeu -> saut;
+        jeu -> grille_obsolete = 1;
+        return;
+    }
+
+    // Le moteur univers ne calcule que les blocs où il y a de la vie (voir univers.c)
+    if (jeu -> moteur == MOTEUR_UNIVERS)
+    {
+        Stats partielles = {0};
+        maj_univers(jeu -> univers, &(jeu -> regle), compte ? &partielles : NULL, (jeu -> cycles != NULL) ? &jeu -> cycles -> empreinte : NULL);
+        jeu -> statistiques -> en_vie = partielles.en_vie;
+        jeu -> statistiques -> nb_cell_originelles = partielles.nb_cell_originelles;
+        jeu -> statistiques -> nb_cell_nes += partielles.nb_cell_nes;
+        jeu -> statistiques -> nb_cell_mortes += partielles.nb_cell_mortes;
+        jeu -> statistiques -> nb_tuiles_actives = partielles.nb_tuiles_actives;
+        jeu -> statistiques -> generations++;
+        jeu -> grille_obsolete = 1;
+        return;
+    }
+
+    /* Avec B0, les cellules mortes sans voisin naissent: une tuile vide peut changer
+    sans que ses voisines aient changé, on recalcule donc toutes les tuiles. */
+    if (dans_masque(jeu -> regle.naissance, 0)) active_tuiles(jeu -> tuiles);
+
+    /* On ne suit l'âge des cellules que si on en a besoin pour la couleur.
+    Si on change d'avis, les plans d'âge sont réinitialisés: on recalcule tout. */
+    if (jeu -> moteur == MOTEUR_BITBOARD && suivi_age_bitgrille(jeu -> bitgrille, jeu -> estCouleur))
+    {
+        active_tuiles(jeu -> tuiles);
+    }
+
+    // Dans une grille refermée, la bordure reçoit le bord opposé (voir topologie.c)
+    if (jeu -> topologie != TOPOLOGIE_BORNEE)
+    {
+        if (jeu -> moteur == MOTEUR_BITBOARD) maj_bordure_bitgrille(jeu -> bitgrille, jeu -> topologie);
+        else maj_bordure_grille(jeu -> grille, jeu -> topologie);
+    }
+
+    if (jeu -> pool != NULL) execute_pool(jeu -> pool, calcule_bande, jeu);
+    else calcule_bande(jeu, 0);
+    reduit_stats(jeu);
+    jeu -> statistiques -> generations++;
+
+    // Les tuiles qui viennent de changer deviennent les tuiles actives
+    unsigned char *tmp_tuiles = jeu -> tuiles -> active;
+    jeu -> tuiles -> active = jeu -> tuiles -> prochaine;
+    jeu -> tuiles -> prochaine = tmp_tuiles;
+
+    // Le moteur bitboard travaille sur sa propre grille
+    if (jeu -> moteur == MOTEUR_BITBOARD)
+    {
+        if (jeu -> topologie != TOPOLOGIE_BORNEE) vide_bordure_bitgrille(jeu -> bitgrille);
+        echange_bitgrille(jeu -> bitgrille);
+        jeu -> grille_obsolete = 1;
+        return;
+    }
+
+    // On échange les 2 grilles: la nouvelle devient la grille courante
+    Grille *tmp = jeu -> grille;
+    jeu -> grille = jeu -> tampon;
+    jeu -> tampon = tmp;
+}
+
+
+
+/**
+ * @brief Calcule l'itération suivante du jeu avec le moteur choisi.
+ * 
+ * Pour les moteurs scalaire et simd, le jeu possède 2 grilles qui échangent leur rôle à
+ * chaque génération: on écrit l'itération suivante dans jeu -> tampon, puis
+ * elle devient jeu -> grille. Aucune allocation n'est faite ici.
+ * 
+ * Si plusieurs threads sont demandés, chacun calcule une bande de lignes de la
+ * grille (les résultats sont identiques à ceux obtenus avec un seul thread).
+ * 
+ * Seules les tuiles où il s'est passé quelque chose sont recalculées (voir Tuiles).
+ * 
+ * Le moteur hashlife avance de jeu -> saut générations d'un coup. Il ne suit ni
+ * les naissances, ni les morts, ni les cellules originelles: seule la population
+ * est mise à jour.
+ * 
+ * Le moteur univers calcule tout l'univers non borné (la grille n'en est qu'une fenêtre).
+ * 
+ * Avec STATS_AUCUNES, seul le numéro de génération est mis à jour. Avec
+ * STATS_GENERATION, les chiffres de la génération sont ajoutés au journal.
+ * Avec l'instrumentation, la durée de la génération et celle de chaque
+ * bande sont mesurées (voir mesures.c).
+ *
+ * @param jeu Un pointeur sur le jeu à mettre à jour.
+ */
+void maj_grille(Jeu *jeu)
+{
+    uint64_t debut = debut_mesure(jeu -> mesures);
+    avance_moteur(jeu);
+
+    // On cherche si la configuration est déjà passée par cet état (voir cycles.c)
+    if (jeu -> cycles != NULL) maj_cycles(jeu);
+
+    // Les statistiques de chaque génération sont écrites dans le journal
+    if (jeu -> journal != NULL) ecrit_journal(jeu -> journal, jeu -> statistiques);
+    fin_mesure(jeu -> mesures, PHASE_GENERATION, 0, debut);
 }
 
+
+
+/**
+ * @brief Prépare le moteur choisi avant de lancer la simulation: la
+ * configuration initiale (saisie dans jeu -> grille) est chargée dans la
+ * représentation utilisée par le moteur.
+ * 
+ * @param jeu Un pointeur sur le jeu concerné
+ */
+void init_moteur(Jeu *jeu)
+{
+    // Dans un univers non borné, une règle avec B0 ferait naître une infinité de cellules
+    if ((jeu -> moteur == MOTEUR_HASHLIFE || jeu -> moteur == MOTEUR_UNIVERS) && dans_masque(jeu -> regle.naissance, 0))
+    {
+        quitter("Les moteurs hashlife et univers ne gèrent pas les règles avec B0\n", 1);
+    }
+    if ((jeu -> moteur == MOTEUR_HASHLIFE || jeu -> moteur == MOTEUR_UNIVERS) && jeu -> topologie != TOPOLOGIE_BORNEE)
+    {
+        quitter("Les moteurs hashlife et univers ne sont pas bornés: ils n'ont pas de bord à refermer\n", 1);
+    }
+
+    // Les moteurs hashlife et univers n'utilisent ni threads, ni tuiles, et ne sont pas bornés
+    if (jeu -> moteur == MOTEUR_HASHLIFE)
+    {
+        if (jeu -> hashlife == NULL) jeu -> hashlife = init_hashlife(jeu -> budget_hashlife, &(jeu -> regle));
+        grille2hashlife(jeu -> grille, jeu -> hashlife);
+        jeu -> cam -> est_bornee = 0;
+        jeu -> grille_obsolete = 0;
+        return;
+    }
+    if (jeu -> moteur == MOTEUR_UNIVERS)
+    {
+        if (jeu -> univers == NULL) jeu -> univers = init_univers();
+        grille2univers(jeu -> grille, jeu -> univers, 0, 0);
+        jeu -> cam -> est_bornee = 0;
+        jeu -> grille_obsolete = 0;
+        return;
+    }
+
+    // Les stats partielles et les threads de calcul
+    if (jeu -> stats_threads == NULL)
+    {
+        jeu -> stats_threads = (StatsThread *) aligned_alloc(_Alignof(StatsThread), sizeof(StatsThread) * jeu -> nb_threads);
+        if (jeu -> stats_threads == NULL) quitter("Impossible d'allouer de la mémoire pour les stats des threads\n", 2);
+    }
+    if (jeu -> nb_threads > 1 && jeu -> pool == NULL) jeu -> pool = init_pool(jeu -> nb_threads);
+
+    // Au départ, toute la grille doit être calculée
+    if (jeu -> tuiles == NULL) jeu -> tuiles = init_tuiles(jeu -> grille -> taille);
+    active_tuiles(jeu -> tuiles);
+
+    // Les moteurs scalaire et simd ont besoin d'une 2ème grille pour écrire l'itération suivante
+    if (jeu -> moteur != MOTEUR_BITBOARD)
+    {
+        if (jeu -> tampon == NULL) jeu -> tampon = init_grille(jeu -> grille -> taille);
+        return;
+    }
+
+    if (jeu -> bitgrille == NULL) jeu -> bitgrille = init_bitgrille(jeu -> grille -> taille);
+    suivi_age_bitgrille(jeu -> bitgrille, jeu -> estCouleur);
+    grille2bitgrille(jeu -> grille, jeu -> bitgrille);
+    jeu -> grille_obsolete = 0;
+}
+
+
+
+/**
+ * @brief Met à jour jeu -> grille à partir de la représentation du moteur si
+ * besoin (par exemple avant l'affichage).
+ * 
+ * Avec les moteurs non bornés, la grille n'est qu'une fenêtre sur l'univers:
+ * elle commence là où se trouve la caméra.
+ * 
+ * @param jeu Un pointeur sur le jeu concerné
+ */
+void synchronise_grille(Jeu *jeu)
+{
+    // + lisible
+    Camera *cam = jeu -> cam;
+
+    if (!(cam -> est_bornee) && (jeu -> fenetre_x != cam -> origin_x || jeu -> fenetre_y != cam -> origin_y))
+    {
+        jeu -> fenetre_x = cam -> origin_x;
+        jeu -> fenetre_y = cam -> origin_y;
+        jeu -> grille_obsolete = 1;
+    }
+    if (!(jeu -> grille_obsolete)) return;
+
+    switch (jeu -> moteur)
+    {
+    case MOTEUR_HASHLIFE:
+        hashlife2grille(jeu -> hashlife, jeu -> grille, jeu -> fenetre_x, jeu -> fenetre_y);
+        break;
+    case MOTEUR_UNIVERS:
+        univers2grille(jeu -> univers, jeu -> grille, jeu -> fenetre_x, jeu -> fenetre_y);
+        break;
+    default:
+        bitgrille2grille(jeu -> bitgrille, jeu -> grille);
+        break;
+    }
+    jeu -> grille_obsolete = 0;
+}
+
+
+
+/**
+ * @brief Compte les cellules originelles de la configuration actuelle (les
+ * moteurs ne les comptent qu'avant de calculer une génération, voir Stats).
+ * Le moteur hashlife ne les suit pas: retourne 0.
+ * 
+ * @param jeu Un pointeur sur le jeu concerné
+ * @return unsigned long int Le nombre de cellules originelles
+ */
+unsigned long int compte_originelles(Jeu *jeu)
+{
+    if (jeu -> moteur == MOTEUR_HASHLIFE) return 0;
+    if (jeu -> moteur == MOTEUR_UNIVERS) return originelles_univers(jeu -> univers);
+
+    synchronise_grille(jeu);
+    unsigned long int originelles = 0;
+    for (unsigned int i = 0; i < jeu -> grille -> taille; i++)
+    {
+        for (unsigned int j = 0; j < jeu -> grille -> taille; j++) originelles += CELLULE(jeu -> grille, i, j) >> 7;
+    }
+    return originelles;
+}
+
+
+
+/**
+ * @brief Marque toutes les tuiles comme actives: elles seront toutes
+ * recalculées à la génération suivante.
+ * 
+ * @param tuiles Un pointeur sur les tuiles concernées
+ */
+void active_tuiles(Tuiles *tuiles)
+{
+    memset(tuiles -> active, 1, (size_t) tuiles -> nb * tuiles -> nb);
+}
@@ -11,11 +11,95 @@
 #define _GNU_SOURCE
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
 #include <SDL2/SDL.h>
 #include "utilitaires.h"
 #include "logique.h"
 #include "affichage.h"
 #include "types.h"
+#include "simd.h"
+#include "table.h"
+#include "palette.h"
+#include "simulation.h"
+#include "sauvegarde.h"
+#include "journal.h"
+#include "cycles.h"
+#include "recherche.h"
+#include "regle.h"
+#include "topologie.h"
+#include "soupe.h"
+#include "mesures.h"
+
+
+
+
+/**
+ * @brief Lance la simulation sans affichage (et sans SDL): on calcule les
+ * générations le plus vite possible, puis on affiche les statistiques et le
+ * débit obtenu.
+ * 
+ * @param jeu Un pointeur sur le jeu, dont le moteur est déjà initialisé
+ * @param nb_generations Le numéro de la dernière génération à calculer (une
+ * partie reprise continue jusqu'à ce numéro)
+ */
+static void lance_headless(Jeu *jeu, unsigned long int nb_generations)
+{
+    // + lisible
+    Stats *statistiques = jeu -> statistiques;
+    unsigned long int depart = statistiques -> generations;
+    char saute = 0;
+
+    // Le jeu de la vie n'est pas rappelé
+    if (jeu -> regle.type != REGLE_VIE)
+    {
+        char regle[24];
+        ecrit_regle(&(jeu -> regle), regle);
+        printf("Règle: %s\n", regle);
+    }
+    if (jeu -> topologie != TOPOLOGIE_BORNEE) printf("Topologie: %s\n", nom_topologie(jeu -> topologie));
+
+    struct timespec debut, fin;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    while (statistiques -> generations < nb_generations)
+    {
+        // Le moteur hashlife ne doit pas dépasser le nombre de générations demandé
+        unsigned long int restantes = nb_generations - statistiques -> generations;
+        if (jeu -> saut > restantes) jeu -> saut = restantes;
+        maj_grille(jeu);
+        sauvegarde_periodique(jeu);
+
+        // Une fois la configuration périodique, on connaît directement la dernière génération (voir --cycles)
+        if (jeu -> cycles != NULL && statistiques -> periode && statistiques -> generations < nb_generations)
+        {
+            printf("Cycle de période %lu détecté à la génération %lu\n", statistiques -> periode, statistiques -> generations);
+            saute_generations(jeu, nb_generations);
+            saute = 1;
+        }
+    }
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+
+    double duree = (fin.tv_sec - debut.tv_sec) + (fin.tv_nsec - debut.tv_nsec) * 1e-9;
+    double taille = jeu -> grille -> taille;
+    double calculees = (statistiques -> generations > depart) ? statistiques -> generations - depart : 0;
+    if (jeu -> niveau_stats != STATS_AUCUNES) affiche_stats(statistiques);
+    else printf("%lu générations calculées (statistiques désactivées)\n", statistiques -> generations);
+
+    /* Le nombre de cellules mises à jour n'a de sens que si chaque génération a été calculée sur toute la
+    grille: ni univers sans limite (hashlife, univers), ni générations sautées (voir --cycles) */
+    if (jeu -> moteur != MOTEUR_HASHLIFE && jeu -> moteur != MOTEUR_UNIVERS && !saute)
+    {
+        printf("  - %.3f s de calcul: %.1f générations/s, %.3e cellules mises à jour/s (grille de %ux%u)\n",
+               duree, calculees / duree, taille * taille * calculees / duree, jeu -> grille -> taille, jeu -> grille -> taille);
+    }
+    else printf("  - %.3f s de calcul: %.1f générations/s%s\n", duree, calculees / duree, saute ? " (générations sautées comprises)" : "");
+    if (jeu -> mesures != NULL) affiche_mesures(jeu -> mesures);
+
+    if (jeu -> fichier_sauvegarde != NULL && ecrit_sauvegarde(jeu -> fichier_sauvegarde, jeu))
+    {
+        printf("Sauvegarde écrite dans %s\n", jeu -> fichier_sauvegarde);
+    }
+}
 
 
 
@@ -23,15 +107,284 @@
 int main(int argc, char **argv)
 {
     // On vérifie les arguments
-    if (!(argc == 2 && strlen(argv[1]) == 2 && argv[1][0] == '-'))
+    char headless = argc >= 2 && !strcmp(argv[1], "--headless");
+    char recherche = argc >= 2 && !strcmp(argv[1], "--recherche");
+    if (!headless && !recherche && !(argc >= 2 && strlen(argv[1]) == 2 && argv[1][0] == '-'))
     {
         affiche_aide();
     }
 
-    unsigned int taille_max = min_uint(largeur_f, hauteur_f);
+    // Puis les options éventuelles
+    Moteur moteur = MOTEUR_BITBOARD;
+    unsigned int nb_threads = 1;
+    const char *isa = NULL;
+    unsigned int saut = 1;
+    unsigned int memoire_hashlife = 512;
+    Palette palette = PALETTE_SPECTRE;
+    Cadence cadence = CADENCE_DELAI;
+    unsigned int budget_ms = 10;
+    const char *fichier_sauvegarde = NULL;
+    unsigned int sauvegarde_tous = 0;
+    const char *reprise = NULL;
+    NiveauStats niveau_stats = STATS_TOTAUX;
+    const char *fichier_stats = "statistiques.csv";
+    char cycles = 0;
+    char mesures = 0;
+    const char *fichier_trace = NULL;
+    Regle regle = regle_vie();
+    Topologie topologie = TOPOLOGIE_BORNEE;
+
+    // Options du mode headless (et de la recherche de soupes)
+    unsigned int taille = 800, nb_generations = 1000;
+    char taille_choisie = 0, generations_choisies = 0, threads_choisis = 0;
+    const char *fichier = NULL;
+    int x = 0, y = 0;
 
-    // On demande à l'utilisateur la taille n de la grille
-    unsigned int n = get_uint("Quelle taille pour la grille ?");
+    // La configuration aléatoire (et les soupes de la recherche): une cellule sur 2 par défaut
+    Soupe soupe = {(uint64_t) time(NULL), DENSITE_MAX / 2, SYMETRIE_AUCUNE};
+
+    // Options de la recherche de soupes
+    unsigned int nb_soupes = 1000;
+    const char *fichier_resultats = "soupes.csv";
+    for (int i = 2; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "--moteur") && i + 1 < argc)
+        {
+            i++;
+            if (!strcmp(argv[i], "bitboard")) moteur = MOTEUR_BITBOARD;
+            else if (!strcmp(argv[i], "scalaire")) moteur = MOTEUR_SCALAIRE;
+            else if (!strcmp(argv[i], "simd")) moteur = MOTEUR_SIMD;
+            else if (!strcmp(argv[i], "hashlife")) moteur = MOTEUR_HASHLIFE;
+            else if (!strcmp(argv[i], "univers")) moteur = MOTEUR_UNIVERS;
+            else if (!strcmp(argv[i], "table")) moteur = MOTEUR_TABLE;
+            else affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--simd") && i + 1 < argc)
+        {
+            isa = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &nb_threads) || nb_threads == 0) affiche_aide();
+            threads_choisis = 1;
+        }
+        else if (!strcmp(argv[i], "--saut") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &saut) || saut == 0) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--hashlife-memoire") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &memoire_hashlife) || memoire_hashlife == 0) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--palette") && i + 1 < argc)
+        {
+            i++;
+            if (!strcmp(argv[i], "spectre")) palette = PALETTE_SPECTRE;
+            else if (!strcmp(argv[i], "chaleur")) palette = PALETTE_CHALEUR;
+            else if (!strcmp(argv[i], "origine")) palette = PALETTE_ORIGINE;
+            else affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--cadence") && i + 1 < argc)
+        {
+            i++;
+            if (!strcmp(argv[i], "delai")) cadence = CADENCE_DELAI;
+            else if (!strcmp(argv[i], "image")) cadence = CADENCE_IMAGE;
+            else if (!strcmp(argv[i], "max")) cadence = CADENCE_MAX;
+            else affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--budget-image") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &budget_ms) || budget_ms == 0) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--sauvegarde") && i + 1 < argc)
+        {
+            fichier_sauvegarde = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--sauvegarde-tous") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &sauvegarde_tous)) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--reprise") && i + 1 < argc)
+        {
+            reprise = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--stats") && i + 1 < argc)
+        {
+            i++;
+            if (!strcmp(argv[i], "aucunes")) niveau_stats = STATS_AUCUNES;
+            else if (!strcmp(argv[i], "totaux")) niveau_stats = STATS_TOTAUX;
+            else if (!strcmp(argv[i], "generation")) niveau_stats = STATS_GENERATION;
+            else affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--stats-fichier") && i + 1 < argc)
+        {
+            fichier_stats = argv[++i];
+        }
+        else if (!strcmp(argv[i], "--regle") && i + 1 < argc)
+        {
+            if (!lit_regle(argv[++i], &regle)) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--topologie") && i + 1 < argc)
+        {
+            if (!lit_topologie(argv[++i], &topologie)) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--graine") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint64(argv[i], &soupe.graine)) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--densite") && i + 1 < argc)
+        {
+            // En pourcentage, arrondi au 65536ème le plus proche
+            unsigned int pourcentage;
+            i++;
+            if (!string2uint(argv[i], &pourcentage) || pourcentage > 100) affiche_aide();
+            soupe.densite = (pourcentage * DENSITE_MAX + 50) / 100;
+        }
+        else if (!strcmp(argv[i], "--symetrie") && i + 1 < argc)
+        {
+            if (!lit_symetrie(argv[++i], &soupe.symetrie)) affiche_aide();
+        }
+        else if (!strcmp(argv[i], "--cycles"))
+        {
+            cycles = 1;
+        }
+        else if (!strcmp(argv[i], "--mesures"))
+        {
+            mesures = 1;
+        }
+        else if (!strcmp(argv[i], "--trace") && i + 1 < argc)
+        {
+            fichier_trace = argv[++i];
+            mesures = 1;
+        }
+        else if (!strcmp(argv[i], "--taille") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &taille) || taille == 0) affiche_aide();
+            taille_choisie = 1;
+        }
+        else if ((headless || recherche) && !strcmp(argv[i], "--generations") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &nb_generations)) affiche_aide();
+            generations_choisies = 1;
+        }
+        else if (headless && !strcmp(argv[i], "--fichier") && i + 1 < argc)
+        {
+            fichier = argv[++i];
+        }
+        else if (headless && !strcmp(argv[i], "--x") && i + 1 < argc)
+        {
+            i++;
+            if (!string2int(argv[i], &x) || x < 0) affiche_aide();
+        }
+        else if (headless && !strcmp(argv[i], "--y") && i + 1 < argc)
+        {
+            i++;
+            if (!string2int(argv[i], &y) || y < 0) affiche_aide();
+        }
+        else if (recherche && !strcmp(argv[i], "--soupes") && i + 1 < argc)
+        {
+            i++;
+            if (!string2uint(argv[i], &nb_soupes) || nb_soupes == 0) affiche_aide();
+        }
+        else if (recherche && !strcmp(argv[i], "--resultats") && i + 1 < argc)
+        {
+            fichier_resultats = argv[++i];
+        }
+        else affiche_aide();
+    }
+
+    // Le moteur hashlife ne suit ni les naissances, ni les morts, ni les cellules originelles
+    if (niveau_stats == STATS_GENERATION && moteur == MOTEUR_HASHLIFE)
+    {
+        quitter("Le moteur hashlife ne suit pas les naissances et les morts: '--stats generation' n'est pas disponible\n", 1);
+    }
+
+    /* La recherche de soupes calcule des milliers de petites grilles, sur tous les coeurs par défaut.
+    Chaque soupe est abandonnée si elle ne s'est pas stabilisée après nb_generations. */
+    if (recherche)
+    {
+        if (moteur == MOTEUR_SIMD) init_simd(isa);
+        if (moteur == MOTEUR_TABLE) init_table(&regle);
+        if (!taille_choisie) taille = 128;
+        if (!generations_choisies) nb_generations = 20000;
+        if (!threads_choisis && sysconf(_SC_NPROCESSORS_ONLN) > 1) nb_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+        Recherche *soupes = init_recherche(moteur, regle, topologie, taille, nb_soupes, nb_generations, soupe, fichier_resultats);
+        lance_recherche(soupes, nb_threads);
+        printf("Résultats ajoutés à %s\n", fichier_resultats);
+        free_recherche(soupes);
+        return 0;
+    }
+
+    // Une partie reprise garde la taille de sa grille
+    if (reprise != NULL)
+    {
+        taille = taille_sauvegarde(reprise);
+        if (taille == 0) quitter("Ce fichier n'est pas une sauvegarde valide\n", 1);
+    }
+
+    // Le mode headless n'utilise ni SDL, ni le terminal: tout est donné en argument
+    if (headless)
+    {
+        if (moteur == MOTEUR_SIMD) init_simd(isa);
+        if (moteur == MOTEUR_TABLE) init_table(&regle);
+
+        Jeu *jeu = init_jeu(taille, taille, taille);
+        jeu -> moteur = moteur;
+        jeu -> nb_threads = nb_threads;
+        jeu -> saut = saut;
+        jeu -> budget_hashlife = (size_t) memoire_hashlife << 20;
+        jeu -> fichier_sauvegarde = fichier_sauvegarde;
+        jeu -> sauvegarde_tous = sauvegarde_tous;
+        jeu -> niveau_stats = niveau_stats;
+        jeu -> regle = regle;
+        jeu -> topologie = topologie;
+
+        // Une sauvegarde, un fichier, ou une configuration aléatoire (reproductible avec la graine)
+        if (reprise != NULL)
+        {
+            if (!charge_sauvegarde(reprise, jeu)) quitter("Impossible de reprendre la partie\n", 1);
+            printf("Reprise à la génération %lu\n", jeu -> statistiques -> generations);
+        }
+        else
+        {
+            if (fichier != NULL)
+            {
+                if (!file2grid(fichier, jeu, x, y)) quitter("Impossible de charger le fichier à ces coordonnées\n", 1);
+            }
+            else
+            {
+                affiche_soupe(&soupe);
+                init_aleatoire(jeu, &soupe);
+            }
+            jeu -> statistiques -> nb_cell_originelles = jeu -> statistiques -> nb_cellules_depart;
+            jeu -> statistiques -> en_vie = jeu -> statistiques -> nb_cellules_depart;
+            init_moteur(jeu);
+        }
+
+        if (niveau_stats == STATS_GENERATION) jeu -> journal = ouvre_journal(fichier_stats, jeu -> statistiques);
+        if (cycles) jeu -> cycles = init_cycles(jeu);
+        if (mesures) jeu -> mesures = init_mesures(jeu -> nb_threads, fichier_trace);
+        lance_headless(jeu, nb_generations);
+        free_jeu(jeu);
+        return 0;
+    }
+
+    /* La grille a la taille de la zone d'affichage, sauf si on en choisit une autre (ou pour une partie reprise):
+    plus grande, on dézoome jusqu'à plusieurs cellules par pixel (voir dessine_grille()) */
+    unsigned int pixels = min_uint(largeur_f, hauteur_f);
+    unsigned int taille_max = (taille_choisie || reprise != NULL) ? taille : pixels;
+
+    // On demande à l'utilisateur la taille n de la partie visible de la grille (sauf pour une partie reprise)
+    unsigned int n = (reprise != NULL) ? taille : get_uint("Quelle taille pour la grille ?");
     if (n > taille_max) n = taille_max;
 
     // Et s'il veut un nombre de tour limite
@@ -44,11 +397,44 @@ int main(int argc, char **argv)
         return 1;
     }
 
-    Jeu *jeu = init_jeu(n, largeur_f, hauteur_f);
+    // Le moteur simd choisit le meilleur jeu d'instructions disponible (sauf si imposé), le moteur table construit sa table
+    if (moteur == MOTEUR_SIMD) init_simd(isa);
+    if (moteur == MOTEUR_TABLE) init_table(&regle);
 
+    // Les couleurs de l'affichage sont calculées une fois pour toutes
+    init_palettes();
 
-    // On utilise l'initialisation choisie par l'utilisateur
-    if (argv[1][1] == 'f')
+    Jeu *jeu = init_jeu(n, taille_max, taille_max);
+    jeu -> cam -> pixels = pixels;
+    if (n <= pixels) jeu -> largeur_cell = pixels / n;
+    else
+    {
+        // Plus de cellules que de pixels: on part du zoom le plus proche (voir regle_zoom()), centré dans la grille
+        regle_zoom(jeu, n);
+        jeu -> cam -> origin_x = jeu -> cam -> centre_x - (jeu -> cam -> width / 2);
+        jeu -> cam -> origin_y = jeu -> cam -> centre_y - (jeu -> cam -> width / 2);
+        update_camera(jeu -> cam);
+    }
+    jeu -> moteur = moteur;
+    jeu -> nb_threads = nb_threads;
+    jeu -> saut = saut;
+    jeu -> budget_hashlife = (size_t) memoire_hashlife << 20;
+    jeu -> palette = palette;
+    jeu -> cadence = cadence;
+    jeu -> budget_ms = budget_ms;
+    jeu -> fichier_sauvegarde = fichier_sauvegarde;
+    jeu -> sauvegarde_tous = sauvegarde_tous;
+    jeu -> niveau_stats = niveau_stats;
+    jeu -> regle = regle;
+    jeu -> topologie = topologie;
+
+
+    // On utilise l'initialisation choisie par l'utilisateur (une partie reprise n'a pas de configuration)
+    if (reprise != NULL)
+    {
+        init_fenetre(jeu);
+    }
+    else if (argv[1][1] == 'f')
     {
         init_fichier(jeu);
     }
@@ -58,7 +444,7 @@ int main(int argc, char **argv)
     }
     else if (argv[1][1] == 'r')
     {
-        init_rdm(jeu);
+        init_rdm(jeu, &soupe);
     }
     else    // Peu importe la lettre même si pas -g on lance avec le GUI
     {
@@ -73,47 +459,95 @@ int main(int argc, char **argv)
     Je change le titre de la fenetre au cas où SDL_asprintf ne soit pas défini sur vos machines */
     SDL_SetWindowTitle(jeu -> fenetre, "Game of Life (asprintf() non définie sur votre machine)");
 
-    // On met à jour les stats et on affiche les commandes.
-    jeu -> statistiques->nb_cell_originelles = jeu -> statistiques -> nb_cellules_depart;
-    jeu -> statistiques -> en_vie = jeu -> statistiques -> nb_cellules_depart;
+    // On met à jour les stats (les commandes sont affichées une fois le moteur prêt)
+    if (reprise == NULL)
+    {
+        jeu -> statistiques->nb_cell_originelles = jeu -> statistiques -> nb_cellules_depart;
+        jeu -> statistiques -> en_vie = jeu -> statistiques -> nb_cellules_depart;
+    }
+
+    // On charge la configuration initiale (ou la sauvegarde) dans le moteur choisi
+    if (reprise == NULL) init_moteur(jeu);
+    else if (!charge_sauvegarde(reprise, jeu)) quitter("Impossible de reprendre la partie\n", 1);
+    if (niveau_stats == STATS_GENERATION) jeu -> journal = ouvre_journal(fichier_stats, jeu -> statistiques);
+    if (cycles) jeu -> cycles = init_cycles(jeu);
+    if (mesures) jeu -> mesures = init_mesures(jeu -> nb_threads, fichier_trace);
     affiche_commandes(jeu, 0);
 
+    /* Les générations sont calculées sur un autre thread (voir simulation.c):
+    la boucle de jeu ne fait que gérer les évènements et afficher la dernière génération reçue. */
+    Simulation *sim = lance_simulation(jeu, nb_tours);
+
+    // Le nombre de générations par seconde est mesuré toutes les demi-secondes
+    Uint64 frequence = SDL_GetPerformanceFrequency();
+    Uint64 debut_debit = SDL_GetPerformanceCounter();
+    unsigned long int generations_debit = jeu -> statistiques -> generations;
+    double generations_par_s = 0;
+
     // On lance la boucle de jeu
     char gameloop = 1;
-    unsigned long int generation = 0;
     while (gameloop)
     {   
+        uint64_t debut_image = debut_mesure(jeu -> mesures);
+        Uint64 maintenant = SDL_GetPerformanceCounter();
+        if (maintenant - debut_debit >= frequence / 2)
+        {
+            generations_par_s = (double) (jeu -> statistiques -> generations - generations_debit) * frequence / (maintenant - debut_debit);
+            generations_debit = jeu -> statistiques -> generations;
+            debut_debit = maintenant;
+        }
+
+        // La cadence choisie, pour le titre de la fenêtre
+        char cadence_str[128];
+        if (jeu -> cadence == CADENCE_DELAI) snprintf(cadence_str, sizeof(cadence_str), "Délai: %ums", jeu -> delay_ms);
+        else if (jeu -> cadence == CADENCE_IMAGE) snprintf(cadence_str, sizeof(cadence_str), "Calcul: %ums/image", jeu -> budget_ms);
+        else snprintf(cadence_str, sizeof(cadence_str), "Vitesse max");
+
+        // La période, une fois le cycle détecté
+        if (jeu -> statistiques -> periode)
+        {
+            size_t longueur = strlen(cadence_str);
+            snprintf(cadence_str + longueur, sizeof(cadence_str) - longueur, ", Période: %lu", jeu -> statistiques -> periode);
+        }
+
+        // La génération en cours de saisie (touche 'a')
+        if (jeu -> saisie_active)
+        {
+            size_t longueur = strlen(cadence_str);
+            snprintf(cadence_str + longueur, sizeof(cadence_str) - longueur, ", Aller à: %lu_", jeu -> generation_saisie);
+        }
+
         /* Je pense avoir réussi à détecter si asprintf était défini.
         Si ça ne marche pas, supprimez les 6 lignes suivantes. */
         char *gen_nb_str;
-        asprintf(&gen_nb_str, "Game of Life: Génération n°%lu    (Délai: %ums)", generation, jeu -> delay_ms);
+        if (jeu -> moteur == MOTEUR_HASHLIFE)
+            asprintf(&gen_nb_str, "Game of Life: Génération n°%lu    (%.0f gen/s, %s, Saut: %lu)", jeu -> statistiques -> generations, generations_par_s, cadence_str, jeu -> saut);
+        else
+            asprintf(&gen_nb_str, "Game of Life: Génération n°%lu    (%.0f gen/s, %s)", jeu -> statistiques -> generations, generations_par_s, cadence_str);
         SDL_SetWindowTitle(jeu -> fenetre, gen_nb_str);
         free(gen_nb_str);
         
-        // On regarde les évènements (touches pressées etc)
+        // On regarde les évènements (touches pressées etc) et on les transmet à la simulation
+        uint64_t debut_evenements = debut_mesure(jeu -> mesures);
         SDL_Event event;
         watch_events(&event, jeu, &gameloop, 0);
+        update_camera(jeu -> cam);
+        publie_commandes(sim, jeu);
+        fin_mesure(jeu -> mesures, PHASE_EVENEMENTS, 0, debut_evenements);
 
-        jeu -> estPause = (nb_tours != -1) ? (jeu -> estPause || generation > nb_tours - 1) : jeu -> estPause;
-
-        // Si le jeu n'est pas en pause on calcule l'itération suivante
-        if (!(jeu -> estPause))
-        {
-            // On calcule l'état du jeu
-            maj_grille(jeu);
-            generation++;
-        }
-
-        affiche_grille(jeu);
-
-        // On attend X ms avant de passer à l'itération suivante
-        SDL_Delay(jeu -> delay_ms);
+        // On affiche la dernière génération calculée (l'attente de la synchro verticale rythme la boucle)
+        image_suivante(sim, jeu);
+        dessine_grille(jeu);
+        fin_mesure(jeu -> mesures, PHASE_IMAGE, 0, debut_image);
     }
-    jeu -> statistiques -> generations = generation;
 
+    arrete_simulation(sim, jeu);
+    if (jeu -> fichier_sauvegarde != NULL) ecrit_sauvegarde(jeu -> fichier_sauvegarde, jeu);
     SDL_Quit(); // On quitte la SDL
     system(CLEAR);
-    affiche_stats(jeu -> statistiques);
+    if (jeu -> niveau_stats != STATS_AUCUNES) affiche_stats(jeu -> statistiques);
+    else printf("%lu générations calculées (statistiques désactivées)\n", jeu -> statistiques -> generations);
+    if (jeu -> mesures != NULL) affiche_mesures(jeu -> mesures);
 
     // On libère toute la mémoire et on quitte.
     free_jeu(jeu);
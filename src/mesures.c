@@ -0,0 +1,410 @@
+/**
+ * @file mesures.c
+ * @author M3tex
+ * @brief Fichier contenant l'instrumentation: la durée de chaque phase de la
+ * boucle d'affichage (évènements, dessin, SDL_RenderPresent()), de chaque
+ * génération et de la part de chaque thread dans une génération.
+ *
+ * Chaque intervalle est mesuré avec l'horloge monotone (voir debut_mesure() et
+ * fin_mesure()) et rangé dans la Serie de sa phase: les NB_ECHANTILLONS
+ * dernières durées donnent les moyennes et les centiles affichés dans la
+ * fenêtre (voir dessine_hud()) ou à la fin de la partie. Si on le demande, les
+ * intervalles sont aussi écrits dans un fichier au format 'Chrome trace event'
+ * (à ouvrir avec chrome://tracing ou https://ui.perfetto.dev).
+ *
+ * Sans instrumentation, Jeu -> mesures vaut NULL: chaque point de mesure ne
+ * coûte qu'un test.
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <SDL2/SDL.h>
+#include "mesures.h"
+#include "utilitaires.h"
+
+
+// Taille d'un pixel de texte du HUD (en pixels de la fenêtre)
+#define ECHELLE_HUD 2
+
+// Largeur maximale d'une ligne du HUD (en caractères, la suite n'est pas dessinée)
+#define LARGEUR_LIGNE_HUD 64
+
+// Taille des lignes du HUD en mémoire (assez pour des durées aberrantes)
+#define TAILLE_LIGNE_HUD 512
+
+
+
+/**
+ * @brief Le résumé des dernières durées d'une Serie (en µs).
+ */
+typedef struct Resume {
+    unsigned long int nb;
+    unsigned int nb_echantillons;
+    double moyenne;
+    double p50;
+    double p95;
+    double p99;
+    double max;
+} Resume;
+
+/* La police du HUD: 3 x 5 pixels par caractère, une ligne par octet (bit 2 pour
+la colonne de gauche, bit 0 pour celle de droite). Les minuscules sont affichées
+en majuscules, les caractères absents sont des espaces. */
+static const uint8_t police[128][5] = {
+    ['0'] = {7, 5, 5, 5, 7}, ['1'] = {2, 6, 2, 2, 7}, ['2'] = {7, 1, 7, 4, 7}, ['3'] = {7, 1, 7, 1, 7},
+    ['4'] = {5, 5, 7, 1, 1}, ['5'] = {7, 4, 7, 1, 7}, ['6'] = {7, 4, 7, 5, 7}, ['7'] = {7, 1, 1, 1, 1},
+    ['8'] = {7, 5, 7, 5, 7}, ['9'] = {7, 5, 7, 1, 7},
+    ['A'] = {2, 5, 7, 5, 5}, ['B'] = {6, 5, 6, 5, 6}, ['C'] = {3, 4, 4, 4, 3}, ['D'] = {6, 5, 5, 5, 6},
+    ['E'] = {7, 4, 6, 4, 7}, ['F'] = {7, 4, 6, 4, 4}, ['G'] = {3, 4, 5, 5, 3}, ['H'] = {5, 5, 7, 5, 5},
+    ['I'] = {7, 2, 2, 2, 7}, ['J'] = {1, 1, 1, 5, 2}, ['K'] = {5, 5, 6, 5, 5}, ['L'] = {4, 4, 4, 4, 7},
+    ['M'] = {5, 7, 7, 5, 5}, ['N'] = {6, 5, 5, 5, 5}, ['O'] = {2, 5, 5, 5, 2}, ['P'] = {6, 5, 6, 4, 4},
+    ['Q'] = {2, 5, 5, 6, 3}, ['R'] = {6, 5, 6, 5, 5}, ['S'] = {3, 4, 2, 1, 6}, ['T'] = {7, 2, 2, 2, 2},
+    ['U'] = {5, 5, 5, 5, 7}, ['V'] = {5, 5, 5, 5, 2}, ['W'] = {5, 5, 7, 7, 5}, ['X'] = {5, 5, 2, 5, 5},
+    ['Y'] = {5, 5, 2, 2, 2}, ['Z'] = {7, 1, 2, 4, 7},
+    ['.'] = {0, 0, 0, 0, 2}, [':'] = {0, 2, 0, 2, 0}, ['%'] = {5, 1, 2, 4, 5}, ['/'] = {1, 1, 2, 4, 4},
+    ['('] = {1, 2, 2, 2, 1}, [')'] = {4, 2, 2, 2, 4}, ['-'] = {0, 0, 7, 0, 0}, ['='] = {0, 7, 0, 7, 0},
+};
+
+
+
+/**
+ * @brief Le nom d'une phase (pour la trace et les résumés).
+ */
+static const char *nom_phase(Phase phase)
+{
+    switch (phase)
+    {
+    case PHASE_IMAGE:
+        return "image";
+    case PHASE_EVENEMENTS:
+        return "evenements";
+    case PHASE_DESSIN:
+        return "dessin";
+    case PHASE_PRESENTATION:
+        return "presentation";
+    case PHASE_GENERATION:
+        return "generation";
+    default:
+        return "bande";
+    }
+}
+
+
+
+/**
+ * @brief Le thread d'une série dans la trace: 0 pour l'affichage, 1 pour la
+ * simulation (la bande 0 est calculée par le thread qui lance la génération),
+ * 1 + i pour la bande i.
+ */
+static unsigned int fil_trace(Phase phase, unsigned int indice)
+{
+    if (phase == PHASE_BANDE) return 1 + indice;
+    return (phase == PHASE_GENERATION) ? 1 : 0;
+}
+
+
+
+/**
+ * @brief Écrit les évènements en attente d'une série dans la trace.
+ */
+static void ecrit_trace(Mesures *mesures, Phase phase, unsigned int indice, Serie *serie)
+{
+    pthread_mutex_lock(&(mesures -> verrou));
+    for (unsigned int k = 0; k < serie -> nb_trace; k++)
+    {
+        // Les temps de la trace sont en µs
+        EvenementTrace *evenement = &(serie -> trace[k]);
+        fprintf(mesures -> trace, "%s{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f", mesures -> nb_ecrits ? ",\n" : "",
+                nom_phase(phase), fil_trace(phase, indice), evenement -> debut * 1e-3, evenement -> duree * 1e-3);
+        if (phase == PHASE_BANDE) fprintf(mesures -> trace, ",\"args\":{\"bande\":%u}", indice);
+        fputc('}', mesures -> trace);
+        mesures -> nb_ecrits++;
+    }
+    pthread_mutex_unlock(&(mesures -> verrou));
+    serie -> nb_trace = 0;
+}
+
+
+
+/**
+ * @brief Initialise une instance de la struct Mesures.
+ *
+ * @param nb_bandes Le nombre de threads qui se partagent une génération
+ * @param fichier_trace Le fichier où écrire la trace (NULL pour ne pas en écrire)
+ * @return Mesures* Un pointeur sur les Mesures
+ */
+Mesures *init_mesures(unsigned int nb_bandes, const char *fichier_trace)
+{
+    Mesures *mesures = (Mesures *) malloc(sizeof(Mesures));
+    if (mesures == NULL) quitter("Impossible d'allouer de la mémoire pour les mesures\n", 2);
+
+    unsigned int nb_series = PHASE_BANDE + nb_bandes;
+    mesures -> series = (Serie *) aligned_alloc(_Alignof(Serie), sizeof(Serie) * nb_series);
+    if (mesures -> series == NULL) quitter("Impossible d'allouer de la mémoire pour les mesures\n", 2);
+
+    mesures -> trace = NULL;
+    if (fichier_trace != NULL)
+    {
+        mesures -> trace = fopen(fichier_trace, "w");
+        if (mesures -> trace == NULL)
+        {
+            perror(fichier_trace);
+            quitter("Impossible d'ouvrir le fichier de la trace\n", 1);
+        }
+
+        // Les noms des threads, puis les évènements
+        fprintf(mesures -> trace, "[\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"affichage\"}}");
+        fprintf(mesures -> trace, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"simulation\"}}");
+        for (unsigned int i = 1; i < nb_bandes; i++)
+        {
+            fprintf(mesures -> trace, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"bande %u\"}}", 1 + i, i);
+        }
+    }
+
+    for (unsigned int s = 0; s < nb_series; s++)
+    {
+        Serie *serie = &(mesures -> series[s]);
+        atomic_init(&(serie -> nb), 0);
+        for (unsigned int k = 0; k < NB_ECHANTILLONS; k++) atomic_init(&(serie -> durees[k]), 0);
+        serie -> nb_trace = 0;
+        serie -> trace = NULL;
+        if (mesures -> trace == NULL) continue;
+
+        serie -> trace = (EvenementTrace *) malloc(sizeof(EvenementTrace) * TAILLE_TRACE);
+        if (serie -> trace == NULL) quitter("Impossible d'allouer de la mémoire pour la trace\n", 2);
+    }
+
+    mesures -> nb_bandes = nb_bandes;
+    mesures -> nb_ecrits = 1;
+    pthread_mutex_init(&(mesures -> verrou), NULL);
+    mesures -> hud = 1;
+    mesures -> origine = horloge_ns();
+    return mesures;
+}
+
+
+
+/**
+ * @brief Ajoute un intervalle mesuré à la série de sa phase (voir
+ * fin_mesure()). Une série n'est écrite que par un seul thread: pas de verrou,
+ * sauf pour écrire la trace une fois TAILLE_TRACE évènements en attente.
+ *
+ * @param mesures Un pointeur sur les Mesures
+ * @param phase La phase mesurée
+ * @param indice Le numéro de la bande pour PHASE_BANDE, 0 sinon
+ * @param debut Le début de l'intervalle (en ns, voir horloge_ns())
+ * @param fin La fin de l'intervalle
+ */
+void enregistre_mesure(Mesures *mesures, Phase phase, unsigned int indice, uint64_t debut, uint64_t fin)
+{
+    Serie *serie = &(mesures -> series[phase + indice]);
+    uint64_t duree = fin - debut;
+
+    // L'affichage lit les durées en même temps: nb n'augmente qu'une fois la durée écrite
+    unsigned long int n = atomic_load_explicit(&(serie -> nb), memory_order_relaxed);
+    atomic_store_explicit(&(serie -> durees[n % NB_ECHANTILLONS]), duree > UINT32_MAX ? UINT32_MAX : (unsigned int) duree, memory_order_relaxed);
+    atomic_store_explicit(&(serie -> nb), n + 1, memory_order_release);
+
+    if (serie -> trace == NULL) return;
+    serie -> trace[serie -> nb_trace++] = (EvenementTrace) {debut - mesures -> origine, duree};
+    if (serie -> nb_trace == TAILLE_TRACE) ecrit_trace(mesures, phase, indice, serie);
+}
+
+
+
+/**
+ * @brief Pour trier les durées avec qsort().
+ */
+static int compare_durees(const void *a, const void *b)
+{
+    unsigned int x = *(const unsigned int *) a, y = *(const unsigned int *) b;
+    return (x > y) - (x < y);
+}
+
+
+
+/**
+ * @brief Résume les dernières durées d'une série: moyenne, centiles et maximum.
+ *
+ * @return char 1 si la série a au moins une durée, 0 sinon
+ */
+static char resume_serie(const Serie *serie, Resume *resume)
+{
+    unsigned long int nb = atomic_load_explicit(&(serie -> nb), memory_order_acquire);
+    if (nb == 0) return 0;
+
+    // Les durées peuvent changer pendant la copie: ce n'est pas grave pour un résumé
+    unsigned int durees[NB_ECHANTILLONS];
+    unsigned int n = (nb < NB_ECHANTILLONS) ? nb : NB_ECHANTILLONS;
+    double total = 0;
+    for (unsigned int k = 0; k < n; k++)
+    {
+        durees[k] = atomic_load_explicit(&(serie -> durees[k]), memory_order_relaxed);
+        total += durees[k];
+    }
+    qsort(durees, n, sizeof(unsigned int), compare_durees);
+
+    resume -> nb = nb;
+    resume -> nb_echantillons = n;
+    resume -> moyenne = total / n * 1e-3;
+    resume -> p50 = durees[(n - 1) * 50 / 100] * 1e-3;
+    resume -> p95 = durees[(n - 1) * 95 / 100] * 1e-3;
+    resume -> p99 = durees[(n - 1) * 99 / 100] * 1e-3;
+    resume -> max = durees[n - 1] * 1e-3;
+    return 1;
+}
+
+
+
+/**
+ * @brief Le nom de la série s (les bandes sont numérotées).
+ */
+static void nom_serie(const Mesures *mesures, unsigned int s, char *nom, size_t taille)
+{
+    if (s < PHASE_BANDE) snprintf(nom, taille, "%s", nom_phase(s));
+    else if (mesures -> nb_bandes > 1) snprintf(nom, taille, "bande %u", s - PHASE_BANDE);
+    else snprintf(nom, taille, "bande");
+}
+
+
+
+/**
+ * @brief Écrit une ligne de texte avec la police du HUD, son coin supérieur
+ * gauche en (x, y). Tous les pixels sont dessinés en un seul appel.
+ */
+static void dessine_texte(SDL_Renderer *renderer, int x, int y, const char *texte)
+{
+    SDL_Rect pixels[LARGEUR_LIGNE_HUD * 15];
+    int nb = 0;
+    for (unsigned int c = 0; texte[c] != '\0' && c < LARGEUR_LIGNE_HUD; c++)
+    {
+        unsigned char caractere = (unsigned char) toupper((unsigned char) texte[c]);
+        if (caractere >= 128) continue;
+
+        for (int r = 0; r < 5; r++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                if (!((police[caractere][r] >> (2 - k)) & 1)) continue;
+                pixels[nb++] = (SDL_Rect) {x + (4 * c + k) * ECHELLE_HUD, y + r * ECHELLE_HUD, ECHELLE_HUD, ECHELLE_HUD};
+            }
+        }
+    }
+    SDL_RenderFillRects(renderer, pixels, nb);
+}
+
+
+
+/**
+ * @brief Affiche les mesures en haut à gauche de la fenêtre, sur un fond
+ * semi-transparent: pour chaque phase, la moyenne, les centiles 50, 95 et 99
+ * et le maximum des NB_ECHANTILLONS dernières durées (en µs). Pour les bandes,
+ * l'écart entre la bande la plus lente et la moyenne des bandes.
+ *
+ * @param renderer Le renderer de la fenêtre
+ * @param mesures Un pointeur sur les Mesures
+ */
+void dessine_hud(SDL_Renderer *renderer, const Mesures *mesures)
+{
+    if (!mesures -> hud) return;
+
+    // Les lignes du HUD, préparées avant de connaître la taille du fond
+    unsigned int nb_series = PHASE_BANDE + mesures -> nb_bandes;
+    unsigned int nb_lignes = 0;
+    char (*lignes)[TAILLE_LIGNE_HUD] = malloc(sizeof(*lignes) * (nb_series + 2));
+    if (lignes == NULL) quitter("Impossible d'allouer de la mémoire pour le HUD\n", 2);
+
+    snprintf(lignes[nb_lignes++], TAILLE_LIGNE_HUD, "%-12s %8s %8s %8s %8s %8s", "(us)", "moy", "p50", "p95", "p99", "max");
+    double somme_bandes = 0, max_bandes = 0;
+    unsigned int nb_bandes = 0;
+    for (unsigned int s = 0; s < nb_series; s++)
+    {
+        Resume resume;
+        if (!resume_serie(&(mesures -> series[s]), &resume)) continue;
+
+        char nom[24];
+        nom_serie(mesures, s, nom, sizeof(nom));
+        snprintf(lignes[nb_lignes++], TAILLE_LIGNE_HUD, "%-12s %8.1f %8.1f %8.1f %8.1f %8.1f", nom,
+                 resume.moyenne, resume.p50, resume.p95, resume.p99, resume.max);
+
+        if (s < PHASE_BANDE) continue;
+        somme_bandes += resume.moyenne;
+        if (resume.moyenne > max_bandes) max_bandes = resume.moyenne;
+        nb_bandes++;
+    }
+    if (nb_bandes > 1 && somme_bandes > 0)
+    {
+        snprintf(lignes[nb_lignes++], TAILLE_LIGNE_HUD, "bandes: plus lente / moyenne = %.2f", max_bandes * nb_bandes / somme_bandes);
+    }
+
+    // Le fond, puis le texte
+    int marge = 4 * ECHELLE_HUD, hauteur_ligne = 7 * ECHELLE_HUD;
+    SDL_Rect fond = {0, 0, 2 * marge + 4 * LARGEUR_LIGNE_HUD * ECHELLE_HUD, 2 * marge + nb_lignes * hauteur_ligne};
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 176);
+    SDL_RenderFillRect(renderer, &fond);
+    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+
+    SDL_SetRenderDrawColor(renderer, 0, 255, 128, SDL_ALPHA_OPAQUE);
+    for (unsigned int l = 0; l < nb_lignes; l++) dessine_texte(renderer, marge, marge + l * hauteur_ligne, lignes[l]);
+    free(lignes);
+}
+
+
+
+/**
+ * @brief Affiche le résumé de chaque phase dans le terminal (à la fin de la
+ * partie).
+ *
+ * @param mesures Un pointeur sur les Mesures
+ */
+void affiche_mesures(const Mesures *mesures)
+{
+    printf("Durées des %u dernières mesures de chaque phase (en µs):\n", NB_ECHANTILLONS);
+    printf("  %-12s %10s %10s %10s %10s %10s %10s\n", "phase", "mesures", "moyenne", "p50", "p95", "p99", "max");
+    for (unsigned int s = 0; s < PHASE_BANDE + mesures -> nb_bandes; s++)
+    {
+        Resume resume;
+        if (!resume_serie(&(mesures -> series[s]), &resume)) continue;
+
+        char nom[24];
+        nom_serie(mesures, s, nom, sizeof(nom));
+        printf("  %-12s %10lu %10.1f %10.1f %10.1f %10.1f %10.1f\n", nom, resume.nb, resume.moyenne, resume.p50, resume.p95, resume.p99, resume.max);
+    }
+}
+
+
+
+/**
+ * @brief Écrit les évènements en attente, ferme la trace et libère la mémoire
+ * allouée dans init_mesures(). Les threads mesurés doivent être arrêtés.
+ *
+ * @param mesures Un pointeur sur les Mesures à libérer
+ */
+void free_mesures(Mesures *mesures)
+{
+    for (unsigned int s = 0; s < PHASE_BANDE + mesures -> nb_bandes; s++)
+    {
+        Serie *serie = &(mesures -> series[s]);
+        if (serie -> trace == NULL) continue;
+
+        Phase phase = (s < PHASE_BANDE) ? (Phase) s : PHASE_BANDE;
+        ecrit_trace(mesures, phase, s - phase, serie);
+        free(serie -> trace);
+    }
+
+    if (mesures -> trace != NULL)
+    {
+        fprintf(mesures -> trace, "\n]\n");
+        fclose(mesures -> trace);
+    }
+    pthread_mutex_destroy(&(mesures -> verrou));
+    free(mesures -> series);
+    free(mesures);
+}
@@ -0,0 +1,341 @@
+/**
+ * @file motifs.c
+ * @author M3tex
+ * @brief Fichier contenant les lecteurs de motifs: le format .gol du projet
+ * (voir templates/syntaxe), le format RLE et le format Life 1.06 utilisés par
+ * la communauté (voir https://conwaylife.com/wiki/Run_Length_Encoded et
+ * https://conwaylife.com/wiki/Life_1.06).
+ *
+ * Le fichier est lu en une seule fois, puis analysé directement en mémoire.
+ * Les cellules sont d'abord relevées, puis écrites dans la grille seulement si
+ * tout le motif est valide: un motif invalide laisse la grille intacte.
+ * @version 0.1
+ * @date 2022-12-23
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "motifs.h"
+#include "utilitaires.h"
+
+
+
+/**
+ * @brief Le texte d'un motif en cours d'analyse: on lit de pos jusqu'à fin.
+ */
+typedef struct Texte {
+    const char *pos;
+    const char *fin;
+} Texte;
+
+/**
+ * @brief Les cellules vivantes d'un motif en cours d'analyse.
+ *
+ * taille: la taille de la grille (les cellules doivent être dedans)
+ *
+ * positions: les coordonnées des cellules (x puis y pour chaque cellule)
+ *
+ * nb, capacite: le nombre de cellules relevées, et la place pour les stocker
+ */
+typedef struct Cellules {
+    unsigned int taille;
+    unsigned int *positions;
+    size_t nb;
+    size_t capacite;
+} Cellules;
+
+
+
+/**
+ * @brief Passe à la ligne suivante (après le prochain '\n').
+ */
+static void saute_ligne(Texte *texte)
+{
+    const char *nl = memchr(texte -> pos, '\n', texte -> fin - texte -> pos);
+    texte -> pos = (nl == NULL) ? texte -> fin : nl + 1;
+}
+
+
+
+/**
+ * @brief Passe les espaces, tabulations et retours chariot (mais pas les '\n').
+ */
+static void saute_espaces(Texte *texte)
+{
+    while (texte -> pos < texte -> fin && (*texte -> pos == ' ' || *texte -> pos == '\t' || *texte -> pos == '\r')) texte -> pos++;
+}
+
+
+
+/**
+ * @brief Lit un entier (éventuellement négatif) à la position actuelle.
+ *
+ * @param texte Le texte
+ * @param n Un pointeur sur la variable où stocker l'entier
+ * @return char 1 si un entier a été lu, 0 sinon
+ */
+static char lit_entier(Texte *texte, long int *n)
+{
+    char negatif = 0;
+    if (texte -> pos < texte -> fin && (*texte -> pos == '-' || *texte -> pos == '+'))
+    {
+        negatif = (*texte -> pos == '-');
+        texte -> pos++;
+    }
+    if (texte -> pos >= texte -> fin || *texte -> pos < '0' || *texte -> pos > '9') return 0;
+
+    long int valeur = 0;
+    while (texte -> pos < texte -> fin && *texte -> pos >= '0' && *texte -> pos <= '9')
+    {
+        // On considère que les coordonnées d'un motif tiennent largement dans un long
+        if (valeur < 100000000000L) valeur = valeur * 10 + (*texte -> pos - '0');
+        texte -> pos++;
+    }
+    *n = negatif ? -valeur : valeur;
+    return 1;
+}
+
+
+
+/**
+ * @brief Relève une cellule vivante du motif (elle n'est écrite dans la grille
+ * qu'à la fin, par charge_motif()).
+ *
+ * @return char 1 si la cellule est dans la grille, 0 sinon
+ */
+static char ajoute_cellule(Cellules *cellules, long int x, long int y)
+{
+    if (x < 0 || y < 0 || x >= cellules -> taille || y >= cellules -> taille) return 0;
+
+    if (cellules -> nb == cellules -> capacite)
+    {
+        cellules -> capacite = cellules -> capacite ? 2 * cellules -> capacite : 1024;
+        cellules -> positions = (unsigned int *) realloc(cellules -> positions, sizeof(unsigned int) * 2 * cellules -> capacite);
+        if (cellules -> positions == NULL) quitter("Impossible d'allouer de la mémoire pour le motif\n", 2);
+    }
+    cellules -> positions[2 * cellules -> nb] = (unsigned int) x;
+    cellules -> positions[2 * cellules -> nb + 1] = (unsigned int) y;
+    cellules -> nb++;
+    return 1;
+}
+
+
+
+/**
+ * @brief Lit un motif au format .gol: la taille n du motif, puis n lignes de
+ * n caractères ('1' pour une cellule vivante).
+ */
+static char charge_gol(Texte *texte, Cellules *cellules, int x, int y)
+{
+    // + lisible
+    unsigned int taille = cellules -> taille;
+
+    long int nb;
+    if (!lit_entier(texte, &nb) || nb < 0) return 0;
+    saute_ligne(texte);
+
+    // On vérifie que le paterne rentre bien aux coordonées données
+    if (x + nb > taille || y + nb > taille) return 0;
+
+    for (long int i = 0; i < nb && texte -> pos < texte -> fin; i++)
+    {
+        const char *ligne = texte -> pos;
+        saute_ligne(texte);
+        for (long int j = 0; j < nb && ligne + j < texte -> pos && ligne[j] != '\n'; j++)
+        {
+            if (ligne[j] == '1') ajoute_cellule(cellules, x + j, y + i);
+        }
+    }
+    return 1;
+}
+
+
+
+/**
+ * @brief Lit un motif au format RLE: des lignes de commentaires commençant par
+ * '#', l'entête "x = largeur, y = hauteur[, rule = ...]", puis les cellules
+ * sous la forme <nombre><symbole>: 'b' (ou '.') pour des cellules mortes, 'o'
+ * (ou toute autre lettre) pour des vivantes, '$' pour passer à la ligne suivante
+ * et '!' pour finir.
+ */
+static char charge_rle(Texte *texte, Cellules *cellules, int x, int y)
+{
+    // + lisible
+    unsigned int taille = cellules -> taille;
+
+    // Les commentaires
+    while (texte -> pos < texte -> fin && *texte -> pos == '#') saute_ligne(texte);
+
+    // L'entête: on ne garde que x et y (la règle n'est pas lue)
+    if (texte -> pos >= texte -> fin) return 0;
+    long int largeur = 0, hauteur = 0;
+    const char *fin_entete = memchr(texte -> pos, '\n', texte -> fin - texte -> pos);
+    if (fin_entete == NULL) fin_entete = texte -> fin;
+    for (const char *c = texte -> pos; c < fin_entete; c++)
+    {
+        if ((*c != 'x' && *c != 'y') || (c > texte -> pos && c[-1] != ' ' && c[-1] != ',')) continue;
+
+        Texte valeur = {c + 1, fin_entete};
+        saute_espaces(&valeur);
+        if (valeur.pos >= fin_entete || *valeur.pos != '=') continue;
+        valeur.pos++;
+        saute_espaces(&valeur);
+        if (!lit_entier(&valeur, (*c == 'x') ? &largeur : &hauteur)) return 0;
+    }
+    texte -> pos = fin_entete;
+    if (largeur < 0 || hauteur < 0 || x + largeur > taille || y + hauteur > taille) return 0;
+
+    long int i = 0, j = 0;
+    while (texte -> pos < texte -> fin)
+    {
+        char c = *texte -> pos;
+        if (c == '!') break;
+        if (c == ' ' || c == '\t' || c == '\r' || c == '\n')
+        {
+            texte -> pos++;
+            continue;
+        }
+
+        // Le nombre (1 par défaut) peut être coupé par un retour à la ligne
+        long int nb = 1;
+        if (c >= '0' && c <= '9')
+        {
+            nb = 0;
+            for (; texte -> pos < texte -> fin; texte -> pos++)
+            {
+                c = *texte -> pos;
+                if (c >= '0' && c <= '9') nb = (nb < 100000000000L) ? nb * 10 + (c - '0') : nb;
+                else if (c != '\n' && c != '\r') break;
+            }
+            if (texte -> pos >= texte -> fin) break;
+        }
+        texte -> pos++;
+
+        if (c == '$')
+        {
+            i += nb;
+            j = 0;
+        }
+        else if (c == 'b' || c == '.') j += nb;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z'))
+        {
+            for (long int k = 0; k < nb; k++, j++)
+            {
+                if (!ajoute_cellule(cellules, x + j, y + i)) return 0;
+            }
+        }
+        else return 0;
+    }
+    return 1;
+}
+
+
+
+/**
+ * @brief Lit un motif au format Life 1.06: la ligne "#Life 1.06", puis une
+ * cellule vivante par ligne, donnée par ses coordonnées "x y" (qui peuvent être
+ * négatives). Le coin supérieur gauche du motif est placé en (x, y).
+ */
+static char charge_life106(Texte *texte, Cellules *cellules, int x, int y)
+{
+    // + lisible
+    unsigned int taille = cellules -> taille;
+    const char *debut = texte -> pos;
+
+    // Premier passage: on cherche le rectangle englobant les cellules
+    long int min_x = 0, min_y = 0, max_x = -1, max_y = -1;
+    char vide = 1;
+    for (int passage = 0; passage < 2; passage++)
+    {
+        texte -> pos = debut;
+        while (texte -> pos < texte -> fin)
+        {
+            saute_espaces(texte);
+            if (texte -> pos >= texte -> fin || *texte -> pos == '#' || *texte -> pos == '\n')
+            {
+                saute_ligne(texte);
+                continue;
+            }
+
+            long int cx, cy;
+            if (!lit_entier(texte, &cx)) return 0;
+            saute_espaces(texte);
+            if (!lit_entier(texte, &cy)) return 0;
+            saute_ligne(texte);
+
+            if (passage == 1) ajoute_cellule(cellules, x + cx - min_x, y + cy - min_y);
+            else if (vide) min_x = max_x = cx, min_y = max_y = cy, vide = 0;
+            else
+            {
+                if (cx < min_x) min_x = cx;
+                if (cx > max_x) max_x = cx;
+                if (cy < min_y) min_y = cy;
+                if (cy > max_y) max_y = cy;
+            }
+        }
+
+        // On vérifie que le paterne rentre bien aux coordonées données
+        if (passage == 0 && (x + max_x - min_x + 1 > taille || y + max_y - min_y + 1 > taille)) return 0;
+    }
+    return 1;
+}
+
+
+
+/**
+ * @brief Permet de savoir si le texte est au format RLE: des commentaires
+ * puis l'entête "x = ...".
+ */
+static char est_rle(Texte texte)
+{
+    while (texte.pos < texte.fin && *texte.pos == '#') saute_ligne(&texte);
+    saute_espaces(&texte);
+    return texte.pos < texte.fin && *texte.pos == 'x';
+}
+
+
+
+/**
+ * @brief Charge un motif déjà lu en mémoire dans la grille du jeu. Le format
+ * (.gol, RLE ou Life 1.06) est détecté automatiquement. Si le motif est
+ * invalide, la grille et les statistiques ne sont pas modifiées.
+ *
+ * @param donnees Le contenu du fichier
+ * @param taille Le nombre d'octets de donnees
+ * @param jeu Un pointeur sur le Jeu
+ * @param x L'abscisse où insérer le coin supérieur gauche du paterne
+ * @param y L'ordonnée où insérer le coin supérieur gauche du paterne
+ * @return char 1 si chargé avec succès, 0 sinon.
+ */
+char charge_motif(const char *donnees, size_t taille, Jeu *jeu, int x, int y)
+{
+    // + lisible
+    Grille *grille = jeu -> grille;
+
+    Texte texte = {donnees, donnees + taille};
+    Cellules cellules = {grille -> taille, NULL, 0, 0};
+    char valide = 0;
+
+    // Life 1.06: la première ligne l'indique
+    if (taille >= 10 && !strncmp(donnees, "#Life 1.06", 10)) valide = charge_life106(&texte, &cellules, x, y);
+
+    // .gol: la première ligne est la taille du motif
+    else if (taille > 0 && donnees[0] >= '0' && donnees[0] <= '9') valide = charge_gol(&texte, &cellules, x, y);
+
+    // Sinon ce doit être du RLE
+    else if (est_rle(texte)) valide = charge_rle(&texte, &cellules, x, y);
+    else print_redb("Format de fichier inconnu (formats acceptés: .gol, RLE et Life 1.06).\n");
+
+    // Le motif est entièrement lu: on peut l'écrire dans la grille
+    for (size_t c = 0; valide && c < cellules.nb; c++)
+    {
+        cellule *cell = &CELLULE(grille, cellules.positions[2 * c + 1], cellules.positions[2 * c]);
+        if (!*cell) jeu -> statistiques -> nb_cellules_depart++;
+        *cell = (1 << 7) + 1;  // 1 << 7 car cell originelle
+    }
+    free(cellules.positions);
+    return valide;
+}
@@ -0,0 +1,280 @@
+/**
+ * @file palette.c
+ * @author M3tex
+ * @brief Fichier contenant les palettes de couleurs: pour chaque palette, la
+ * couleur ARGB de chacun des 256 octets de cellule possibles (âge + bit
+ * d'origine) est calculée une seule fois au lancement (voir init_palettes()).
+ * L'affichage convertit ensuite des lignes entières de cellules en pixels avec
+ * ces tables, en utilisant les instructions AVX2 ou AVX-512 si disponibles.
+ * @version 0.1
+ * @date 2022-12-21
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include "palette.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define SIMD_X86
+#endif
+
+
+// Les couleurs sont au format ARGB8888 (celui de la texture de l'affichage)
+#define ARGB(r, g, b) (0xFF000000u | ((uint32_t) (r) << 16) | ((uint32_t) (g) << 8) | (uint32_t) (b))
+#define NOIR ARGB(0, 0, 0)
+#define BLANC ARGB(255, 255, 255)
+
+
+/* Convertit n cellules en pixels avec une table de 256 couleurs */
+typedef void (*NoyauPixels)(const cellule *cellules, uint32_t *pixels, unsigned int n, const uint32_t *table);
+
+/* Une table par palette, puis la table noir et blanc (sans couleur).
+L'entrée 0 (cellule morte) est toujours noire. */
+static uint32_t tables[NB_PALETTES + 1][256];
+static NoyauPixels noyau_pixels = NULL;
+
+
+
+/**
+ * @brief Ramène x dans [0, 1] puis le convertit en une composante entre 0 et 255.
+ */
+static unsigned char composante(double x)
+{
+    if (x < 0) return 0;
+    if (x > 1) return 255;
+    return 255 * x;
+}
+
+
+
+/**
+ * @brief Calcule la couleur d'une cellule vivante pour une palette donnée.
+ *
+ * @param palette La palette
+ * @param cell La cellule (non nulle)
+ * @return uint32_t La couleur au format ARGB8888
+ */
+static uint32_t couleur_palette(Palette palette, cellule cell)
+{
+    unsigned char r, g, b;
+    double t = (cell & 127) / 127.0;     // L'âge, ramené entre 0 et 1
+    switch (palette)
+    {
+    case PALETTE_CHALEUR:
+        // Rouge sombre -> rouge -> jaune -> blanc
+        r = composante(0.3 + 3 * t);
+        g = composante(3 * t - 1);
+        b = composante(3 * t - 2);
+        break;
+    case PALETTE_ORIGINE:
+        // Les cellules originelles ressortent en orange, les autres en bleu
+        if (cell >> 7) return ARGB(255, 140, 0);
+        r = composante(0.15 + 0.45 * t);
+        g = composante(0.3 + 0.5 * t);
+        b = composante(0.8 + 0.2 * t);
+        break;
+    default:
+        get_color(cell, &r, &g, &b);
+        break;
+    }
+
+    // Pas de noir sur du noir: une cellule vivante noire est affichée en blanc
+    if (r == 0 && g == 0 && b == 0) return BLANC;
+    return ARGB(r, g, b);
+}
+
+
+
+/**
+ * @brief Noyau de secours: une cellule à la fois.
+ */
+static void pixels_scalaire(const cellule *cellules, uint32_t *pixels, unsigned int n, const uint32_t *table)
+{
+    for (unsigned int i = 0; i < n; i++) pixels[i] = table[cellules[i]];
+}
+
+
+
+#ifdef SIMD_X86
+
+/**
+ * @brief Noyau AVX2: 32 cellules par tour de boucle. Les cellules sont
+ * élargies sur 32 bits puis servent d'indices pour lire la table (gather),
+ * 8 à la fois. Un vecteur de 32 cellules mortes (cas le plus courant) est
+ * écrit directement en noir.
+ */
+__attribute__((target("avx2")))
+static void pixels_avx2(const cellule *cellules, uint32_t *pixels, unsigned int n, const uint32_t *table)
+{
+    const __m256i mort = _mm256_set1_epi32(table[0]);
+    unsigned int i = 0;
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i octets = _mm256_loadu_si256((const __m256i *) (cellules + i));
+        if (_mm256_testz_si256(octets, octets))
+        {
+            for (int k = 0; k < 4; k++) _mm256_storeu_si256((__m256i *) (pixels + i + 8 * k), mort);
+            continue;
+        }
+
+        for (int k = 0; k < 4; k++)
+        {
+            __m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *) (cellules + i + 8 * k)));
+            _mm256_storeu_si256((__m256i *) (pixels + i + 8 * k), _mm256_i32gather_epi32((const int *) table, indices, 4));
+        }
+    }
+    pixels_scalaire(cellules + i, pixels + i, n - i, table);
+}
+
+
+
+/**
+ * @brief Noyau AVX-512: même principe que pixels_avx2(), 64 cellules par tour
+ * de boucle et 16 lectures de la table à la fois.
+ */
+__attribute__((target("avx512f,avx512bw")))
+static void pixels_avx512(const cellule *cellules, uint32_t *pixels, unsigned int n, const uint32_t *table)
+{
+    const __m512i mort = _mm512_set1_epi32(table[0]);
+    unsigned int i = 0;
+    for (; i + 64 <= n; i += 64)
+    {
+        __m512i octets = _mm512_loadu_si512((const void *) (cellules + i));
+        if (!_mm512_test_epi8_mask(octets, octets))
+        {
+            for (int k = 0; k < 4; k++) _mm512_storeu_si512((void *) (pixels + i + 16 * k), mort);
+            continue;
+        }
+
+        for (int k = 0; k < 4; k++)
+        {
+            __m512i indices = _mm512_cvtepu8_epi32(_mm_loadu_si128((const __m128i *) (cellules + i + 16 * k)));
+            _mm512_storeu_si512((void *) (pixels + i + 16 * k), _mm512_i32gather_epi32(indices, (const void *) table, 4));
+        }
+    }
+    pixels_scalaire(cellules + i, pixels + i, n - i, table);
+}
+
+#endif
+
+
+
+/**
+ * @brief Calcule les tables de toutes les palettes et choisit le noyau de
+ * conversion en pixels en fonction du processeur. À appeler une fois au
+ * lancement (sinon appelée à la première utilisation).
+ */
+void init_palettes()
+{
+    for (unsigned int p = 0; p <= NB_PALETTES; p++)
+    {
+        tables[p][0] = NOIR;
+        for (unsigned int c = 1; c < 256; c++)
+        {
+            tables[p][c] = (p == NB_PALETTES) ? BLANC : couleur_palette(p, c);
+        }
+    }
+
+    noyau_pixels = pixels_scalaire;
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw")) noyau_pixels = pixels_avx512;
+    else if (__builtin_cpu_supports("avx2")) noyau_pixels = pixels_avx2;
+#endif
+}
+
+
+
+/**
+ * @brief Retourne la table de couleurs à utiliser pour l'affichage.
+ *
+ * @param palette La palette choisie
+ * @param estCouleur 1 si le jeu est affiché en couleur, 0 sinon (noir et blanc)
+ * @return const uint32_t* La table: la couleur ARGB de chaque octet de cellule
+ */
+const uint32_t *table_palette(Palette palette, char estCouleur)
+{
+    if (noyau_pixels == NULL) init_palettes();
+    if (!estCouleur || palette >= NB_PALETTES) return tables[NB_PALETTES];
+    return tables[palette];
+}
+
+
+
+/**
+ * @brief Convertit une ligne de cellules en pixels ARGB8888.
+ *
+ * @param cellules La première cellule de la ligne
+ * @param pixels Le premier pixel de la ligne
+ * @param n Le nombre de cellules
+ * @param table La table de couleurs (voir table_palette())
+ */
+void cellules2pixels(const cellule *cellules, uint32_t *pixels, unsigned int n, const uint32_t *table)
+{
+    if (noyau_pixels == NULL) init_palettes();
+    noyau_pixels(cellules, pixels, n, table);
+}
+
+
+
+/**
+ * @brief À partir de l'âge d'une cellule au format:
+ * O A A A A A A A, avec A les 7 bits d'âge de la cellule,
+ * permet de déterminer la couleur de cette cellule.
+ *
+ * @param cell La cellule concernée
+ * @param r Un pointeur sur la variable stockant le rouge
+ * @param g Un pointeur sur la variable stockant le vert
+ * @param b Un pointeur sur la variable stockant le bleu
+ */
+void get_color(cellule cell, unsigned char *r, unsigned char *g, unsigned char *b)
+{
+    /* On utilise le spectre du visible pour déterminer la couleur en fonction de l'âge:
+    Une cellule d'âge 0 aura une longueur d'onde de 420nm, une cellule d'âge 1 aura une
+    longueur d'onde de 422, ..., une cellule d'âge maximal aura une longueur d'onde de 676nm.
+
+    Attention: j'ai récupéré la fonction permettant de déterminer une couleur rgb256 à partir d'une
+    longueur d'onde sur internet (voir dans README où j'explique + en détail). */
+    double rd, gd, bd;
+    double long_onde = (cell & 127) * 2 + 420;
+    spectral_color(&rd, &gd, &bd, long_onde);   // fonction récupérée sur StackOverflow
+
+    // On convertit en rgb256
+    *r = 256 * rd;
+    *g = 256 * gd;
+    *b = 256 * bd;
+}
+
+
+
+
+// RGB <0,1> <- lambda l <400,700> [nm]
+/**
+ * @brief Permet de déterminer une couleur en rgb à partir
+ * d'une longueur d'onde en nm.
+ * 
+ * Fonction récupérée ici:
+ * https://stackoverflow.com/questions/3407942/rgb-values-of-visible-spectrum/22681410#22681410
+ * 
+ * @param r Un pointeur sur la variable stockant le rouge
+ * @param g Un pointeur sur la variable stockant le vert
+ * @param b Un pointeur sur la variable stockant le bleu
+ * @param l La longueur d'onde en nm
+ */
+void spectral_color(double *r,double *g,double *b,double l) 
+{
+double t;  
+*r=0.0; *g=0.0; *b=0.0;
+        if ((l>=400.0)&&(l<410.0)) {t=(l-400.0)/(410.0-400.0); *r=    +(0.33*t)-(0.20*t*t); }
+else if ((l>=410.0)&&(l<475.0)) { t=(l-410.0)/(475.0-410.0); *r=0.14         -(0.13*t*t); }
+else if ((l>=545.0)&&(l<595.0)) { t=(l-545.0)/(595.0-545.0); *r=    +(1.98*t)-(     t*t); }
+else if ((l>=595.0)&&(l<650.0)) { t=(l-595.0)/(650.0-595.0); *r=0.98+(0.06*t)-(0.40*t*t); }
+else if ((l>=650.0)&&(l<700.0)) { t=(l-650.0)/(700.0-650.0); *r=0.65-(0.84*t)+(0.20*t*t); }
+        if ((l>=415.0)&&(l<475.0)) { t=(l-415.0)/(475.0-415.0); *g=             +(0.80*t*t); }
+else if ((l>=475.0)&&(l<590.0)) { t=(l-475.0)/(590.0-475.0); *g=0.8 +(0.76*t)-(0.80*t*t); }
+else if ((l>=585.0)&&(l<639.0)) { t=(l-585.0)/(639.0-585.0); *g=0.84-(0.84*t)           ; }
+        if ((l>=400.0)&&(l<475.0)) { t=(l-400.0)/(475.0-400.0); *b=    +(2.20*t)-(1.50*t*t); }
+else if ((l>=475.0)&&(l<560.0)) { t=(l-475.0)/(560.0-475.0); *b=0.7 -(     t)+(0.30*t*t); }
+}
\ No newline at end of file
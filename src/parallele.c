@@ -0,0 +1,164 @@
+/**
+ * @file parallele.c
+ * @author M3tex
+ * @brief Fichier contenant le 'pool' de threads persistants utilisé pour
+ * calculer la génération suivante en parallèle.
+ * @version 0.1
+ * @date 2022-12-12
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdlib.h>
+#include <pthread.h>
+#include "parallele.h"
+#include "utilitaires.h"
+
+
+
+/**
+ * @brief Les arguments donnés à chaque thread du pool
+ * 
+ * pool: Le pool auquel appartient le thread
+ * 
+ * indice: Le numéro du thread dans le pool (entre 1 et nb_threads - 1)
+ */
+typedef struct ArgThread {
+    Pool *pool;
+    unsigned int indice;
+} ArgThread;
+
+
+
+
+/**
+ * @brief La boucle exécutée par chaque thread du pool: on attend une
+ * nouvelle tâche, on l'exécute et on prévient quand on a fini.
+ * 
+ * @param arg Un pointeur sur les arguments du thread (ArgThread)
+ * @return void* NULL
+ */
+static void *boucle_thread(void *arg)
+{
+    // + lisible
+    Pool *pool = ((ArgThread *) arg) -> pool;
+    unsigned int indice = ((ArgThread *) arg) -> indice;
+
+    unsigned long int dernier_lot = 0;
+    pthread_mutex_lock(&(pool -> verrou));
+    while (1)
+    {
+        // On attend qu'on nous donne une nouvelle tâche (ou qu'on doive s'arrêter)
+        while (pool -> lot == dernier_lot && !(pool -> arret)) pthread_cond_wait(&(pool -> debut), &(pool -> verrou));
+        if (pool -> arret) break;
+
+        dernier_lot = pool -> lot;
+        Tache tache = pool -> tache;
+        void *contexte = pool -> contexte;
+
+        // On exécute la tâche sans bloquer les autres threads
+        pthread_mutex_unlock(&(pool -> verrou));
+        tache(contexte, indice);
+        pthread_mutex_lock(&(pool -> verrou));
+
+        // Le dernier thread à finir réveille celui qui attend dans execute_pool()
+        pool -> restants--;
+        if (pool -> restants == 0) pthread_cond_signal(&(pool -> fin));
+    }
+    pthread_mutex_unlock(&(pool -> verrou));
+    return NULL;
+}
+
+
+
+/**
+ * @brief Initialise une instance de la struct Pool et crée ses threads.
+ * 
+ * @param nb_threads Le nombre de threads voulus (thread appelant compris)
+ * @return Pool* Un pointeur sur le Pool
+ */
+Pool *init_pool(unsigned int nb_threads)
+{
+    Pool *pool = (Pool *) malloc(sizeof(Pool));
+    if (pool == NULL) quitter("Impossible d'allouer de la mémoire pour les threads\n", 2);
+
+    pool -> nb_threads = nb_threads;
+    pool -> lot = 0;
+    pool -> restants = 0;
+    pool -> arret = 0;
+    pool -> tache = NULL;
+    pool -> contexte = NULL;
+    pthread_mutex_init(&(pool -> verrou), NULL);
+    pthread_cond_init(&(pool -> debut), NULL);
+    pthread_cond_init(&(pool -> fin), NULL);
+
+    // Le thread appelant sert de thread 0: on en crée nb_threads - 1
+    pool -> threads = (pthread_t *) malloc(sizeof(pthread_t) * nb_threads);
+    pool -> args = (ArgThread *) malloc(sizeof(ArgThread) * nb_threads);
+    if (pool -> threads == NULL || pool -> args == NULL) quitter("Impossible d'allouer de la mémoire pour les threads\n", 2);
+
+    for (unsigned int i = 1; i < nb_threads; i++)
+    {
+        pool -> args[i].pool = pool;
+        pool -> args[i].indice = i;
+        if (pthread_create(&(pool -> threads[i]), NULL, boucle_thread, &(pool -> args[i])) != 0)
+        {
+            quitter("Impossible de créer les threads\n", 2);
+        }
+    }
+    return pool;
+}
+
+
+
+/**
+ * @brief Exécute une tâche sur tous les threads du pool (y compris le thread
+ * appelant, avec l'indice 0) et attend que tous aient fini.
+ * 
+ * @param pool Un pointeur sur le pool
+ * @param tache La tâche à exécuter
+ * @param contexte Les données données à la tâche
+ */
+void execute_pool(Pool *pool, Tache tache, void *contexte)
+{
+    // On donne la tâche aux autres threads
+    pthread_mutex_lock(&(pool -> verrou));
+    pool -> tache = tache;
+    pool -> contexte = contexte;
+    pool -> restants = pool -> nb_threads - 1;
+    pool -> lot++;
+    pthread_cond_broadcast(&(pool -> debut));
+    pthread_mutex_unlock(&(pool -> verrou));
+
+    // On fait notre part
+    tache(contexte, 0);
+
+    // Puis on attend les autres
+    pthread_mutex_lock(&(pool -> verrou));
+    while (pool -> restants > 0) pthread_cond_wait(&(pool -> fin), &(pool -> verrou));
+    pthread_mutex_unlock(&(pool -> verrou));
+}
+
+
+
+/**
+ * @brief Arrête les threads et libère la mémoire allouée dans init_pool()
+ * 
+ * @param pool Un pointeur sur le Pool à libérer
+ */
+void free_pool(Pool *pool)
+{
+    pthread_mutex_lock(&(pool -> verrou));
+    pool -> arret = 1;
+    pthread_cond_broadcast(&(pool -> debut));
+    pthread_mutex_unlock(&(pool -> verrou));
+
+    for (unsigned int i = 1; i < pool -> nb_threads; i++) pthread_join(pool -> threads[i], NULL);
+
+    pthread_mutex_destroy(&(pool -> verrou));
+    pthread_cond_destroy(&(pool -> debut));
+    pthread_cond_destroy(&(pool -> fin));
+    free(pool -> threads);
+    free(pool -> args);
+    free(pool);
+}
@@ -0,0 +1,297 @@
+/**
+ * @file pyramide.c
+ * @author M3tex
+ * @brief Fichier contenant la pyramide de densité, qui permet de dézoomer
+ * sous 1 pixel par cellule.
+ *
+ * Quand la grille est plus grande que la fenêtre, un pixel représente un carré
+ * de 2^k x 2^k cellules. Plutôt que de relire toutes ces cellules à chaque
+ * image, on garde pour chaque niveau k le résumé de chaque carré: sa densité et
+ * sa cellule la plus vieille (voir NiveauPyramide). Le niveau k se calcule à partir
+ * du niveau k - 1 (4 cases par case), le niveau 1 à partir de la grille.
+ *
+ * Le dessin d'une image ne lit alors qu'une case par pixel: son coût dépend de
+ * la taille de la fenêtre, pas de celle de la grille. La pyramide est mise à
+ * jour à partir des tuiles qui ont changé (voir Tuiles): seules les cases qui
+ * les recouvrent, et leurs ancêtres, sont recalculées.
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdlib.h>
+#include "pyramide.h"
+#include "utilitaires.h"
+
+
+
+// La densité (sur 255) d'une case du niveau 1 en fonction de son nombre de cellules vivantes
+static const uint8_t densites[5] = {0, 64, 128, 191, 255};
+
+
+
+/**
+ * @brief Résume deux cellules: l'âge de la plus vieille, avec le bit d'origine
+ * si l'une des deux est originelle. Comparer les octets bruts ferait passer
+ * n'importe quelle cellule originelle devant une cellule plus vieille.
+ */
+static inline cellule fusionne(cellule a, cellule b)
+{
+    cellule age_a = a & 127, age_b = b & 127;
+    return (cellule) ((age_a > age_b ? age_a : age_b) | ((a | b) & 128));
+}
+
+
+
+/**
+ * @brief Initialise la pyramide d'une grille: des niveaux de plus en plus
+ * petits, jusqu'à une seule case. Elle est marquée obsolète (voir
+ * maj_pyramide()).
+ *
+ * @param taille La taille de la grille
+ * @return Pyramide* Un pointeur sur la pyramide
+ */
+Pyramide *init_pyramide(unsigned int taille)
+{
+    Pyramide *pyramide = (Pyramide *) malloc(sizeof(Pyramide));
+    if (pyramide == NULL) quitter("Impossible d'allouer de la mémoire pour la pyramide\n", 2);
+
+    // Le nombre de niveaux: le plus petit L tel que 2^L >= taille
+    pyramide -> nb_niveaux = 0;
+    while (pyramide -> nb_niveaux < 32 && ((uint64_t) 1 << pyramide -> nb_niveaux) < taille) pyramide -> nb_niveaux++;
+
+    pyramide -> taille = taille;
+    pyramide -> obsolete = 1;
+    pyramide -> niveaux = (NiveauPyramide *) malloc(sizeof(NiveauPyramide) * (pyramide -> nb_niveaux + 1));
+    if (pyramide -> niveaux == NULL) quitter("Impossible d'allouer de la mémoire pour la pyramide\n", 2);
+
+    for (unsigned int k = 1; k <= pyramide -> nb_niveaux; k++)
+    {
+        NiveauPyramide *niveau = &(pyramide -> niveaux[k - 1]);
+        niveau -> taille = (unsigned int) (((uint64_t) taille + ((uint64_t) 1 << k) - 1) >> k);
+
+        size_t nb_cases = (size_t) niveau -> taille * niveau -> taille;
+        niveau -> densite = (uint8_t *) malloc(nb_cases);
+        niveau -> cellule = (cellule *) malloc(nb_cases);
+        if (niveau -> densite == NULL || niveau -> cellule == NULL) quitter("Impossible d'allouer de la mémoire pour la pyramide\n", 2);
+    }
+    return pyramide;
+}
+
+
+
+/**
+ * @brief Calcule les cases [x0, x1) x [y0, y1) du niveau 1 à partir de la
+ * grille. Les cellules hors de la grille (si sa taille est impaire) sont
+ * mortes: on ne lit jamais la bordure, que les grilles refermées remplissent.
+ */
+static void calcule_niveau_1(NiveauPyramide *niveau, const Grille *grille, unsigned int x0, unsigned int y0,
+                             unsigned int x1, unsigned int y1)
+{
+    // + lisible
+    unsigned int taille = grille -> taille;
+
+    for (unsigned int i = y0; i < y1; i++)
+    {
+        const cellule *haut = &CELLULE(grille, 2 * i, 0);
+        const cellule *bas = (2 * i + 1 < taille) ? haut + grille -> pas : NULL;
+        uint8_t *densite = niveau -> densite + (size_t) i * niveau -> taille;
+        cellule *max = niveau -> cellule + (size_t) i * niveau -> taille;
+
+        for (unsigned int j = x0; j < x1; j++)
+        {
+            char deux_colonnes = (2 * j + 1 < taille);
+            cellule a = haut[2 * j];
+            cellule b = deux_colonnes ? haut[2 * j + 1] : 0;
+            cellule c = (bas != NULL) ? bas[2 * j] : 0;
+            cellule d = (bas != NULL && deux_colonnes) ? bas[2 * j + 1] : 0;
+
+            densite[j] = densites[(a != 0) + (b != 0) + (c != 0) + (d != 0)];
+            max[j] = fusionne(fusionne(a, b), fusionne(c, d));
+        }
+    }
+}
+
+
+
+/**
+ * @brief Calcule les cases [x0, x1) x [y0, y1) du niveau k > 1 à partir du
+ * niveau k - 1 (les cases absentes du niveau k - 1 sont vides).
+ */
+static void calcule_niveau(NiveauPyramide *niveau, const NiveauPyramide *precedent, unsigned int x0, unsigned int y0,
+                           unsigned int x1, unsigned int y1)
+{
+    // + lisible
+    unsigned int taille = precedent -> taille;
+
+    for (unsigned int i = y0; i < y1; i++)
+    {
+        size_t haut = (size_t) (2 * i) * taille;
+        char deux_lignes = (2 * i + 1 < taille);
+        size_t bas = deux_lignes ? haut + taille : haut;
+
+        for (unsigned int j = x0; j < x1; j++)
+        {
+            // Les 4 cases filles (celles qui n'existent pas sont comptées vides)
+            char deux_colonnes = (2 * j + 1 < taille);
+            size_t gauche = 2 * j, droite = deux_colonnes ? 2 * j + 1 : 2 * j;
+
+            unsigned int somme = precedent -> densite[haut + gauche];
+            cellule m = precedent -> cellule[haut + gauche];
+            if (deux_colonnes)
+            {
+                somme += precedent -> densite[haut + droite];
+                m = fusionne(m, precedent -> cellule[haut + droite]);
+            }
+            if (deux_lignes)
+            {
+                somme += precedent -> densite[bas + gauche];
+                m = fusionne(m, precedent -> cellule[bas + gauche]);
+            }
+            if (deux_lignes && deux_colonnes)
+            {
+                somme += precedent -> densite[bas + droite];
+                m = fusionne(m, precedent -> cellule[bas + droite]);
+            }
+
+            size_t indice = (size_t) i * niveau -> taille + j;
+            niveau -> densite[indice] = (somme + 2) / 4;
+            niveau -> cellule[indice] = m;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Recalcule, à chaque niveau, les cases qui recouvrent le carré de
+ * cellules [x0, x1) x [y0, y1) de la grille.
+ */
+static void maj_carre(Pyramide *pyramide, const Grille *grille, unsigned int x0, unsigned int y0,
+                      unsigned int x1, unsigned int y1)
+{
+    for (unsigned int k = 1; k <= pyramide -> nb_niveaux; k++)
+    {
+        NiveauPyramide *niveau = &(pyramide -> niveaux[k - 1]);
+        unsigned int debut_x = x0 >> k, fin_x = ((x1 - 1) >> k) + 1;
+        unsigned int debut_y = y0 >> k, fin_y = ((y1 - 1) >> k) + 1;
+
+        if (k == 1) calcule_niveau_1(niveau, grille, debut_x, debut_y, fin_x, fin_y);
+        else calcule_niveau(niveau, niveau - 1, debut_x, debut_y, fin_x, fin_y);
+    }
+}
+
+
+
+/**
+ * @brief Met la pyramide à jour par rapport à la grille.
+ *
+ * Si modifiees vaut NULL (ou si la pyramide est obsolète), toute la pyramide
+ * est recalculée. Sinon, on ne recalcule que les cases qui recouvrent une
+ * tuile modifiée: chaque tuile met à jour ses ancêtres dans l'ordre des
+ * niveaux, les cases partagées par plusieurs tuiles sont donc justes une fois
+ * la dernière tuile passée.
+ *
+ * @param pyramide Un pointeur sur la pyramide (de la même taille que la grille)
+ * @param grille Un pointeur sur la grille résumée
+ * @param modifiees Les tuiles modifiées (voir Tuiles, active[ty * nb + tx]),
+ * NULL pour tout recalculer
+ */
+void maj_pyramide(Pyramide *pyramide, const Grille *grille, const unsigned char *modifiees)
+{
+    // + lisible
+    unsigned int taille = pyramide -> taille;
+    unsigned int nb = (taille + TAILLE_TUILE - 1) / TAILLE_TUILE;
+
+    if (taille == 0) return;
+    if (modifiees == NULL || pyramide -> obsolete)
+    {
+        maj_carre(pyramide, grille, 0, 0, taille, taille);
+        pyramide -> obsolete = 0;
+        return;
+    }
+
+    for (unsigned int ty = 0; ty < nb; ty++)
+    {
+        for (unsigned int tx = 0; tx < nb; tx++)
+        {
+            if (!modifiees[(size_t) ty * nb + tx]) continue;
+
+            unsigned int x = tx * TAILLE_TUILE, y = ty * TAILLE_TUILE;
+            maj_carre(pyramide, grille, x, y, min_uint(x + TAILLE_TUILE, taille), min_uint(y + TAILLE_TUILE, taille));
+        }
+    }
+}
+
+
+
+/**
+ * @brief Convertit une ligne d'un niveau de la pyramide en pixels ARGB8888.
+ * Les cases hors du niveau sont noires.
+ *
+ * En couleur, une case prend la couleur de sa cellule la plus vieille
+ * (orange si l'une de ses cellules est originelle, avec PALETTE_ORIGINE).
+ * Sinon, elle est grise, d'autant plus claire que la densité est grande: une
+ * case non vide n'est jamais noire, pour ne pas perdre les cellules isolées.
+ *
+ * @param pyramide Un pointeur sur la pyramide (à jour)
+ * @param k Le niveau (entre 1 et pyramide -> nb_niveaux)
+ * @param ligne La ligne du niveau
+ * @param colonne La colonne du niveau du premier pixel
+ * @param pixels Le premier pixel de la ligne
+ * @param n Le nombre de pixels
+ * @param table La table de couleurs (voir table_palette())
+ * @param couleur 1 si le jeu est affiché en couleur, 0 sinon
+ */
+void niveau2pixels(const Pyramide *pyramide, unsigned int k, int64_t ligne, int64_t colonne, uint32_t *pixels,
+                   unsigned int n, const uint32_t *table, char couleur)
+{
+    // + lisible
+    const NiveauPyramide *niveau = &(pyramide -> niveaux[k - 1]);
+    int64_t taille = niveau -> taille;
+
+    if (ligne < 0 || ligne >= taille)
+    {
+        for (unsigned int j = 0; j < n; j++) pixels[j] = table[0];
+        return;
+    }
+
+    const uint8_t *densite = niveau -> densite + ligne * taille;
+    const cellule *max = niveau -> cellule + ligne * taille;
+    for (unsigned int j = 0; j < n; j++)
+    {
+        int64_t c = colonne + j;
+        if (c < 0 || c >= taille || max[c] == 0)
+        {
+            pixels[j] = table[0];
+            continue;
+        }
+        if (couleur)
+        {
+            pixels[j] = table[max[c]];
+            continue;
+        }
+
+        uint32_t gris = 64 + densite[c] * 3 / 4;
+        pixels[j] = 0xFF000000 | (gris << 16) | (gris << 8) | gris;
+    }
+}
+
+
+
+/**
+ * @brief Libère la mémoire allouée pour la pyramide.
+ *
+ * @param pyramide Un pointeur sur la pyramide
+ */
+void free_pyramide(Pyramide *pyramide)
+{
+    for (unsigned int k = 1; k <= pyramide -> nb_niveaux; k++)
+    {
+        free(pyramide -> niveaux[k - 1].densite);
+        free(pyramide -> niveaux[k - 1].cellule);
+    }
+    free(pyramide -> niveaux);
+    free(pyramide);
+}
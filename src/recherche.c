@@ -0,0 +1,243 @@
+/**
+ * @file recherche.c
+ * @author M3tex
+ * @brief Fichier contenant la recherche de soupes: on calcule des milliers de
+ * configurations aléatoires (voir https://conwaylife.com/wiki/Soup) pour
+ * trouver celles qui vivent longtemps ou qui finissent en oscillateurs rares.
+ *
+ * Chaque thread a son propre Jeu (sa grille et son moteur) et prend les soupes
+ * une par une: il n'y a rien à partager pendant le calcul. Une soupe est
+ * calculée jusqu'à ce qu'elle devienne périodique (voir cycles.c) ou jusqu'au
+ * nombre maximum de générations, puis son résultat est ajouté au fichier des
+ * résultats.
+ *
+ * Chaque soupe est reproductible: elle ne dépend que de sa graine (et des
+ * paramètres de la recherche), pas du thread qui l'a calculée.
+ * @version 0.1
+ * @date 2022-12-30
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "recherche.h"
+#include "logique.h"
+#include "cycles.h"
+#include "parallele.h"
+#include "regle.h"
+#include "soupe.h"
+#include "topologie.h"
+#include "utilitaires.h"
+
+
+
+/**
+ * @brief Remplit toute la grille du jeu avec la soupe i de la recherche (voir
+ * soupe.c), et remet les stats à zéro.
+ */
+static void prepare_soupe(Jeu *jeu, const Recherche *recherche, unsigned long int i)
+{
+    free(jeu -> statistiques);
+    jeu -> statistiques = init_stats();
+
+    // Les lignes sont tirées sur le thread de la soupe: les autres threads calculent leurs propres soupes
+    Soupe soupe = recherche -> soupe;
+    soupe.graine += i;
+    jeu -> statistiques -> nb_cellules_depart = remplit_soupe(jeu -> grille, &soupe, NULL);
+    jeu -> statistiques -> nb_cell_originelles = jeu -> statistiques -> nb_cellules_depart;
+    jeu -> statistiques -> en_vie = jeu -> statistiques -> nb_cellules_depart;
+}
+
+
+
+/**
+ * @brief Compte les cellules vivantes de la génération actuelle.
+ */
+static unsigned long int population(Jeu *jeu)
+{
+    synchronise_grille(jeu);
+
+    // + lisible
+    Grille *grille = jeu -> grille;
+
+    unsigned long int en_vie = 0;
+    for (unsigned int i = 0; i < grille -> taille; i++)
+    {
+        for (unsigned int j = 0; j < grille -> taille; j++) en_vie += (CELLULE(grille, i, j) != 0);
+    }
+    return en_vie;
+}
+
+
+
+/**
+ * @brief La tâche de chaque thread (voir Tache): on prend la prochaine soupe
+ * jusqu'à ce qu'il n'y en ait plus.
+ *
+ * @param contexte Un pointeur sur la Recherche
+ * @param indice Le numéro du thread (inutilisé)
+ */
+static void cherche_soupes(void *contexte, unsigned int indice)
+{
+    (void) indice;
+
+    // + lisible
+    Recherche *recherche = (Recherche *) contexte;
+
+    // Un seul thread par soupe: le parallélisme vient des soupes calculées en même temps
+    Jeu *jeu = init_jeu(recherche -> taille, recherche -> taille, recherche -> taille);
+    jeu -> moteur = recherche -> moteur;
+    jeu -> regle = recherche -> regle;
+    jeu -> topologie = recherche -> topologie;
+    jeu -> niveau_stats = STATS_AUCUNES;
+
+    unsigned long int i;
+    while ((i = atomic_fetch_add(&(recherche -> suivante), 1)) < recherche -> nb_soupes)
+    {
+        uint64_t graine = recherche -> soupe.graine + i;
+        prepare_soupe(jeu, recherche, i);
+        init_moteur(jeu);
+        jeu -> cycles = init_cycles(jeu);
+
+        Stats *statistiques = jeu -> statistiques;
+        while (!(statistiques -> periode) && statistiques -> generations < recherche -> max_generations) maj_grille(jeu);
+
+        // La durée de vie d'une soupe qui ne s'est pas stabilisée est le maximum de générations
+        unsigned long int periode = statistiques -> periode;
+        unsigned long int duree = periode ? statistiques -> debut_cycle : statistiques -> generations;
+        unsigned long int en_vie = population(jeu);
+        free_cycles(jeu -> cycles);
+        jeu -> cycles = NULL;
+
+        // Chaque appel à fprintf() écrit sa ligne d'un coup, même avec plusieurs threads
+        fprintf(recherche -> resultats, "%lu,%lu,%lu,%lu,%s\n", (unsigned long int) graine, en_vie, duree, periode,
+                nom_topologie(recherche -> topologie));
+
+        pthread_mutex_lock(&(recherche -> verrou));
+        if (periode) recherche -> stabilisees++;
+        if (duree > recherche -> plus_longue)
+        {
+            recherche -> plus_longue = duree;
+            recherche -> graine_plus_longue = graine;
+        }
+        if (periode > recherche -> periode_max)
+        {
+            recherche -> periode_max = periode;
+            recherche -> graine_periode_max = graine;
+        }
+        pthread_mutex_unlock(&(recherche -> verrou));
+    }
+    free_jeu(jeu);
+}
+
+
+
+/**
+ * @brief Initialise une instance de la struct Recherche et ouvre le fichier
+ * des résultats (en ajout: les recherches précédentes sont gardées).
+ *
+ * @param moteur Le moteur utilisé (bitboard, scalaire, simd ou table)
+ * @param regle La règle du jeu
+ * @param topologie La topologie de la grille de chaque soupe
+ * @param taille La taille de la grille de chaque soupe
+ * @param nb_soupes Le nombre de soupes à calculer
+ * @param max_generations Le nombre de générations après lequel on abandonne une soupe
+ * @param soupe Les paramètres des soupes (soupe.graine est la graine de la première)
+ * @param fichier Le fichier des résultats (CSV)
+ * @return Recherche* Un pointeur sur la Recherche
+ */
+Recherche *init_recherche(Moteur moteur, Regle regle, Topologie topologie, unsigned int taille, unsigned long int nb_soupes,
+                          unsigned long int max_generations, Soupe soupe, const char *fichier)
+{
+    // La détection de cycles ne gère que les moteurs bornés
+    if (moteur == MOTEUR_HASHLIFE || moteur == MOTEUR_UNIVERS)
+    {
+        quitter("La recherche de soupes n'utilise que les moteurs bitboard, scalaire, simd et table\n", 1);
+    }
+
+    Recherche *recherche = (Recherche *) malloc(sizeof(Recherche));
+    if (recherche == NULL) quitter("Impossible d'allouer de la mémoire pour la recherche\n", 2);
+
+    recherche -> resultats = fopen(fichier, "a");
+    if (recherche -> resultats == NULL)
+    {
+        perror(fichier);
+        quitter("Impossible d'ouvrir le fichier des résultats\n", 1);
+    }
+
+    // Un fichier neuf commence par l'entête
+    if (ftell(recherche -> resultats) == 0) fprintf(recherche -> resultats, "graine,population,duree,periode,topologie\n");
+
+    recherche -> moteur = moteur;
+    recherche -> regle = regle;
+    recherche -> topologie = topologie;
+    recherche -> taille = taille;
+    recherche -> nb_soupes = nb_soupes;
+    recherche -> max_generations = max_generations;
+    recherche -> soupe = soupe;
+    atomic_init(&(recherche -> suivante), 0);
+    pthread_mutex_init(&(recherche -> verrou), NULL);
+    recherche -> stabilisees = 0;
+    recherche -> plus_longue = 0;
+    recherche -> graine_plus_longue = soupe.graine;
+    recherche -> periode_max = 0;
+    recherche -> graine_periode_max = soupe.graine;
+    return recherche;
+}
+
+
+
+/**
+ * @brief Calcule toutes les soupes de la recherche, puis affiche le résumé et
+ * le débit obtenu (en soupes par seconde).
+ *
+ * @param recherche Un pointeur sur la Recherche
+ * @param nb_threads Le nombre de soupes calculées en même temps
+ */
+void lance_recherche(Recherche *recherche, unsigned int nb_threads)
+{
+    char regle[24];
+    ecrit_regle(&(recherche -> regle), regle);
+    printf("Recherche de %lu soupes de %ux%u en %s (graines %lu à %lu) sur %u threads\n", recherche -> nb_soupes,
+           recherche -> taille, recherche -> taille, regle, (unsigned long int) recherche -> soupe.graine,
+           (unsigned long int) (recherche -> soupe.graine + recherche -> nb_soupes - 1), nb_threads);
+    if (recherche -> topologie != TOPOLOGIE_BORNEE) printf("Topologie: %s\n", nom_topologie(recherche -> topologie));
+
+    struct timespec debut, fin;
+    clock_gettime(CLOCK_MONOTONIC, &debut);
+    if (nb_threads > 1)
+    {
+        Pool *pool = init_pool(nb_threads);
+        execute_pool(pool, cherche_soupes, recherche);
+        free_pool(pool);
+    }
+    else cherche_soupes(recherche, 0);
+    clock_gettime(CLOCK_MONOTONIC, &fin);
+
+    double duree = (fin.tv_sec - debut.tv_sec) + (fin.tv_nsec - debut.tv_nsec) * 1e-9;
+    printf("%lu soupes calculées en %.3f s: %.1f soupes/s\n", recherche -> nb_soupes, duree, recherche -> nb_soupes / duree);
+    printf("  - %lu soupes sont devenues périodiques en moins de %lu générations\n", recherche -> stabilisees, recherche -> max_generations);
+    printf("  - la plus longue a vécu %lu générations (graine %lu)\n", recherche -> plus_longue, (unsigned long int) recherche -> graine_plus_longue);
+    if (recherche -> periode_max)
+    {
+        printf("  - la plus grande période est %lu (graine %lu)\n", recherche -> periode_max, (unsigned long int) recherche -> graine_periode_max);
+    }
+}
+
+
+
+/**
+ * @brief Ferme le fichier des résultats et libère la mémoire allouée dans
+ * init_recherche()
+ *
+ * @param recherche Un pointeur sur la Recherche à libérer
+ */
+void free_recherche(Recherche *recherche)
+{
+    fclose(recherche -> resultats);
+    pthread_mutex_destroy(&(recherche -> verrou));
+    free(recherche);
+}
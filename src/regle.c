@@ -0,0 +1,122 @@
+/**
+ * @file regle.c
+ * @author M3tex
+ * @brief Fichier contenant les règles 'Life-like': une cellule morte naît si
+ * son nombre de voisins est dans B, une cellule vivante survit si son nombre
+ * de voisins est dans S (le jeu de la vie est B3/S23).
+ *
+ * Une règle est compilée en 2 masques de 9 bits (un bit par nombre de
+ * voisins), lus sans branchement par les noyaux de calcul. Les règles les plus
+ * courantes ont en plus un noyau spécialisé (voir AVEC_REGLE): le jeu de la
+ * vie ne paie donc rien pour les autres règles.
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <ctype.h>
+#include "regle.h"
+
+
+
+/**
+ * @brief Retourne la règle du jeu de la vie (B3/S23).
+ *
+ * @return Regle La règle
+ */
+Regle regle_vie()
+{
+    Regle regle = {NAISSANCE_VIE, SURVIE_VIE, REGLE_VIE};
+    return regle;
+}
+
+
+
+/**
+ * @brief Cherche la règle spécialisée qui correspond aux masques de la règle.
+ */
+static TypeRegle type_regle(uint16_t naissance, uint16_t survie)
+{
+    if (naissance == NAISSANCE_VIE && survie == SURVIE_VIE) return REGLE_VIE;
+    if (naissance == NAISSANCE_HIGHLIFE && survie == SURVIE_HIGHLIFE) return REGLE_HIGHLIFE;
+    if (naissance == NAISSANCE_JOUR_NUIT && survie == SURVIE_JOUR_NUIT) return REGLE_JOUR_NUIT;
+    if (naissance == NAISSANCE_GRAINES && survie == SURVIE_GRAINES) return REGLE_GRAINES;
+    return REGLE_GENERIQUE;
+}
+
+
+
+/**
+ * @brief Retourne la règle dont les masques sont naissance et survie (voir Regle).
+ *
+ * @param naissance Le masque des naissances (bits 0 à 8)
+ * @param survie Le masque des survies (bits 0 à 8)
+ * @return Regle La règle
+ */
+Regle regle_masques(uint16_t naissance, uint16_t survie)
+{
+    Regle regle = {naissance, survie, type_regle(naissance, survie)};
+    return regle;
+}
+
+
+
+/**
+ * @brief Lit une règle en notation B/S, par exemple "B36/S23" (majuscules ou
+ * minuscules, B et S dans n'importe quel ordre, chacun au plus une fois).
+ *
+ * @param texte La règle
+ * @param regle Un pointeur sur la Regle où stocker le résultat
+ * @return char 1 si la règle est valide, 0 sinon
+ */
+char lit_regle(const char *texte, Regle *regle)
+{
+    uint16_t masques[2] = {0, 0};
+    char vus[2] = {0, 0};
+
+    const char *c = texte;
+    while (1)
+    {
+        // Une partie: B ou S, puis des chiffres de 0 à 8
+        char lettre = toupper((unsigned char) *c);
+        if (lettre != 'B' && lettre != 'S') return 0;
+        unsigned int partie = (lettre == 'S');
+        if (vus[partie]) return 0;
+        vus[partie] = 1;
+
+        for (c++; *c >= '0' && *c <= '8'; c++) masques[partie] |= 1 << (*c - '0');
+
+        if (*c == '\0') break;
+        if (*c != '/') return 0;
+        c++;
+    }
+    if (!vus[0] || !vus[1]) return 0;
+
+    *regle = regle_masques(masques[0], masques[1]);
+    return 1;
+}
+
+
+
+/**
+ * @brief Écrit la règle en notation B/S (par exemple "B36/S23").
+ *
+ * @param regle Un pointeur sur la Regle
+ * @param texte Le tableau où écrire la règle (au moins 22 caractères)
+ */
+void ecrit_regle(const Regle *regle, char *texte)
+{
+    *texte++ = 'B';
+    for (unsigned int n = 0; n <= 8; n++)
+    {
+        if ((regle -> naissance >> n) & 1) *texte++ = '0' + n;
+    }
+    *texte++ = '/';
+    *texte++ = 'S';
+    for (unsigned int n = 0; n <= 8; n++)
+    {
+        if ((regle -> survie >> n) & 1) *texte++ = '0' + n;
+    }
+    *texte = '\0';
+}
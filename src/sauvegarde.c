@@ -0,0 +1,579 @@
+/**
+ * @file sauvegarde.c
+ * @author M3tex
+ * @brief Fichier contenant les sauvegardes: l'état complet d'une partie
+ * (cellules, statistiques, caméra) est écrit dans un fichier binaire compact,
+ * pour pouvoir reprendre une longue simulation plus tard (voir --reprise).
+ *
+ * Format (entiers en little-endian):
+ * - "GOLS", la version du format (u32), le moteur (u32), la taille de la grille (u32)
+ * - la règle: les masques naissance et survie (u16, depuis la version 2)
+ * - la topologie (u32, depuis la version 3)
+ * - les 7 compteurs de Stats (u64)
+ * - la caméra: origin_x, origin_y (i64), width (u32)
+ * - le nombre de zones (u64), puis chaque zone: x, y (i64), taille (u32) et ses
+ *   taille x taille cellules (ligne par ligne) compressées en plages: une
+ *   longueur (entier de taille variable, 7 bits par octet) puis l'octet de cellule.
+ *
+ * Les moteurs bornés n'ont qu'une zone (la grille), les moteurs non bornés une
+ * zone par carré de 64 x 64 cellules non vide. Les sauvegardes d'une version
+ * précédente restent lisibles (la règle et la topologie manquantes sont alors
+ * celles du jeu).
+ * @version 0.1
+ * @date 2022-12-27
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sauvegarde.h"
+#include "logique.h"
+#include "affichage.h"
+#include "hashlife.h"
+#include "univers.h"
+#include "regle.h"
+#include "table.h"
+#include "utilitaires.h"
+
+
+#define MAGIQUE_SAUVEGARDE "GOLS"
+#define VERSION_SAUVEGARDE 3
+
+// Les masques d'une règle n'ont que 9 bits (0 à 8 voisins)
+#define MASQUE_REGLE 0x1FF
+
+// Une zone ne peut pas être plus grande que ça (pour rejeter les fichiers corrompus)
+#define TAILLE_ZONE_MAX 65536
+
+
+
+/**
+ * @brief Le contenu d'une sauvegarde en cours d'écriture.
+ */
+typedef struct Tampon {
+    uint8_t *octets;
+    size_t taille;
+    size_t capacite;
+} Tampon;
+
+/**
+ * @brief Le contenu d'une sauvegarde en cours de lecture: on lit de pos
+ * jusqu'à fin. erreur passe à 1 si on essaye de lire après la fin.
+ */
+typedef struct Lecteur {
+    const uint8_t *pos;
+    const uint8_t *fin;
+    char erreur;
+} Lecteur;
+
+/**
+ * @brief Ce dont a besoin ecrit_bloc_hashlife() (voir blocs_hashlife()).
+ */
+typedef struct ContexteHashlife {
+    Tampon *tampon;
+    HashLife *hl;
+    Grille *bloc;
+    uint64_t nb_zones;
+} ContexteHashlife;
+
+
+
+/**
+ * @brief Ajoute n octets à la fin du tampon.
+ */
+static void ecrit_octets(Tampon *tampon, const void *octets, size_t n)
+{
+    if (tampon -> taille + n > tampon -> capacite)
+    {
+        size_t capacite = tampon -> capacite ? tampon -> capacite : 4096;
+        while (capacite < tampon -> taille + n) capacite *= 2;
+        tampon -> octets = (uint8_t *) realloc(tampon -> octets, capacite);
+        if (tampon -> octets == NULL) quitter("Impossible d'allouer de la mémoire pour la sauvegarde\n", 2);
+        tampon -> capacite = capacite;
+    }
+    memcpy(tampon -> octets + tampon -> taille, octets, n);
+    tampon -> taille += n;
+}
+
+
+
+/**
+ * @brief Ajoute un entier de nb_octets octets (en little-endian) à la fin du tampon.
+ */
+static void ecrit_entier(Tampon *tampon, uint64_t valeur, unsigned int nb_octets)
+{
+    uint8_t octets[8];
+    for (unsigned int i = 0; i < nb_octets; i++) octets[i] = (uint8_t) (valeur >> (8 * i));
+    ecrit_octets(tampon, octets, nb_octets);
+}
+
+
+
+/**
+ * @brief Ajoute un entier de taille variable: 7 bits par octet, le bit de poids
+ * fort indique qu'il y a un octet après.
+ */
+static void ecrit_varint(Tampon *tampon, uint64_t valeur)
+{
+    uint8_t octets[10];
+    unsigned int n = 0;
+    while (valeur >= 0x80)
+    {
+        octets[n++] = (uint8_t) (valeur | 0x80);
+        valeur >>= 7;
+    }
+    octets[n++] = (uint8_t) valeur;
+    ecrit_octets(tampon, octets, n);
+}
+
+
+
+/**
+ * @brief Ajoute une zone: la grille, dont la cellule (0, 0) est en (x, y).
+ */
+static void ecrit_zone(Tampon *tampon, Grille *grille, int64_t x, int64_t y)
+{
+    // + lisible
+    unsigned int taille = grille -> taille;
+
+    ecrit_entier(tampon, (uint64_t) x, 8);
+    ecrit_entier(tampon, (uint64_t) y, 8);
+    ecrit_entier(tampon, taille, 4);
+
+    // Les plages de cellules identiques continuent d'une ligne à l'autre
+    cellule valeur = CELLULE(grille, 0, 0);
+    uint64_t longueur = 0;
+    for (unsigned int i = 0; i < taille; i++)
+    {
+        for (unsigned int j = 0; j < taille; j++)
+        {
+            cellule cell = CELLULE(grille, i, j);
+            if (cell == valeur)
+            {
+                longueur++;
+                continue;
+            }
+            ecrit_varint(tampon, longueur);
+            ecrit_octets(tampon, &valeur, 1);
+            valeur = cell;
+            longueur = 1;
+        }
+    }
+    ecrit_varint(tampon, longueur);
+    ecrit_octets(tampon, &valeur, 1);
+}
+
+
+
+/**
+ * @brief Ajoute la zone de 64 x 64 cellules de l'univers hashlife dont le coin
+ * supérieur gauche est (x, y).
+ */
+static void ecrit_bloc_hashlife(void *contexte, int64_t x, int64_t y)
+{
+    ContexteHashlife *ctx = (ContexteHashlife *) contexte;
+    hashlife2grille(ctx -> hl, ctx -> bloc, x, y);
+    ecrit_zone(ctx -> tampon, ctx -> bloc, x, y);
+    ctx -> nb_zones++;
+}
+
+
+
+/**
+ * @brief Ajoute les cellules du moteur du jeu et retourne le nombre de zones écrites.
+ */
+static uint64_t ecrit_cellules(Tampon *tampon, Jeu *jeu)
+{
+    // Les moteurs bornés: toute la grille
+    if (jeu -> moteur != MOTEUR_HASHLIFE && jeu -> moteur != MOTEUR_UNIVERS)
+    {
+        synchronise_grille(jeu);
+        ecrit_zone(tampon, jeu -> grille, 0, 0);
+        return 1;
+    }
+
+    // Les moteurs non bornés: chaque carré de TAILLE_BLOC x TAILLE_BLOC cellules non vide
+    Grille *bloc = init_grille(TAILLE_BLOC);
+    uint64_t nb_zones = 0;
+    if (jeu -> moteur == MOTEUR_HASHLIFE)
+    {
+        ContexteHashlife contexte = {tampon, jeu -> hashlife, bloc, 0};
+        blocs_hashlife(jeu -> hashlife, ecrit_bloc_hashlife, &contexte);
+        nb_zones = contexte.nb_zones;
+    }
+    else
+    {
+        // + lisible
+        Univers *univers = jeu -> univers;
+        unsigned int c = univers -> courant;
+
+        for (size_t b = 0; b < univers -> nb_blocs; b++)
+        {
+            Bloc *source = univers -> blocs[b];
+            memset(bloc -> matrice - bloc -> pas - ALIGNEMENT_GRILLE, 0, (size_t) (TAILLE_BLOC + 2) * bloc -> pas);
+            for (unsigned int i = 0; i < TAILLE_BLOC; i++)
+            {
+                for (unsigned int j = 0; j < TAILLE_BLOC; j++)
+                {
+                    if (!((source -> vivantes[c][i] >> j) & 1)) continue;
+                    CELLULE(bloc, i, j) = (cellule) ((((source -> originelles[i] >> j) & 1) << 7) | 1);
+                }
+            }
+            ecrit_zone(tampon, bloc, source -> bx * TAILLE_BLOC, source -> by * TAILLE_BLOC);
+            nb_zones++;
+        }
+    }
+    free_grille(bloc);
+    return nb_zones;
+}
+
+
+
+/**
+ * @brief Écrit l'état du jeu (cellules, statistiques et caméra) dans un fichier.
+ *
+ * L'écriture est atomique: on écrit d'abord dans fichier.tmp, puis on le
+ * renomme. En cas d'arrêt brutal pendant l'écriture, l'ancienne sauvegarde
+ * reste donc intacte.
+ *
+ * @param fichier Le chemin du fichier
+ * @param jeu Un pointeur sur le Jeu (celui qui possède le moteur)
+ * @return char 1 si la sauvegarde a été écrite, 0 sinon
+ */
+char ecrit_sauvegarde(const char *fichier, Jeu *jeu)
+{
+    // + lisible
+    Stats *statistiques = jeu -> statistiques;
+    Camera *cam = jeu -> cam;
+
+    Tampon tampon = {NULL, 0, 0};
+    ecrit_octets(&tampon, MAGIQUE_SAUVEGARDE, 4);
+    ecrit_entier(&tampon, VERSION_SAUVEGARDE, 4);
+    ecrit_entier(&tampon, jeu -> moteur, 4);
+    ecrit_entier(&tampon, jeu -> grille -> taille, 4);
+    ecrit_entier(&tampon, jeu -> regle.naissance, 2);
+    ecrit_entier(&tampon, jeu -> regle.survie, 2);
+    ecrit_entier(&tampon, jeu -> topologie, 4);
+
+    ecrit_entier(&tampon, statistiques -> nb_cell_nes, 8);
+    ecrit_entier(&tampon, statistiques -> nb_cell_mortes, 8);
+    ecrit_entier(&tampon, statistiques -> nb_cell_originelles, 8);
+    ecrit_entier(&tampon, statistiques -> nb_cellules_depart, 8);
+    ecrit_entier(&tampon, statistiques -> en_vie, 8);
+    ecrit_entier(&tampon, statistiques -> generations, 8);
+    ecrit_entier(&tampon, statistiques -> nb_tuiles_actives, 8);
+
+    ecrit_entier(&tampon, (uint64_t) cam -> origin_x, 8);
+    ecrit_entier(&tampon, (uint64_t) cam -> origin_y, 8);
+    ecrit_entier(&tampon, cam -> width, 4);
+
+    // Le nombre de zones n'est connu qu'à la fin: on le complète après coup
+    size_t position_nb_zones = tampon.taille;
+    ecrit_entier(&tampon, 0, 8);
+    uint64_t nb_zones = ecrit_cellules(&tampon, jeu);
+    for (unsigned int i = 0; i < 8; i++) tampon.octets[position_nb_zones + i] = (uint8_t) (nb_zones >> (8 * i));
+
+    // On écrit dans un fichier temporaire, puis on le renomme
+    size_t longueur = strlen(fichier);
+    char *temporaire = (char *) malloc(longueur + 5);
+    if (temporaire == NULL) quitter("Impossible d'allouer de la mémoire pour la sauvegarde\n", 2);
+    memcpy(temporaire, fichier, longueur);
+    memcpy(temporaire + longueur, ".tmp", 5);
+
+    char succes = 0;
+    FILE *f = fopen(temporaire, "wb");
+    if (f != NULL)
+    {
+        succes = fwrite(tampon.octets, 1, tampon.taille, f) == tampon.taille;
+        succes = (fflush(f) == 0) && succes;
+        succes = (fsync(fileno(f)) == 0) && succes;
+        succes = (fclose(f) == 0) && succes;
+        succes = succes && rename(temporaire, fichier) == 0;
+        if (!succes) remove(temporaire);
+    }
+    if (!succes) print_redb("Impossible d'écrire la sauvegarde\n");
+
+    free(temporaire);
+    free(tampon.octets);
+    return succes;
+}
+
+
+
+/**
+ * @brief Lit un entier de nb_octets octets (en little-endian).
+ */
+static uint64_t lit_entier(Lecteur *lecteur, unsigned int nb_octets)
+{
+    if (lecteur -> fin - lecteur -> pos < nb_octets)
+    {
+        lecteur -> erreur = 1;
+        return 0;
+    }
+
+    uint64_t valeur = 0;
+    for (unsigned int i = 0; i < nb_octets; i++) valeur |= (uint64_t) lecteur -> pos[i] << (8 * i);
+    lecteur -> pos += nb_octets;
+    return valeur;
+}
+
+
+
+/**
+ * @brief Lit un entier de taille variable (voir ecrit_varint()).
+ */
+static uint64_t lit_varint(Lecteur *lecteur)
+{
+    uint64_t valeur = 0;
+    for (unsigned int decalage = 0; decalage < 64; decalage += 7)
+    {
+        if (lecteur -> pos >= lecteur -> fin) break;
+        uint8_t octet = *(lecteur -> pos++);
+        valeur |= (uint64_t) (octet & 0x7F) << decalage;
+        if (!(octet & 0x80)) return valeur;
+    }
+    lecteur -> erreur = 1;
+    return 0;
+}
+
+
+
+/**
+ * @brief Lit les cellules d'une zone dans une grille de la taille de la zone.
+ *
+ * @return char 1 si la zone est valide, 0 sinon
+ */
+static char lit_zone(Lecteur *lecteur, Grille *grille)
+{
+    // + lisible
+    uint64_t taille = grille -> taille;
+
+    uint64_t i = 0, j = 0;
+    for (uint64_t restantes = taille * taille; restantes > 0;)
+    {
+        uint64_t longueur = lit_varint(lecteur);
+        cellule valeur = (cellule) lit_entier(lecteur, 1);
+        if (lecteur -> erreur || longueur == 0 || longueur > restantes) return 0;
+        restantes -= longueur;
+
+        // Les cellules mortes sont déjà à 0
+        if (!valeur)
+        {
+            i += (j + longueur) / taille;
+            j = (j + longueur) % taille;
+            continue;
+        }
+        for (; longueur > 0; longueur--)
+        {
+            CELLULE(grille, i, j) = valeur;
+            if (++j == taille) j = 0, i++;
+        }
+    }
+    return 1;
+}
+
+
+
+/**
+ * @brief Remplace le contenu du jeu par celui d'une sauvegarde (voir
+ * ecrit_sauvegarde()). Le fichier est projeté en mémoire (mmap) puis lu
+ * directement.
+ *
+ * Remplace aussi init_moteur(): le moteur du jeu (jeu -> moteur) est
+ * initialisé avec les cellules de la sauvegarde, qui peut avoir été écrite
+ * avec un autre moteur. La partie reprend avec la règle et la topologie de la
+ * sauvegarde.
+ *
+ * @param fichier Le chemin du fichier
+ * @param jeu Un pointeur sur le Jeu
+ * @return char 1 si la sauvegarde a été chargée, 0 sinon
+ */
+char charge_sauvegarde(const char *fichier, Jeu *jeu)
+{
+    // + lisible
+    Grille *grille = jeu -> grille;
+    Stats *statistiques = jeu -> statistiques;
+    Camera *cam = jeu -> cam;
+
+    int fd = open(fichier, O_RDONLY);
+    if (fd < 0)
+    {
+        print_redb("Impossible d'ouvrir la sauvegarde. Vérifiez que le nom est correct.\n");
+        return 0;
+    }
+    struct stat infos;
+    if (fstat(fd, &infos) != 0 || infos.st_size == 0)
+    {
+        close(fd);
+        return 0;
+    }
+    const uint8_t *donnees = (const uint8_t *) mmap(NULL, infos.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (donnees == MAP_FAILED) return 0;
+
+    Lecteur lecteur = {donnees, donnees + infos.st_size, 0};
+    char valide = infos.st_size >= 4 && !memcmp(donnees, MAGIQUE_SAUVEGARDE, 4);
+    lecteur.pos += valide ? 4 : 0;
+    uint64_t version = valide ? lit_entier(&lecteur, 4) : 0;
+    valide = valide && version >= 1 && version <= VERSION_SAUVEGARDE;
+    if (!valide)
+    {
+        munmap((void *) donnees, infos.st_size);
+        print_redb("Ce fichier n'est pas une sauvegarde valide\n");
+        return 0;
+    }
+    lit_entier(&lecteur, 4);   // Le moteur utilisé pour la sauvegarde (le nôtre peut être différent)
+    lit_entier(&lecteur, 4);   // La taille de la grille
+
+    // Les versions 1 n'ont pas de règle: on garde celle du jeu
+    Regle regle = jeu -> regle;
+    if (version >= 2)
+    {
+        uint16_t naissance = lit_entier(&lecteur, 2);
+        uint16_t survie = lit_entier(&lecteur, 2);
+        regle = regle_masques(naissance & MASQUE_REGLE, survie & MASQUE_REGLE);
+        if (naissance > MASQUE_REGLE || survie > MASQUE_REGLE) lecteur.erreur = 1;
+    }
+
+    // Avant la version 3, la topologie est celle du jeu
+    Topologie topologie = jeu -> topologie;
+    if (version >= 3)
+    {
+        uint64_t lue = lit_entier(&lecteur, 4);
+        if (lue > TOPOLOGIE_KLEIN) lecteur.erreur = 1;
+        else topologie = (Topologie) lue;
+    }
+
+    Stats lues = {0};
+    lues.nb_cell_nes = lit_entier(&lecteur, 8);
+    lues.nb_cell_mortes = lit_entier(&lecteur, 8);
+    lues.nb_cell_originelles = lit_entier(&lecteur, 8);
+    lues.nb_cellules_depart = lit_entier(&lecteur, 8);
+    lues.en_vie = lit_entier(&lecteur, 8);
+    lues.generations = lit_entier(&lecteur, 8);
+    lues.nb_tuiles_actives = lit_entier(&lecteur, 8);
+
+    int64_t origin_x = (int64_t) lit_entier(&lecteur, 8);
+    int64_t origin_y = (int64_t) lit_entier(&lecteur, 8);
+    unsigned int width = lit_entier(&lecteur, 4);
+    uint64_t nb_zones = lit_entier(&lecteur, 8);
+    valide = !lecteur.erreur;
+    if (!valide)
+    {
+        munmap((void *) donnees, infos.st_size);
+        print_redb("La sauvegarde est corrompue ou ne rentre pas dans la grille\n");
+        return 0;
+    }
+
+    // Le moteur calcule avec la règle et la topologie de la sauvegarde (le moteur table a une table par règle)
+    jeu -> regle = regle;
+    jeu -> topologie = topologie;
+    if (jeu -> moteur == MOTEUR_TABLE) init_table(&(jeu -> regle));
+
+    // On part d'une grille vide: les moteurs non bornés sont initialisés vides, puis on y ajoute chaque zone
+    memset(grille -> matrice - grille -> pas - ALIGNEMENT_GRILLE, 0, (size_t) (grille -> taille + 2) * grille -> pas);
+    char borne = (jeu -> moteur != MOTEUR_HASHLIFE && jeu -> moteur != MOTEUR_UNIVERS);
+    if (!borne) init_moteur(jeu);
+
+    Grille *zone = NULL;
+    for (uint64_t z = 0; z < nb_zones && valide; z++)
+    {
+        int64_t x = (int64_t) lit_entier(&lecteur, 8);
+        int64_t y = (int64_t) lit_entier(&lecteur, 8);
+        uint64_t taille = lit_entier(&lecteur, 4);
+        valide = !lecteur.erreur && taille > 0 && taille <= TAILLE_ZONE_MAX;
+
+        // Les moteurs bornés: la zone doit rentrer dans la grille
+        valide = valide && (!borne || (x >= 0 && y >= 0 && x + taille <= grille -> taille && y + taille <= grille -> taille));
+        if (!valide) break;
+
+        // La grille de lecture est réutilisée tant que les zones ont la même taille
+        if (zone == NULL || zone -> taille != taille)
+        {
+            if (zone != NULL) free_grille(zone);
+            zone = init_grille(taille);
+        }
+        else memset(zone -> matrice - zone -> pas - ALIGNEMENT_GRILLE, 0, (size_t) (taille + 2) * zone -> pas);
+        valide = lit_zone(&lecteur, zone);
+        if (!valide) break;
+
+        if (jeu -> moteur == MOTEUR_HASHLIFE) ajoute_grille_hashlife(jeu -> hashlife, zone, x, y);
+        else if (jeu -> moteur == MOTEUR_UNIVERS) grille2univers(zone, jeu -> univers, x, y);
+        else
+        {
+            for (uint64_t i = 0; i < taille; i++) memcpy(&CELLULE(grille, y + i, x), &CELLULE(zone, i, 0), taille);
+        }
+    }
+    if (zone != NULL) free_grille(zone);
+    munmap((void *) donnees, infos.st_size);
+    if (!valide)
+    {
+        print_redb("La sauvegarde est corrompue ou ne rentre pas dans la grille\n");
+        return 0;
+    }
+
+    if (borne) init_moteur(jeu);
+    jeu -> grille_obsolete = !borne;
+    *statistiques = lues;
+    jeu -> derniere_sauvegarde = lues.generations;
+
+    // La caméra reprend sa position (et son zoom si possible)
+    if (width >= 1 && width <= cam -> max_width) regle_zoom(jeu, width);
+    cam -> origin_x = origin_x;
+    cam -> origin_y = origin_y;
+    update_camera(cam);
+    return 1;
+}
+
+
+
+/**
+ * @brief Écrit une sauvegarde si on vient de passer un multiple de
+ * jeu -> sauvegarde_tous générations (et qu'un fichier de sauvegarde a été donné).
+ *
+ * @param jeu Un pointeur sur le Jeu (celui qui possède le moteur)
+ */
+void sauvegarde_periodique(Jeu *jeu)
+{
+    // + lisible
+    unsigned long int tous = jeu -> sauvegarde_tous;
+    unsigned long int generations = jeu -> statistiques -> generations;
+
+    if (jeu -> fichier_sauvegarde == NULL || tous == 0) return;
+    if (generations / tous == jeu -> derniere_sauvegarde / tous) return;
+
+    ecrit_sauvegarde(jeu -> fichier_sauvegarde, jeu);
+    jeu -> derniere_sauvegarde = generations;
+}
+
+
+
+/**
+ * @brief Lit la taille de la grille d'une sauvegarde (sans lire les cellules),
+ * pour créer un jeu de la bonne taille avant charge_sauvegarde().
+ *
+ * @param fichier Le chemin du fichier
+ * @return unsigned int La taille de la grille, 0 si le fichier n'est pas une sauvegarde valide
+ */
+unsigned int taille_sauvegarde(const char *fichier)
+{
+    FILE *f = fopen(fichier, "rb");
+    if (f == NULL) return 0;
+
+    uint8_t entete[16];
+    size_t lus = fread(entete, 1, sizeof(entete), f);
+    fclose(f);
+
+    Lecteur lecteur = {entete + 4, entete + lus, 0};
+    if (lus < sizeof(entete) || memcmp(entete, MAGIQUE_SAUVEGARDE, 4)) return 0;
+    uint64_t version = lit_entier(&lecteur, 4);
+    if (version < 1 || version > VERSION_SAUVEGARDE) return 0;
+    lit_entier(&lecteur, 4);
+    return lit_entier(&lecteur, 4);
+}
@@ -0,0 +1,466 @@
+/**
+ * @file simd.c
+ * @author M3tex
+ * @brief Fichier contenant le moteur 'simd': même format que le moteur scalaire
+ * (1 octet par cellule, avec l'âge et le bit d'origine), mais 16, 32 ou 64
+ * cellules sont calculées à la fois avec les instructions SSE2, AVX2 ou
+ * AVX-512 du processeur. Le meilleur jeu d'instructions est choisi au
+ * lancement (voir init_simd()).
+ * @version 0.1
+ * @date 2022-12-14
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include "simd.h"
+#include "logique.h"
+#include "regle.h"
+#include "utilitaires.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define SIMD_X86
+#endif
+
+
+
+/* Calcule 'largeur' cellules d'une ligne de la grille: h, m et b pointent sur la
+première cellule dans les lignes y - 1, y et y + 1, dst sur la même cellule dans
+la grille suivante. Retourne 1 si au moins une cellule a changé.
+Les statistiques ne sont comptées que si partielles n'est pas NULL. */
+typedef char (*NoyauLigne)(const cellule *h, const cellule *m, const cellule *b, cellule *dst,
+                           unsigned int largeur, Stats *partielles, const Regle *regle);
+
+/* Chaque noyau est écrit une fois (corps), avec un paramètre compte constant:
+le compilateur en fait une version avec et une version sans statistiques, et
+le noyau choisit la bonne selon partielles. Il en fait de même pour chaque
+règle spécialisée (voir AVEC_REGLE). */
+#define NOYAU_AVEC_STATS(nom, corps, cible)                                                            \
+    __attribute__((target(cible)))                                                                      \
+    static char nom(const cellule *h, const cellule *m, const cellule *b, cellule *dst,               \
+                    unsigned int largeur, Stats *partielles, const Regle *regle)                       \
+    {                                                                                                  \
+        if (partielles == NULL)                                                                        \
+        {                                                                                              \
+            AVEC_REGLE(regle, return corps(h, m, b, dst, largeur, NULL, 0, naissance, survie));        \
+        }                                                                                              \
+        AVEC_REGLE(regle, return corps(h, m, b, dst, largeur, partielles, 1, naissance, survie));      \
+        return 0;                                                                                      \
+    }
+
+// Le noyau choisi par init_simd() et son nom
+static NoyauLigne noyau_ligne = NULL;
+static const char *nom_noyau = "aucun";
+
+
+
+/**
+ * @brief Noyau de secours si le processeur n'a aucun des jeux d'instructions
+ * gérés: on utilise le même calcul que le moteur scalaire (compte_voisin).
+ */
+static inline __attribute__((always_inline)) char corps_scalaire(const cellule *h, const cellule *m, const cellule *b, cellule *dst,
+                                                                 unsigned int largeur, Stats *partielles, const char compte,
+                                                                 const uint16_t regle_b, const uint16_t regle_s)
+{
+    char change = 0;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0;
+    for (unsigned int j = 0; j < largeur; j++, h++, m++, b++)
+    {
+        unsigned char voisins = (h[-1] != 0) + (h[0] != 0) + (h[1] != 0)
+                              + (m[-1] != 0)               + (m[1] != 0)
+                              + (b[-1] != 0) + (b[0] != 0) + (b[1] != 0);
+        cellule cell = m[0];
+        if (!cell)
+        {
+            char nait = dans_masque(regle_b, voisins);
+            dst[j] = nait;
+            change |= nait;
+            if (compte) nes += nait;
+            continue;
+        }
+
+        if (compte)
+        {
+            en_vie++;
+            originelles += cell >> 7;
+        }
+        if (!dans_masque(regle_s, voisins))
+        {
+            dst[j] = 0;
+            change = 1;
+            if (compte) mortes++;
+            continue;
+        }
+
+        // Âge + 1, sans dépasser 127, en gardant le bit d'origine
+        unsigned char age = (cell & 127) + 1;
+        dst[j] = (age & (1 << 7)) ? cell : (cell & (1 << 7)) | age;
+        change |= (dst[j] != cell);
+    }
+
+    if (compte)
+    {
+        partielles -> en_vie += en_vie;
+        partielles -> nb_cell_originelles += originelles;
+        partielles -> nb_cell_nes += nes;
+        partielles -> nb_cell_mortes += mortes;
+    }
+    return change;
+}
+
+static char ligne_scalaire(const cellule *h, const cellule *m, const cellule *b, cellule *dst,
+                           unsigned int largeur, Stats *partielles, const Regle *regle)
+{
+    if (partielles == NULL)
+    {
+        AVEC_REGLE(regle, return corps_scalaire(h, m, b, dst, largeur, NULL, 0, naissance, survie));
+    }
+    AVEC_REGLE(regle, return corps_scalaire(h, m, b, dst, largeur, partielles, 1, naissance, survie));
+    return 0;
+}
+
+
+
+#ifdef SIMD_X86
+
+/* Pour le dernier vecteur d'une ligne: les n premiers octets de
+masque_queue + 64 - n valent 0xFF, les suivants 0. */
+static const unsigned char masque_queue[128] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};
+
+
+
+/* Les octets de voisins dont la valeur est dans le masque de la règle valent
+0xFF, les autres 0. Avec un masque constant (règle spécialisée), il ne reste
+que les comparaisons utiles: 2 pour S23, 1 pour B3. */
+__attribute__((target("sse2"), always_inline))
+static inline __m128i dans_masque_sse2(__m128i voisins, uint16_t masque)
+{
+    __m128i resultat = _mm_setzero_si128();
+    #pragma GCC unroll 9
+    for (int n = 0; n <= 8; n++)
+    {
+        if (dans_masque(masque, n)) resultat = _mm_or_si128(resultat, _mm_cmpeq_epi8(voisins, _mm_set1_epi8(n)));
+    }
+    return resultat;
+}
+
+/* Pour une règle quelconque: l'octet n de la table vaut 0xFF si n est dans le
+masque, et pshufb lit la table à l'indice 'voisins' (16 octets à la fois). */
+__attribute__((target("avx2")))
+static inline __m128i table_regle(uint16_t masque)
+{
+    __m128i octets = _mm_shuffle_epi8(_mm_set1_epi16(masque), _mm_set_epi8(1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 0));
+    __m128i bits = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+    return _mm_cmpeq_epi8(_mm_and_si128(octets, bits), bits);
+}
+
+__attribute__((target("avx2"), always_inline))
+static inline __m256i dans_masque_avx2(__m256i voisins, uint16_t masque)
+{
+    if (!__builtin_constant_p(masque)) return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(table_regle(masque)), voisins);
+
+    __m256i resultat = _mm256_setzero_si256();
+    #pragma GCC unroll 9
+    for (int n = 0; n <= 8; n++)
+    {
+        if (dans_masque(masque, n)) resultat = _mm256_or_si256(resultat, _mm256_cmpeq_epi8(voisins, _mm256_set1_epi8(n)));
+    }
+    return resultat;
+}
+
+__attribute__((target("avx512f,avx512bw"), always_inline))
+static inline __mmask64 dans_masque_avx512(__m512i voisins, uint16_t masque)
+{
+    if (!__builtin_constant_p(masque)) return _mm512_movepi8_mask(_mm512_shuffle_epi8(_mm512_broadcast_i32x4(table_regle(masque)), voisins));
+
+    __mmask64 resultat = 0;
+    #pragma GCC unroll 9
+    for (int n = 0; n <= 8; n++)
+    {
+        if (dans_masque(masque, n)) resultat |= _mm512_cmpeq_epi8_mask(voisins, _mm512_set1_epi8(n));
+    }
+    return resultat;
+}
+
+
+
+/**
+ * @brief Noyau SSE2: 16 cellules par instruction.
+ * 
+ * Pour chaque vecteur de cellules on compte les voisins vivants (min(cellule, 1)
+ * vaut 1 si la cellule est vivante), puis on applique les règles et on met à jour
+ * l'âge dans les registres vectoriels:
+ * - naissance: morte et nombre de voisins dans B -> 1
+ * - survie: vivante et nombre de voisins dans S -> (origine) | min(âge + 1, 127)
+ * - sinon -> 0
+ * Les colonnes après la fin de la grille sont forcées à 0 (masque_queue) pour que
+ * la bordure reste morte.
+ */
+__attribute__((target("sse2"), always_inline))
+static inline char corps_sse2(const cellule *h, const cellule *m, const cellule *b, cellule *dst,
+                               unsigned int largeur, Stats *partielles, const char compte,
+                               const uint16_t regle_b, const uint16_t regle_s)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i un = _mm_set1_epi8(1);
+    const __m128i bits_age = _mm_set1_epi8(127);
+    const __m128i bit_origine = _mm_set1_epi8((char) 128);
+
+    __m128i differences = zero;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0;
+    for (unsigned int j = 0; j < largeur; j += 16)
+    {
+        #define VIVANTE_16(p) _mm_min_epu8(_mm_loadu_si128((const __m128i *) (p)), un)
+        __m128i voisins = _mm_add_epi8(_mm_add_epi8(VIVANTE_16(h + j - 1), VIVANTE_16(h + j)),
+                                       _mm_add_epi8(VIVANTE_16(h + j + 1), VIVANTE_16(m + j - 1)));
+        voisins = _mm_add_epi8(voisins, _mm_add_epi8(_mm_add_epi8(VIVANTE_16(m + j + 1), VIVANTE_16(b + j - 1)),
+                                                     _mm_add_epi8(VIVANTE_16(b + j), VIVANTE_16(b + j + 1))));
+        #undef VIVANTE_16
+
+        __m128i cell = _mm_loadu_si128((const __m128i *) (m + j));
+        __m128i masque = (largeur - j >= 16) ? _mm_set1_epi8((char) 0xFF)
+                                             : _mm_loadu_si128((const __m128i *) (masque_queue + 64 - (largeur - j)));
+
+        __m128i morte = _mm_cmpeq_epi8(cell, zero);
+        __m128i naissance = _mm_and_si128(_mm_and_si128(morte, dans_masque_sse2(voisins, regle_b)), masque);
+        __m128i survie = _mm_andnot_si128(morte, dans_masque_sse2(voisins, regle_s));
+
+        // Âge + 1, saturé à 127, en gardant le bit d'origine
+        __m128i age = _mm_min_epu8(_mm_add_epi8(_mm_and_si128(cell, bits_age), un), bits_age);
+        __m128i vieillie = _mm_or_si128(_mm_and_si128(cell, bit_origine), age);
+
+        __m128i resultat = _mm_and_si128(_mm_or_si128(_mm_and_si128(survie, vieillie), _mm_and_si128(naissance, un)), masque);
+        _mm_storeu_si128((__m128i *) (dst + j), resultat);
+        differences = _mm_or_si128(differences, _mm_xor_si128(resultat, _mm_and_si128(cell, masque)));
+
+        // Stats: 1 bit par cellule avec movemask, puis popcount
+        if (!compte) continue;
+        unsigned int valides = _mm_movemask_epi8(masque);
+        unsigned int vivantes = ~_mm_movemask_epi8(morte) & valides;
+        en_vie += __builtin_popcount(vivantes);
+        originelles += __builtin_popcount(_mm_movemask_epi8(cell) & valides);
+        nes += __builtin_popcount(_mm_movemask_epi8(naissance));
+        mortes += __builtin_popcount(vivantes & ~_mm_movemask_epi8(survie));
+    }
+    if (compte)
+    {
+        partielles -> en_vie += en_vie;
+        partielles -> nb_cell_originelles += originelles;
+        partielles -> nb_cell_nes += nes;
+        partielles -> nb_cell_mortes += mortes;
+    }
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(differences, zero)) != 0xFFFF;
+}
+
+NOYAU_AVEC_STATS(ligne_sse2, corps_sse2, "sse2")
+
+
+
+/**
+ * @brief Noyau AVX2: 32 cellules par instruction (même calcul que ligne_sse2()).
+ */
+__attribute__((target("avx2"), always_inline))
+static inline char corps_avx2(const cellule *h, const cellule *m, const cellule *b, cellule *dst,
+                               unsigned int largeur, Stats *partielles, const char compte,
+                               const uint16_t regle_b, const uint16_t regle_s)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i un = _mm256_set1_epi8(1);
+    const __m256i bits_age = _mm256_set1_epi8(127);
+    const __m256i bit_origine = _mm256_set1_epi8((char) 128);
+
+    __m256i differences = zero;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0;
+    for (unsigned int j = 0; j < largeur; j += 32)
+    {
+        #define VIVANTE_32(p) _mm256_min_epu8(_mm256_loadu_si256((const __m256i *) (p)), un)
+        __m256i voisins = _mm256_add_epi8(_mm256_add_epi8(VIVANTE_32(h + j - 1), VIVANTE_32(h + j)),
+                                          _mm256_add_epi8(VIVANTE_32(h + j + 1), VIVANTE_32(m + j - 1)));
+        voisins = _mm256_add_epi8(voisins, _mm256_add_epi8(_mm256_add_epi8(VIVANTE_32(m + j + 1), VIVANTE_32(b + j - 1)),
+                                                           _mm256_add_epi8(VIVANTE_32(b + j), VIVANTE_32(b + j + 1))));
+        #undef VIVANTE_32
+
+        __m256i cell = _mm256_loadu_si256((const __m256i *) (m + j));
+        __m256i masque = (largeur - j >= 32) ? _mm256_set1_epi8((char) 0xFF)
+                                             : _mm256_loadu_si256((const __m256i *) (masque_queue + 64 - (largeur - j)));
+
+        __m256i morte = _mm256_cmpeq_epi8(cell, zero);
+        __m256i naissance = _mm256_and_si256(_mm256_and_si256(morte, dans_masque_avx2(voisins, regle_b)), masque);
+        __m256i survie = _mm256_andnot_si256(morte, dans_masque_avx2(voisins, regle_s));
+
+        __m256i age = _mm256_min_epu8(_mm256_add_epi8(_mm256_and_si256(cell, bits_age), un), bits_age);
+        __m256i vieillie = _mm256_or_si256(_mm256_and_si256(cell, bit_origine), age);
+
+        __m256i resultat = _mm256_and_si256(_mm256_or_si256(_mm256_and_si256(survie, vieillie), _mm256_and_si256(naissance, un)), masque);
+        _mm256_storeu_si256((__m256i *) (dst + j), resultat);
+        differences = _mm256_or_si256(differences, _mm256_xor_si256(resultat, _mm256_and_si256(cell, masque)));
+
+        if (!compte) continue;
+        unsigned int valides = _mm256_movemask_epi8(masque);
+        unsigned int vivantes = ~(unsigned int) _mm256_movemask_epi8(morte) & valides;
+        en_vie += __builtin_popcount(vivantes);
+        originelles += __builtin_popcount(_mm256_movemask_epi8(cell) & valides);
+        nes += __builtin_popcount(_mm256_movemask_epi8(naissance));
+        mortes += __builtin_popcount(vivantes & ~(unsigned int) _mm256_movemask_epi8(survie));
+    }
+    if (compte)
+    {
+        partielles -> en_vie += en_vie;
+        partielles -> nb_cell_originelles += originelles;
+        partielles -> nb_cell_nes += nes;
+        partielles -> nb_cell_mortes += mortes;
+    }
+    return !_mm256_testz_si256(differences, differences);
+}
+
+NOYAU_AVEC_STATS(ligne_avx2, corps_avx2, "avx2")
+
+
+
+/**
+ * @brief Noyau AVX-512: 64 cellules par instruction. Même calcul que
+ * ligne_sse2(), mais les comparaisons donnent directement des masques de
+ * 64 bits (1 bit par cellule).
+ */
+__attribute__((target("avx512f,avx512bw"), always_inline))
+static inline char corps_avx512(const cellule *h, const cellule *m, const cellule *b, cellule *dst,
+                                 unsigned int largeur, Stats *partielles, const char compte,
+                                 const uint16_t regle_b, const uint16_t regle_s)
+{
+    const __m512i un = _mm512_set1_epi8(1);
+    const __m512i bits_age = _mm512_set1_epi8(127);
+    const __m512i bit_origine = _mm512_set1_epi8((char) 128);
+
+    __mmask64 differences = 0;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0;
+    for (unsigned int j = 0; j < largeur; j += 64)
+    {
+        #define VIVANTE_64(p) _mm512_min_epu8(_mm512_loadu_si512((const void *) (p)), un)
+        __m512i voisins = _mm512_add_epi8(_mm512_add_epi8(VIVANTE_64(h + j - 1), VIVANTE_64(h + j)),
+                                          _mm512_add_epi8(VIVANTE_64(h + j + 1), VIVANTE_64(m + j - 1)));
+        voisins = _mm512_add_epi8(voisins, _mm512_add_epi8(_mm512_add_epi8(VIVANTE_64(m + j + 1), VIVANTE_64(b + j - 1)),
+                                                           _mm512_add_epi8(VIVANTE_64(b + j), VIVANTE_64(b + j + 1))));
+        #undef VIVANTE_64
+
+        __m512i cell = _mm512_loadu_si512((const void *) (m + j));
+        __mmask64 masque = (largeur - j >= 64) ? ~(__mmask64) 0 : (((__mmask64) 1 << (largeur - j)) - 1);
+
+        __mmask64 vivante = _mm512_test_epi8_mask(cell, cell) & masque;
+        __mmask64 naissance = ~vivante & dans_masque_avx512(voisins, regle_b) & masque;
+        __mmask64 survie = vivante & dans_masque_avx512(voisins, regle_s);
+
+        __m512i age = _mm512_min_epu8(_mm512_add_epi8(_mm512_and_si512(cell, bits_age), un), bits_age);
+        __m512i vieillie = _mm512_or_si512(_mm512_and_si512(cell, bit_origine), age);
+
+        // Les cellules qui ne sont ni nées ni survivantes sont mises à 0
+        __m512i resultat = _mm512_maskz_mov_epi8(survie, vieillie);
+        resultat = _mm512_mask_mov_epi8(resultat, naissance, un);
+        _mm512_storeu_si512((void *) (dst + j), resultat);
+        differences |= _mm512_mask_cmpneq_epi8_mask(masque, resultat, cell);
+
+        if (!compte) continue;
+        en_vie += __builtin_popcountll(vivante);
+        originelles += __builtin_popcountll(_mm512_movepi8_mask(cell) & masque);
+        nes += __builtin_popcountll(naissance);
+        mortes += __builtin_popcountll(vivante & ~survie);
+    }
+    if (compte)
+    {
+        partielles -> en_vie += en_vie;
+        partielles -> nb_cell_originelles += originelles;
+        partielles -> nb_cell_nes += nes;
+        partielles -> nb_cell_mortes += mortes;
+    }
+    return differences != 0;
+}
+
+NOYAU_AVEC_STATS(ligne_avx512, corps_avx512, "avx512f,avx512bw")
+
+#endif
+
+
+
+/**
+ * @brief Choisit le noyau à utiliser en fonction des jeux d'instructions
+ * disponibles sur le processeur (CPUID).
+ * 
+ * @param force Le nom du jeu d'instructions à utiliser ("avx512", "avx2",
+ * "sse2" ou "scalaire"), ou NULL pour choisir automatiquement le meilleur
+ */
+void init_simd(const char *force)
+{
+    noyau_ligne = ligne_scalaire;
+    nom_noyau = "scalaire";
+
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    char avx512 = __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    char avx2 = __builtin_cpu_supports("avx2") != 0;
+    char sse2 = __builtin_cpu_supports("sse2") != 0;
+
+    if (force != NULL)
+    {
+        // On vérifie que le jeu d'instructions demandé est bien disponible
+        avx512 = avx512 && !strcmp(force, "avx512");
+        avx2 = avx2 && !strcmp(force, "avx2");
+        sse2 = sse2 && !strcmp(force, "sse2");
+        if (!(avx512 || avx2 || sse2) && strcmp(force, "scalaire"))
+        {
+            print_redb("Jeu d'instructions indisponible, utilisation du noyau scalaire\n");
+        }
+    }
+
+    if (avx512) noyau_ligne = ligne_avx512, nom_noyau = "AVX-512";
+    else if (avx2) noyau_ligne = ligne_avx2, nom_noyau = "AVX2";
+    else if (sse2) noyau_ligne = ligne_sse2, nom_noyau = "SSE2";
+#endif
+}
+
+
+
+/**
+ * @brief Retourne le nom du jeu d'instructions choisi par init_simd().
+ * 
+ * @return const char* Le nom
+ */
+const char *nom_simd()
+{
+    return nom_noyau;
+}
+
+
+
+/**
+ * @brief Même chose que generation_suivante(), avec le noyau vectoriel choisi
+ * par init_simd(). Les résultats (âge et bit d'origine compris) sont
+ * identiques.
+ * 
+ * @param courante Un pointeur sur la grille à l'itération actuelle.
+ * @param suivante Un pointeur sur la grille où écrire l'itération suivante.
+ * @param zone La zone à calculer.
+ * @param partielles Un pointeur sur les statistiques de la zone (additionnées).
+ * @param regle Un pointeur sur la règle du jeu
+ * @return char 1 si au moins une cellule de la zone a changé, 0 sinon.
+ */
+char generation_suivante_simd(Grille *courante, Grille *suivante, const Zone *zone, Stats *partielles, const Regle *regle)
+{
+    // + lisible
+    unsigned int pas = courante -> pas;
+
+    if (noyau_ligne == NULL) init_simd(NULL);
+
+    char change = 0;
+    for (unsigned int i = zone -> y; i < zone -> y + zone -> hauteur; i++)
+    {
+        const cellule *m = &CELLULE(courante, i, zone -> x);
+        change |= noyau_ligne(m - pas, m, m + pas, &CELLULE(suivante, i, zone -> x), zone -> largeur, partielles, regle);
+    }
+    return change;
+}
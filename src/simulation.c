@@ -0,0 +1,391 @@
+/**
+ * @file simulation.c
+ * @author M3tex
+ * @brief Fichier contenant le thread de simulation: les générations sont
+ * calculées sur un thread à part et transmises à l'affichage par un triple
+ * tampon sans verrou. Le thread principal ne fait que gérer les évènements
+ * et afficher la dernière image publiée, sans jamais attendre le calcul.
+ * @version 0.1
+ * @date 2022-12-22
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <SDL2/SDL.h>
+#include "simulation.h"
+#include "logique.h"
+#include "sauvegarde.h"
+#include "cycles.h"
+#include "pyramide.h"
+#include "utilitaires.h"
+
+
+
+/**
+ * @brief Copie la grille du moteur (à jour) et les stats dans l'image
+ * 'arriere', puis l'échange avec l'image du milieu.
+ *
+ * @param sim Un pointeur sur la Simulation
+ */
+static void publie_image(Simulation *sim)
+{
+    // + lisible
+    Jeu *calcul = sim -> calcul;
+    Image *image = &(sim -> images[sim -> arriere]);
+    unsigned int pas = calcul -> grille -> pas;
+
+    synchronise_grille(calcul);
+
+    // Les 2 matrices ont la même disposition: on copie tout d'un coup (bordure comprise)
+    memcpy(image -> grille -> matrice - pas - ALIGNEMENT_GRILLE, calcul -> grille -> matrice - pas - ALIGNEMENT_GRILLE,
+           (size_t) (calcul -> grille -> taille + 2) * pas);
+    image -> statistiques = *(calcul -> statistiques);
+    image -> fenetre_x = calcul -> fenetre_x;
+    image -> fenetre_y = calcul -> fenetre_y;
+
+    // Les tuiles modifiées depuis l'image précédente (pour la pyramide de l'affichage)
+    image -> toutes_modifiees = sim -> toutes_modifiees;
+    if (sim -> modifiees != NULL)
+    {
+        size_t nb_tuiles = (size_t) calcul -> tuiles -> nb * calcul -> tuiles -> nb;
+        memcpy(image -> modifiees, sim -> modifiees, nb_tuiles);
+        memset(sim -> modifiees, 0, nb_tuiles);
+    }
+    sim -> toutes_modifiees = (sim -> modifiees == NULL);
+
+    // L'image devient celle du milieu, on récupère l'ancienne pour la prochaine fois
+    unsigned int ancien = atomic_exchange_explicit(&(sim -> etat), sim -> arriere | IMAGE_NOUVELLE, memory_order_acq_rel);
+    sim -> arriere = ancien & 3;
+}
+
+
+
+/**
+ * @brief Calcule la génération suivante (et la sauvegarde si besoin), en
+ * retenant les tuiles qui ont changé depuis la dernière image publiée.
+ *
+ * @param sim Un pointeur sur la Simulation
+ */
+static void avance_simulation(Simulation *sim)
+{
+    // + lisible
+    Jeu *calcul = sim -> calcul;
+
+    maj_grille(calcul);
+    sauvegarde_periodique(calcul);
+
+    // Les moteurs non bornés n'ont pas de tuiles: sim -> toutes_modifiees reste à 1
+    if (sim -> modifiees == NULL) return;
+    size_t nb_tuiles = (size_t) calcul -> tuiles -> nb * calcul -> tuiles -> nb;
+    for (size_t t = 0; t < nb_tuiles; t++) sim -> modifiees[t] |= calcul -> tuiles -> active[t];
+}
+
+
+
+/**
+ * @brief Indique si le nombre de tours demandé n'a pas encore été atteint.
+ *
+ * @param sim Un pointeur sur la Simulation
+ * @return char 1 s'il reste des générations à calculer, 0 sinon
+ */
+static char reste_des_tours(Simulation *sim)
+{
+    return sim -> nb_tours == -1 || sim -> calcul -> statistiques -> generations < (unsigned long) sim -> nb_tours;
+}
+
+
+
+/**
+ * @brief La boucle du thread de simulation: on récupère les commandes de
+ * l'utilisateur, on calcule la ou les générations suivantes (selon la
+ * Cadence) et on les publie.
+ *
+ * On ne publie une image que si l'affichage a pris la précédente: convertir
+ * et copier la grille coûte souvent plus cher qu'une génération, on ne le
+ * fait donc qu'une fois par image affichée.
+ *
+ * @param arg Un pointeur sur la Simulation
+ * @return void* NULL
+ */
+static void *boucle_simulation(void *arg)
+{
+    // + lisible
+    Simulation *sim = (Simulation *) arg;
+    Jeu *calcul = sim -> calcul;
+    Camera *cam = calcul -> cam;
+
+    char a_publier = 1;
+    unsigned int demandes_sauvegarde = atomic_load(&(sim -> demandes_sauvegarde));
+    unsigned long int generation_demandee = atomic_load(&(sim -> generation_demandee));
+    while (!atomic_load(&(sim -> arret)))
+    {
+        // Passer en couleur peut changer l'âge de toutes les cellules (voir suivi_age_bitgrille())
+        if (calcul -> estCouleur != atomic_load(&(sim -> couleur))) sim -> toutes_modifiees = 1;
+        calcul -> estCouleur = atomic_load(&(sim -> couleur));
+        calcul -> saut = atomic_load(&(sim -> saut));
+        cam -> origin_x = atomic_load(&(sim -> origine_x));
+        cam -> origin_y = atomic_load(&(sim -> origine_y));
+        cam -> width = atomic_load(&(sim -> largeur));
+
+        // En cadence image, on attend que l'affichage ait pris l'image précédente avant de calculer la suivante
+        Cadence cadence = atomic_load(&(sim -> cadence));
+        char attend = (cadence == CADENCE_IMAGE && a_publier);
+        char calcule = !atomic_load(&(sim -> pause)) && reste_des_tours(sim) && !attend;
+        if (calcule)
+        {
+            avance_simulation(sim);
+            a_publier = 1;
+
+            // Puis autant de générations que possible dans le temps accordé à l'image
+            if (cadence == CADENCE_IMAGE)
+            {
+                Uint64 fin = SDL_GetPerformanceCounter() + atomic_load(&(sim -> budget_ms)) * SDL_GetPerformanceFrequency() / 1000;
+                while (SDL_GetPerformanceCounter() < fin && reste_des_tours(sim) && !atomic_load(&(sim -> arret)))
+                {
+                    avance_simulation(sim);
+                }
+            }
+        }
+
+        /* Une fois un cycle détecté, on va directement à la génération demandée (touche 'a'),
+        ou à la dernière génération si le nombre de tours est limité. */
+        if (calcul -> cycles != NULL && calcul -> statistiques -> periode)
+        {
+            unsigned long int generations = calcul -> statistiques -> generations;
+            if (atomic_load(&(sim -> generation_demandee)) != generation_demandee)
+            {
+                generation_demandee = atomic_load(&(sim -> generation_demandee));
+                if (saute_generations(calcul, generation_demandee)) a_publier = 1;
+                else printf("La génération %lu est avant le début du cycle (génération %lu)\n", generation_demandee, calcul -> statistiques -> debut_cycle);
+            }
+            else if (sim -> nb_tours != -1 && reste_des_tours(sim) && saute_generations(calcul, sim -> nb_tours)) a_publier = 1;
+
+            // Après un saut, toute la grille a pu changer
+            if (calcul -> statistiques -> generations != generations) sim -> toutes_modifiees = 1;
+        }
+
+        // L'utilisateur a demandé une sauvegarde (touche 's')
+        if (atomic_load(&(sim -> demandes_sauvegarde)) != demandes_sauvegarde)
+        {
+            demandes_sauvegarde = atomic_load(&(sim -> demandes_sauvegarde));
+            if (ecrit_sauvegarde(calcul -> fichier_sauvegarde, calcul))
+            {
+                printf("Sauvegarde écrite dans %s (génération %lu)\n", calcul -> fichier_sauvegarde, calcul -> statistiques -> generations);
+            }
+            calcul -> derniere_sauvegarde = calcul -> statistiques -> generations;
+        }
+
+        // Les moteurs non bornés doivent aussi republier quand la caméra bouge
+        if (!(cam -> est_bornee) && (calcul -> fenetre_x != cam -> origin_x || calcul -> fenetre_y != cam -> origin_y)) a_publier = 1;
+
+        if (a_publier && !(atomic_load_explicit(&(sim -> etat), memory_order_acquire) & IMAGE_NOUVELLE))
+        {
+            publie_image(sim);
+            a_publier = 0;
+        }
+
+        // On attend X ms avant de passer à l'itération suivante (1 ms si rien à faire)
+        if (!calcule) SDL_Delay(1);
+        else if (cadence == CADENCE_DELAI && atomic_load(&(sim -> delay_ms))) SDL_Delay(atomic_load(&(sim -> delay_ms)));
+    }
+    return NULL;
+}
+
+
+
+/**
+ * @brief Lance le thread de simulation. Le moteur (déjà initialisé avec
+ * init_moteur()) passe au thread de simulation: jusqu'à arrete_simulation(),
+ * jeu -> grille et jeu -> statistiques pointent sur la dernière image reçue
+ * (voir image_suivante()).
+ *
+ * @param jeu Un pointeur sur le Jeu
+ * @param nb_tours Le nombre de générations à calculer (-1 si pas de limite)
+ * @return Simulation* Un pointeur sur la Simulation
+ */
+Simulation *lance_simulation(Jeu *jeu, int nb_tours)
+{
+    Simulation *sim = (Simulation *) malloc(sizeof(Simulation));
+    Jeu *calcul = (Jeu *) malloc(sizeof(Jeu));
+    Camera *cam = (Camera *) malloc(sizeof(Camera));
+    if (sim == NULL || calcul == NULL || cam == NULL) quitter("Impossible d'allouer de la mémoire pour la simulation\n", 2);
+
+    // Le Jeu de la simulation a le moteur et sa propre caméra, mais pas de fenêtre
+    synchronise_grille(jeu);
+    *calcul = *jeu;
+    *cam = *(jeu -> cam);
+    calcul -> cam = cam;
+    calcul -> fenetre = NULL;
+    calcul -> renderer = NULL;
+    calcul -> texture = NULL;
+    calcul -> pyramide = NULL;
+    sim -> calcul = calcul;
+
+    /* Les tuiles modifiées entre 2 images, pour mettre à jour la pyramide de l'affichage
+    (les moteurs non bornés n'ont pas de tuiles: tout est considéré modifié) */
+    size_t nb_tuiles = (calcul -> tuiles != NULL) ? (size_t) calcul -> tuiles -> nb * calcul -> tuiles -> nb : 0;
+    sim -> modifiees = NULL;
+    sim -> toutes_modifiees = 1;
+    if (nb_tuiles)
+    {
+        sim -> modifiees = (unsigned char *) calloc(nb_tuiles, 1);
+        if (sim -> modifiees == NULL) quitter("Impossible d'allouer de la mémoire pour la simulation\n", 2);
+    }
+
+    // La première image affichée est la configuration de départ
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        sim -> images[i].grille = copie_grille(jeu -> grille);
+        sim -> images[i].modifiees = NULL;
+        sim -> images[i].toutes_modifiees = 1;
+        if (nb_tuiles == 0) continue;
+        sim -> images[i].modifiees = (unsigned char *) malloc(nb_tuiles);
+        if (sim -> images[i].modifiees == NULL) quitter("Impossible d'allouer de la mémoire pour la simulation\n", 2);
+    }
+    sim -> images[0].statistiques = *(jeu -> statistiques);
+    sim -> images[0].fenetre_x = jeu -> fenetre_x;
+    sim -> images[0].fenetre_y = jeu -> fenetre_y;
+    sim -> avant = 0;
+    atomic_init(&(sim -> etat), 1);
+    sim -> arriere = 2;
+
+    atomic_init(&(sim -> arret), 0);
+    atomic_init(&(sim -> pause), 0);
+    atomic_init(&(sim -> couleur), 0);
+    atomic_init(&(sim -> delay_ms), 0);
+    atomic_init(&(sim -> cadence), CADENCE_DELAI);
+    atomic_init(&(sim -> budget_ms), 0);
+    atomic_init(&(sim -> saut), 1);
+    atomic_init(&(sim -> origine_x), jeu -> cam -> origin_x);
+    atomic_init(&(sim -> origine_y), jeu -> cam -> origin_y);
+    atomic_init(&(sim -> largeur), jeu -> cam -> width);
+    atomic_init(&(sim -> demandes_sauvegarde), jeu -> demandes_sauvegarde);
+    atomic_init(&(sim -> generation_demandee), jeu -> generation_demandee);
+    sim -> nb_tours = nb_tours;
+    publie_commandes(sim, jeu);
+
+    // L'affichage n'a plus accès au moteur
+    jeu -> tampon = NULL;
+    jeu -> bitgrille = NULL;
+    jeu -> pool = NULL;
+    jeu -> stats_threads = NULL;
+    jeu -> tuiles = NULL;
+    jeu -> hashlife = NULL;
+    jeu -> univers = NULL;
+    if (jeu -> pyramide != NULL) jeu -> pyramide -> obsolete = 1;
+    image_suivante(sim, jeu);
+
+    if (pthread_create(&(sim -> thread), NULL, boucle_simulation, sim) != 0)
+    {
+        quitter("Impossible de créer le thread de simulation\n", 2);
+    }
+    return sim;
+}
+
+
+
+/**
+ * @brief Transmet au thread de simulation les commandes de l'utilisateur
+ * (pause, couleur, cadence, saut, position et zoom de la caméra, sauvegardes demandées).
+ *
+ * @param sim Un pointeur sur la Simulation
+ * @param jeu Un pointeur sur le Jeu de l'affichage
+ */
+void publie_commandes(Simulation *sim, Jeu *jeu)
+{
+    atomic_store(&(sim -> pause), jeu -> estPause);
+    atomic_store(&(sim -> couleur), jeu -> estCouleur);
+    atomic_store(&(sim -> delay_ms), jeu -> delay_ms);
+    atomic_store(&(sim -> cadence), jeu -> cadence);
+    atomic_store(&(sim -> budget_ms), jeu -> budget_ms);
+    atomic_store(&(sim -> saut), jeu -> saut);
+    atomic_store(&(sim -> origine_x), jeu -> cam -> origin_x);
+    atomic_store(&(sim -> origine_y), jeu -> cam -> origin_y);
+    atomic_store(&(sim -> largeur), jeu -> cam -> width);
+    atomic_store(&(sim -> demandes_sauvegarde), jeu -> demandes_sauvegarde);
+    atomic_store(&(sim -> generation_demandee), jeu -> generation_demandee);
+}
+
+
+
+/**
+ * @brief Prend la dernière image publiée par le thread de simulation, s'il y
+ * en a une nouvelle. jeu -> grille, jeu -> statistiques et jeu -> fenetre_x / y
+ * sont alors ceux de cette image.
+ *
+ * @param sim Un pointeur sur la Simulation
+ * @param jeu Un pointeur sur le Jeu de l'affichage
+ * @return char 1 si l'image a changé, 0 sinon
+ */
+char image_suivante(Simulation *sim, Jeu *jeu)
+{
+    char nouvelle = (atomic_load_explicit(&(sim -> etat), memory_order_acquire) & IMAGE_NOUVELLE) != 0;
+    if (nouvelle)
+    {
+        // On rend l'image affichée (sans IMAGE_NOUVELLE), et on récupère celle du milieu
+        unsigned int ancien = atomic_exchange_explicit(&(sim -> etat), sim -> avant, memory_order_acq_rel);
+        sim -> avant = ancien & 3;
+    }
+
+    Image *image = &(sim -> images[sim -> avant]);
+    jeu -> grille = image -> grille;
+    jeu -> statistiques = &(image -> statistiques);
+    jeu -> fenetre_x = image -> fenetre_x;
+    jeu -> fenetre_y = image -> fenetre_y;
+
+    /* La pyramide n'est mise à jour que si on l'affiche: sinon elle sera entièrement
+    recalculée au prochain dézoom (voir dessine_grille()) */
+    if (nouvelle && jeu -> pyramide != NULL && !(jeu -> pyramide -> obsolete))
+    {
+        if (jeu -> niveau_detail == 0 || image -> toutes_modifiees) jeu -> pyramide -> obsolete = 1;
+        else maj_pyramide(jeu -> pyramide, image -> grille, image -> modifiees);
+    }
+    return nouvelle;
+}
+
+
+
+/**
+ * @brief Arrête le thread de simulation et rend le moteur au Jeu, qui
+ * retrouve son état d'avant lance_simulation() (à la dernière génération
+ * calculée).
+ *
+ * @param sim Un pointeur sur la Simulation (libérée ici)
+ * @param jeu Un pointeur sur le Jeu de l'affichage
+ */
+void arrete_simulation(Simulation *sim, Jeu *jeu)
+{
+    // + lisible
+    Jeu *calcul = sim -> calcul;
+
+    atomic_store(&(sim -> arret), 1);
+    pthread_join(sim -> thread, NULL);
+
+    synchronise_grille(calcul);
+    jeu -> grille = calcul -> grille;
+    jeu -> tampon = calcul -> tampon;
+    jeu -> bitgrille = calcul -> bitgrille;
+    jeu -> statistiques = calcul -> statistiques;
+    jeu -> pool = calcul -> pool;
+    jeu -> stats_threads = calcul -> stats_threads;
+    jeu -> tuiles = calcul -> tuiles;
+    jeu -> hashlife = calcul -> hashlife;
+    jeu -> univers = calcul -> univers;
+    jeu -> fenetre_x = calcul -> fenetre_x;
+    jeu -> fenetre_y = calcul -> fenetre_y;
+    jeu -> grille_obsolete = calcul -> grille_obsolete;
+    if (jeu -> pyramide != NULL) jeu -> pyramide -> obsolete = 1;
+
+    for (unsigned int i = 0; i < 3; i++)
+    {
+        free_grille(sim -> images[i].grille);
+        free(sim -> images[i].modifiees);
+    }
+    free(sim -> modifiees);
+    free(calcul -> cam);
+    free(calcul);
+    free(sim);
+}
@@ -0,0 +1,340 @@
+/**
+ * @file soupe.c
+ * @author M3tex
+ * @brief Fichier contenant le générateur de configurations aléatoires, ou
+ * 'soupes' (voir https://conwaylife.com/wiki/Soup).
+ *
+ * Une soupe est reproductible: elle ne dépend que de sa graine, de sa densité,
+ * de sa symétrie et de la taille de la grille. Chaque ligne a son propre
+ * générateur pseudo-aléatoire (xoshiro256**), initialisé à partir de la graine
+ * et du numéro de la ligne: les lignes peuvent donc être tirées dans
+ * n'importe quel ordre, par n'importe quel thread, avec le même résultat.
+ *
+ * Les cellules sont tirées 64 par 64 (un nombre pseudo-aléatoire donne 64
+ * cellules à 50%), puis écrites 8 par 8 dans la grille.
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "soupe.h"
+#include "logique.h"
+#include "parallele.h"
+#include "utilitaires.h"
+
+
+
+/**
+ * @brief Ce dont a besoin chaque thread pour remplir sa bande de lignes
+ * (voir remplit_bande()).
+ */
+typedef struct ContexteSoupe {
+    Grille *grille;
+    const Soupe *soupe;
+    unsigned int nb_bandes;
+    unsigned long int *en_vie;
+} ContexteSoupe;
+
+/**
+ * @brief L'état d'un générateur xoshiro256**.
+ */
+typedef struct Xoshiro {
+    uint64_t s[4];
+} Xoshiro;
+
+// Une cellule vivante à la génération 0: âge 1, bit d'origine
+#define CELLULE_DEPART ((1 << 7) + 1)
+
+
+
+/**
+ * @brief Le générateur splitmix64: sert à initialiser les générateurs
+ * xoshiro256** (deux graines proches donnent des états sans rapport).
+ */
+static uint64_t splitmix64(uint64_t *etat)
+{
+    uint64_t z = (*etat += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+
+
+/**
+ * @brief Le générateur xoshiro256**: 64 bits pseudo-aléatoires par appel.
+ */
+static inline uint64_t xoshiro(Xoshiro *x)
+{
+    uint64_t *s = x -> s;
+    uint64_t resultat = s[1] * 5;
+    resultat = ((resultat << 7) | (resultat >> 57)) * 9;
+
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = (s[3] << 45) | (s[3] >> 19);
+    return resultat;
+}
+
+
+
+/**
+ * @brief Initialise le générateur de la ligne i d'une soupe.
+ */
+static void init_xoshiro(Xoshiro *x, uint64_t graine, unsigned int i)
+{
+    // Chaque graine donne une base, chaque ligne s'en écarte d'un multiple impair (sans rapport avec le pas de splitmix64)
+    uint64_t etat = graine;
+    etat = splitmix64(&etat) + (uint64_t) i * 0xD1342543DE82EF95ULL;
+    for (unsigned int k = 0; k < 4; k++) x -> s[k] = splitmix64(&etat);
+}
+
+
+
+/**
+ * @brief Tire 64 cellules: chaque bit vaut 1 avec la probabilité
+ * densite / DENSITE_MAX.
+ *
+ * On lit les bits de la densité du plus faible au plus fort: pour un bit à 1,
+ * mot = mot | r (la probabilité p devient (1 + p) / 2), pour un bit à 0,
+ * mot = mot & r (elle devient p / 2), où r est un nouveau nombre tiré. Il faut
+ * donc au plus 16 nombres pour 64 cellules, et un seul à 50%.
+ */
+static inline uint64_t mot_aleatoire(Xoshiro *x, uint32_t densite)
+{
+    if (densite >= DENSITE_MAX) return ~0ULL;
+    if (densite == 0) return 0;
+
+    // Les bits à 0 sous le premier bit à 1 ne changent rien (0 & r = 0)
+    unsigned int k = __builtin_ctz(densite);
+    uint64_t mot = xoshiro(x);
+    for (k++; k < 16; k++)
+    {
+        uint64_t r = xoshiro(x);
+        mot = ((densite >> k) & 1) ? mot | r : mot & r;
+    }
+    return mot;
+}
+
+
+
+/**
+ * @brief Tire n cellules consécutives d'une ligne (vivantes à la génération
+ * 0, ou mortes).
+ */
+static void tire_cellules(Xoshiro *x, uint32_t densite, cellule *cellules, unsigned int n)
+{
+    for (unsigned int j = 0; j < n; j += 64)
+    {
+        uint64_t mot = mot_aleatoire(x, densite);
+        unsigned int fin = min_uint(64, n - j);
+
+        // 8 cellules à la fois: l'octet vaut 0xFF si la cellule est vivante, on garde CELLULE_DEPART
+        unsigned int k = 0;
+        for (; k + 8 <= fin; k += 8)
+        {
+            uint64_t octets = etale_octets(mot >> k) & (0x0101010101010101ULL * CELLULE_DEPART);
+            memcpy(cellules + j + k, &octets, 8);
+        }
+        for (; k < fin; k++) cellules[j + k] = ((mot >> k) & 1) ? CELLULE_DEPART : 0;
+    }
+}
+
+
+
+/**
+ * @brief Écrit dans destination les n cellules de source dans l'ordre
+ * inverse (destination[k] = source[n - 1 - k]). Les deux ne doivent pas se
+ * chevaucher.
+ */
+static void retourne_octets(const cellule *source, cellule *destination, unsigned int n)
+{
+    unsigned int k = 0;
+    for (; k + 8 <= n; k += 8)
+    {
+        uint64_t octets;
+        memcpy(&octets, source + n - 8 - k, 8);
+        octets = __builtin_bswap64(octets);
+        memcpy(destination + k, &octets, 8);
+    }
+    for (; k < n; k++) destination[k] = source[n - 1 - k];
+}
+
+
+
+/**
+ * @brief Compte les cellules vivantes de n cellules consécutives (les
+ * cellules d'une soupe valent 0 ou CELLULE_DEPART).
+ */
+static unsigned long int compte_cellules(const cellule *cellules, unsigned int n)
+{
+    unsigned long int en_vie = 0;
+    unsigned int k = 0;
+    for (; k + 8 <= n; k += 8)
+    {
+        uint64_t octets;
+        memcpy(&octets, cellules + k, 8);
+        en_vie += __builtin_popcountll(octets & 0x8080808080808080ULL);
+    }
+    for (; k < n; k++) en_vie += cellules[k] >> 7;
+    return en_vie;
+}
+
+
+
+/**
+ * @brief Le nombre de lignes tirées: les autres sont le reflet des premières.
+ */
+static unsigned int lignes_tirees(const Soupe *soupe, unsigned int taille)
+{
+    if (soupe -> symetrie == SYMETRIE_ROTATION || soupe -> symetrie == SYMETRIE_QUADRUPLE) return (taille + 1) / 2;
+    return taille;
+}
+
+
+
+/**
+ * @brief Tire la ligne i de la soupe et, si la symétrie le demande, écrit son
+ * reflet (ligne taille - 1 - i).
+ *
+ * @return unsigned long int Le nombre de cellules vivantes écrites
+ */
+static unsigned long int tire_ligne(Grille *grille, const Soupe *soupe, unsigned int i)
+{
+    // + lisible
+    unsigned int taille = grille -> taille;
+    Symetrie symetrie = soupe -> symetrie;
+    cellule *ligne = &CELLULE(grille, i, 0);
+    unsigned int miroir = taille - 1 - i;
+
+    Xoshiro x;
+    init_xoshiro(&x, soupe -> graine, i);
+
+    // Avec un reflet gauche-droite (la ligne du milieu d'une rotation en est un), on ne tire que la moitié gauche
+    char moitie = (symetrie == SYMETRIE_MIROIR || symetrie == SYMETRIE_QUADRUPLE || (symetrie == SYMETRIE_ROTATION && i == miroir));
+    if (moitie)
+    {
+        unsigned int h = taille / 2;
+        tire_cellules(&x, soupe -> densite, ligne, taille - h);
+        retourne_octets(ligne, ligne + taille - h, h);
+    }
+    else tire_cellules(&x, soupe -> densite, ligne, taille);
+
+    unsigned long int en_vie = compte_cellules(ligne, taille);
+    if (i == miroir || symetrie == SYMETRIE_AUCUNE || symetrie == SYMETRIE_MIROIR) return en_vie;
+
+    // La moitié du bas: la ligne retournée (demi-tour) ou recopiée (reflet haut-bas)
+    cellule *reflet = &CELLULE(grille, miroir, 0);
+    if (symetrie == SYMETRIE_ROTATION) retourne_octets(ligne, reflet, taille);
+    else memcpy(reflet, ligne, taille);
+    return 2 * en_vie;
+}
+
+
+
+/**
+ * @brief La tâche de chaque thread (voir Tache): on tire une bande de lignes.
+ *
+ * @param contexte Un pointeur sur le ContexteSoupe
+ * @param indice Le numéro du thread, i.e de la bande
+ */
+static void remplit_bande(void *contexte, unsigned int indice)
+{
+    // + lisible
+    ContexteSoupe *ctx = (ContexteSoupe *) contexte;
+    unsigned int nb_lignes = lignes_tirees(ctx -> soupe, ctx -> grille -> taille);
+
+    unsigned int debut = (unsigned int) ((unsigned long int) nb_lignes * indice / ctx -> nb_bandes);
+    unsigned int fin = (unsigned int) ((unsigned long int) nb_lignes * (indice + 1) / ctx -> nb_bandes);
+
+    unsigned long int en_vie = 0;
+    for (unsigned int i = debut; i < fin; i++) en_vie += tire_ligne(ctx -> grille, ctx -> soupe, i);
+    ctx -> en_vie[indice] = en_vie;
+}
+
+
+
+/**
+ * @brief Remplit toute la grille avec une soupe: chaque cellule est vivante
+ * (à la génération 0) ou morte. La bordure n'est pas modifiée.
+ *
+ * @param grille Un pointeur sur la grille à remplir
+ * @param soupe Un pointeur sur les paramètres de la soupe
+ * @param pool Le pool de threads qui se partagent les lignes, NULL pour tout
+ * tirer sur le thread appelant (le résultat est le même)
+ * @return unsigned long int Le nombre de cellules vivantes
+ */
+unsigned long int remplit_soupe(Grille *grille, const Soupe *soupe, Pool *pool)
+{
+    unsigned int nb_bandes = (pool != NULL) ? pool -> nb_threads : 1;
+    unsigned long int *en_vie = (unsigned long int *) calloc(nb_bandes, sizeof(unsigned long int));
+    if (en_vie == NULL) quitter("Impossible d'allouer de la mémoire pour la soupe\n", 2);
+
+    ContexteSoupe ctx = {grille, soupe, nb_bandes, en_vie};
+    if (pool != NULL) execute_pool(pool, remplit_bande, &ctx);
+    else remplit_bande(&ctx, 0);
+
+    unsigned long int total = 0;
+    for (unsigned int t = 0; t < nb_bandes; t++) total += en_vie[t];
+    free(en_vie);
+    return total;
+}
+
+
+
+/**
+ * @brief Lit le nom d'une symétrie: "aucune", "miroir", "rotation" ou
+ * "quadruple".
+ *
+ * @param nom Le nom
+ * @param symetrie Un pointeur sur la Symetrie où stocker le résultat
+ * @return char 1 si le nom est valide, 0 sinon
+ */
+char lit_symetrie(const char *nom, Symetrie *symetrie)
+{
+    if (!strcmp(nom, "aucune")) *symetrie = SYMETRIE_AUCUNE;
+    else if (!strcmp(nom, "miroir")) *symetrie = SYMETRIE_MIROIR;
+    else if (!strcmp(nom, "rotation")) *symetrie = SYMETRIE_ROTATION;
+    else if (!strcmp(nom, "quadruple")) *symetrie = SYMETRIE_QUADRUPLE;
+    else return 0;
+    return 1;
+}
+
+
+
+/**
+ * @brief Retourne le nom d'une symétrie (pour l'affichage).
+ */
+const char *nom_symetrie(Symetrie symetrie)
+{
+    switch (symetrie)
+    {
+    case SYMETRIE_MIROIR:
+        return "miroir";
+    case SYMETRIE_ROTATION:
+        return "rotation";
+    case SYMETRIE_QUADRUPLE:
+        return "quadruple";
+    default:
+        return "aucune";
+    }
+}
+
+
+
+/**
+ * @brief Affiche les paramètres d'une soupe, pour pouvoir la reproduire.
+ */
+void affiche_soupe(const Soupe *soupe)
+{
+    printf("Configuration aléatoire, graine: %lu, densité: %.1f%%, symétrie: %s\n", (unsigned long int) soupe -> graine,
+           100.0 * soupe -> densite / DENSITE_MAX, nom_symetrie(soupe -> symetrie));
+}
@@ -0,0 +1,220 @@
+/**
+ * @file table.c
+ * @author M3tex
+ * @brief Fichier contenant le moteur 'table': même format que le moteur
+ * scalaire (1 octet par cellule), mais les cellules sont calculées par carrés
+ * de 2 x 2 grâce à une table précalculée.
+ *
+ * L'état suivant d'un carré de 2 x 2 cellules ne dépend que du carré de 4 x 4
+ * cellules qui l'entoure: 16 cellules, donc 65536 cas possibles. La table
+ * donne, pour chaque carré de 4 x 4 (la clé, 1 bit par cellule), les 4
+ * cellules du centre à la génération suivante. Elle est construite une fois
+ * au lancement pour la règle du jeu (voir init_table()), et tient dans le
+ * cache (64 Ko): on remplace 4 comptages de voisins par une seule lecture.
+ *
+ * Pour construire les clés, chaque ligne est d'abord transformée en bits
+ * (8 cellules à la fois, voir masque_vivantes()): la clé d'un carré s'obtient
+ * alors avec quelques décalages.
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdint.h>
+#include <string.h>
+#include "table.h"
+#include "logique.h"
+#include "regle.h"
+#include "utilitaires.h"
+
+
+
+/* Pour chaque carré de 4 x 4 cellules (le bit 4 * r + c de la clé est la cellule
+de la ligne r et de la colonne c), les 4 cellules du centre à la génération
+suivante: bit 0 pour (1, 1), bit 1 pour (1, 2), bit 2 pour (2, 1), bit 3 pour (2, 2) */
+static uint8_t table[1 << 16];
+static char table_prete = 0;
+
+// Nombre de colonnes calculées à la fois: avec leurs voisines, elles tiennent dans un mot
+#define LARGEUR_MORCEAU 32
+
+
+
+/**
+ * @brief Construit la table pour une règle. Doit être appelée avant de lancer
+ * les threads de calcul (la table est partagée par tous les jeux).
+ *
+ * @param regle Un pointeur sur la règle du jeu
+ */
+void init_table(const Regle *regle)
+{
+    for (unsigned int cle = 0; cle < (1 << 16); cle++)
+    {
+        uint8_t resultat = 0;
+        for (unsigned int k = 0; k < 4; k++)
+        {
+            // La cellule du centre (r, c) et ses 8 voisins
+            unsigned int r = 1 + k / 2, c = 1 + k % 2;
+            unsigned int voisins = 0;
+            for (unsigned int i = r - 1; i <= r + 1; i++)
+            {
+                for (unsigned int j = c - 1; j <= c + 1; j++)
+                {
+                    if (i != r || j != c) voisins += (cle >> (4 * i + j)) & 1;
+                }
+            }
+
+            char vivante = (cle >> (4 * r + c)) & 1;
+            uint16_t masque = vivante ? regle -> survie : regle -> naissance;
+            resultat |= dans_masque(masque, voisins) << k;
+        }
+        table[cle] = resultat;
+    }
+    table_prete = 1;
+}
+
+
+
+/**
+ * @brief Écrit l'état suivant de n cellules consécutives (n <= 64) d'une ligne,
+ * dont on connaît déjà les cellules vivantes (le bit j de vivantes pour la
+ * cellule j), et compte les cellules originelles si compte vaut 1.
+ *
+ * Une cellule vivante à la génération suivante a l'âge de la cellule actuelle
+ * + 1 (saturé à 127) avec le même bit d'origine: c'est aussi vrai pour une
+ * cellule qui naît (0 + 1). Il suffit donc de calculer cet âge pour toutes les
+ * cellules et de garder celles qui sont vivantes, 8 cellules à la fois.
+ *
+ * @return uint64_t Non nul si au moins une cellule a changé
+ */
+static inline __attribute__((always_inline)) uint64_t ecrit_ligne(const cellule *source, cellule *destination, unsigned int n,
+                                                                  uint64_t vivantes, unsigned long int *originelles, const char compte)
+{
+    uint64_t differences = 0;
+    unsigned int j = 0;
+    for (; j + 8 <= n; j += 8)
+    {
+        uint64_t x;
+        memcpy(&x, source + j, 8);
+
+        // Âge + 1 dans chaque octet (au plus 128, pas de retenue), saturé à 127, avec le bit d'origine
+        uint64_t age = (x & 0x7F7F7F7F7F7F7F7FULL) + 0x0101010101010101ULL;
+        age -= (age >> 7) & 0x0101010101010101ULL;
+        uint64_t suivantes = (x & 0x8080808080808080ULL) | age;
+
+        // On ne garde que les cellules vivantes
+        suivantes &= etale_octets(vivantes >> j);
+        memcpy(destination + j, &suivantes, 8);
+        differences |= suivantes ^ x;
+        if (compte) *originelles += __builtin_popcountll(x & 0x8080808080808080ULL);
+    }
+    for (; j < n; j++)
+    {
+        cellule cell = source[j];
+        unsigned int age = (cell & 127) + 1;
+        age -= age >> 7;
+        cellule suivante = ((vivantes >> j) & 1) ? (cellule) ((cell & 128) | age) : 0;
+        destination[j] = suivante;
+        differences |= suivante ^ cell;
+        if (compte) *originelles += cell >> 7;
+    }
+    return differences;
+}
+
+
+
+/**
+ * @brief Le calcul de generation_suivante_table(). compte est une constante:
+ * le compilateur en fait une version avec et une version sans statistiques.
+ */
+static inline __attribute__((always_inline)) char calcule_table(Grille *courante, Grille *suivante, const Zone *zone,
+                                                                Stats *partielles, const char compte)
+{
+    // + lisible
+    unsigned int pas = courante -> pas;
+    unsigned int fin_y = zone -> y + zone -> hauteur;
+    unsigned int fin_x = zone -> x + zone -> largeur;
+
+    uint64_t differences = 0;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0;
+    for (unsigned int i = zone -> y; i < fin_y; i += 2)
+    {
+        /* Les lignes i - 1 à i + 2 autour des lignes i et i + 1. Si la zone a un nombre impair
+        de lignes, la ligne i + 1 n'est pas écrite (elle peut être la bordure du bas): on ne
+        lit pas en dessous. */
+        char deux_lignes = (i + 1 < fin_y);
+        const cellule *lignes[4];
+        lignes[0] = &CELLULE(courante, i, 0) - pas;
+        lignes[1] = lignes[0] + pas;
+        lignes[2] = lignes[1] + pas;
+        lignes[3] = deux_lignes ? lignes[2] + pas : lignes[2];
+        cellule *dst = &CELLULE(suivante, i, 0);
+
+        for (unsigned int j = zone -> x; j < fin_x; j += LARGEUR_MORCEAU)
+        {
+            // Les colonnes j - 1 à j + n (au plus la colonne de bordure de droite)
+            unsigned int n = min_uint(LARGEUR_MORCEAU, fin_x - j);
+            uint64_t bits[4];
+            for (unsigned int r = 0; r < 4; r++) bits[r] = masque_vivantes(lignes[r] + j - 1, n + 2);
+
+            // Une lecture dans la table pour chaque carré de 2 x 2: les cellules vivantes des lignes i et i + 1
+            uint64_t haut = 0, bas = 0;
+            for (unsigned int k = 0; k < n; k += 2)
+            {
+                unsigned int cle = ((bits[0] >> k) & 0xF) | ((bits[1] >> k) & 0xF) << 4
+                                 | ((bits[2] >> k) & 0xF) << 8 | ((bits[3] >> k) & 0xF) << 12;
+                unsigned int resultat = table[cle];
+                haut |= (uint64_t) (resultat & 3) << k;
+                bas |= (uint64_t) (resultat >> 2) << k;
+            }
+
+            // Si n est impair, la colonne j + n n'est pas dans la zone
+            uint64_t masque = ((uint64_t) 1 << n) - 1;
+            haut &= masque;
+            bas &= masque;
+
+            differences |= ecrit_ligne(lignes[1] + j, dst + j, n, haut, &originelles, compte);
+            if (deux_lignes) differences |= ecrit_ligne(lignes[2] + j, dst + pas + j, n, bas, &originelles, compte);
+
+            if (!compte) continue;
+            uint64_t anciennes_haut = (bits[1] >> 1) & masque;
+            uint64_t anciennes_bas = deux_lignes ? (bits[2] >> 1) & masque : 0;
+            if (!deux_lignes) bas = 0;
+            en_vie += __builtin_popcountll(anciennes_haut) + __builtin_popcountll(anciennes_bas);
+            nes += __builtin_popcountll(haut & ~anciennes_haut) + __builtin_popcountll(bas & ~anciennes_bas);
+            mortes += __builtin_popcountll(anciennes_haut & ~haut) + __builtin_popcountll(anciennes_bas & ~bas);
+        }
+    }
+
+    if (compte)
+    {
+        partielles -> en_vie += en_vie;
+        partielles -> nb_cell_originelles += originelles;
+        partielles -> nb_cell_nes += nes;
+        partielles -> nb_cell_mortes += mortes;
+    }
+    return differences != 0;
+}
+
+
+
+/**
+ * @brief Même chose que generation_suivante(), avec la table construite par
+ * init_table(). Les résultats (âge et bit d'origine compris) sont identiques.
+ *
+ * @param courante Un pointeur sur la grille à l'itération actuelle.
+ * @param suivante Un pointeur sur la grille où écrire l'itération suivante.
+ * @param zone La zone à calculer.
+ * @param partielles Un pointeur sur les statistiques de la zone (additionnées),
+ * NULL pour ne pas les calculer.
+ * @param regle Un pointeur sur la règle du jeu (celle de la table)
+ * @return char 1 si au moins une cellule de la zone a changé, 0 sinon.
+ */
+char generation_suivante_table(Grille *courante, Grille *suivante, const Zone *zone, Stats *partielles, const Regle *regle)
+{
+    if (!table_prete) init_table(regle);
+
+    if (partielles == NULL) return calcule_table(courante, suivante, zone, NULL, 0);
+    return calcule_table(courante, suivante, zone, partielles, 1);
+}
@@ -0,0 +1,282 @@
+/**
+ * @file topologie.c
+ * @author M3tex
+ * @brief Fichier contenant les topologies de la grille: bornée (les cellules
+ * hors de la grille sont mortes), tore et bouteille de Klein.
+ *
+ * Les noyaux de calcul ne savent rien de la topologie: ils lisent les voisins
+ * des cellules du bord dans la bordure de cellules fantômes (voir Grille et
+ * BitGrille). Pour refermer la grille, il suffit donc de recopier le bord
+ * opposé dans la bordure une fois avant chaque génération (2 colonnes et 2
+ * lignes), au lieu de calculer des indices modulo taille pour chaque voisin.
+ *
+ * Le tore relie le bord gauche au bord droit et le haut au bas. La bouteille
+ * de Klein relie aussi le haut au bas, mais après un retournement horizontal:
+ * la ligne fantôme du dessus est la dernière ligne lue de droite à gauche.
+ * @version 0.1
+ * @date 2022-12-31
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <string.h>
+#include "topologie.h"
+
+
+
+/**
+ * @brief Lit le nom d'une topologie: "bornee", "tore" ou "klein".
+ *
+ * @param nom Le nom
+ * @param topologie Un pointeur sur la Topologie où stocker le résultat
+ * @return char 1 si le nom est valide, 0 sinon
+ */
+char lit_topologie(const char *nom, Topologie *topologie)
+{
+    if (!strcmp(nom, "bornee")) *topologie = TOPOLOGIE_BORNEE;
+    else if (!strcmp(nom, "tore")) *topologie = TOPOLOGIE_TORE;
+    else if (!strcmp(nom, "klein")) *topologie = TOPOLOGIE_KLEIN;
+    else return 0;
+    return 1;
+}
+
+
+
+/**
+ * @brief Retourne le nom d'une topologie (pour l'affichage).
+ */
+const char *nom_topologie(Topologie topologie)
+{
+    switch (topologie)
+    {
+    case TOPOLOGIE_TORE:
+        return "tore";
+    case TOPOLOGIE_KLEIN:
+        return "bouteille de Klein";
+    default:
+        return "bornée";
+    }
+}
+
+
+
+/**
+ * @brief Recopie le bord opposé de la grille dans sa bordure de cellules
+ * fantômes. Les colonnes sont recopiées d'abord, pour que les coins des lignes
+ * fantômes soient corrects.
+ *
+ * @param grille Un pointeur sur la grille concernée
+ * @param topologie La topologie de la grille (TOPOLOGIE_TORE ou TOPOLOGIE_KLEIN)
+ */
+void maj_bordure_grille(Grille *grille, Topologie topologie)
+{
+    // + lisible
+    unsigned int taille = grille -> taille;
+    unsigned int pas = grille -> pas;
+    cellule *haut = grille -> matrice - pas;
+    cellule *bas = grille -> matrice + (size_t) taille * pas;
+
+    for (unsigned int i = 0; i < taille; i++)
+    {
+        cellule *ligne = grille -> matrice + (size_t) i * pas;
+        ligne[-1] = ligne[taille - 1];
+        ligne[taille] = ligne[0];
+    }
+
+    const cellule *premiere = grille -> matrice;
+    const cellule *derniere = bas - pas;
+    if (topologie == TOPOLOGIE_TORE)
+    {
+        memcpy(haut - 1, derniere - 1, taille + 2);
+        memcpy(bas - 1, premiere - 1, taille + 2);
+        return;
+    }
+
+    // Bouteille de Klein: la colonne j de la ligne fantôme est la colonne taille - 1 - j du bord opposé
+    for (int j = -1; j <= (int) taille; j++)
+    {
+        haut[j] = derniere[(int) taille - 1 - j];
+        bas[j] = premiere[(int) taille - 1 - j];
+    }
+}
+
+
+
+/**
+ * @brief Renverse l'ordre des bits d'un mot (le bit 0 devient le bit 63).
+ */
+static inline uint64_t retourne_mot(uint64_t x)
+{
+    x = ((x >> 1) & 0x5555555555555555ULL) | ((x & 0x5555555555555555ULL) << 1);
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    return __builtin_bswap64(x);
+}
+
+
+
+/**
+ * @brief Lit les 64 cellules des colonnes [p, p + 64) d'une ligne de la
+ * BitGrille, bordure comprise (p >= -64).
+ */
+static inline uint64_t extrait_mot(const uint64_t *ligne, int p)
+{
+    int w = (p + 64) / 64 - 1;
+    unsigned int decalage = (unsigned int) (p + 64) % 64;
+    if (decalage == 0) return ligne[w];
+    return (ligne[w] >> decalage) | (ligne[w + 1] << (64 - decalage));
+}
+
+
+
+/**
+ * @brief Écrit dans destination (une ligne fantôme, bordure comprise) la
+ * ligne source lue de droite à gauche: la colonne j de destination est la
+ * colonne taille - 1 - j de source, pour j de -1 à taille.
+ */
+static void retourne_ligne(const BitGrille *bitgrille, const uint64_t *source, uint64_t *destination)
+{
+    // + lisible
+    int taille = (int) bitgrille -> taille;
+    int nb_mots = (int) bitgrille -> nb_mots;
+
+    /* Les colonnes [64w, 64w + 64) de destination sont les colonnes [taille - 64 - 64w, taille - 64w)
+    de source retournées. Seul le bit 63 du mot de bordure gauche de source est utilisé: les colonnes
+    d'avant sont à 0, comme celles après la colonne fantôme de droite. */
+    for (int w = -1; w < nb_mots; w++) destination[w] = retourne_mot(extrait_mot(source, taille - 64 - 64 * w));
+
+    // La colonne fantôme de droite n'est dans le mot de bordure que si le dernier mot est plein
+    destination[nb_mots] = (taille % 64 == 0) ? retourne_mot(extrait_mot(source, -64)) : 0;
+}
+
+
+
+/**
+ * @brief Recopie le bord opposé de la BitGrille dans la bordure de ses
+ * cellules vivantes (les autres plans ne sont pas lus comme voisins).
+ *
+ * Si la taille n'est pas un multiple de 64, la colonne fantôme de droite est
+ * le premier bit inutilisé du dernier mot de chaque ligne: il faut l'effacer
+ * avec vide_bordure_bitgrille() une fois la génération calculée.
+ *
+ * @param bitgrille Un pointeur sur la bitgrille concernée
+ * @param topologie La topologie de la grille (TOPOLOGIE_TORE ou TOPOLOGIE_KLEIN)
+ */
+void maj_bordure_bitgrille(BitGrille *bitgrille, Topologie topologie)
+{
+    // + lisible
+    unsigned int taille = bitgrille -> taille;
+    unsigned int pas = bitgrille -> pas;
+    unsigned int dernier = bitgrille -> nb_mots - 1;
+    unsigned int reste = taille % 64;
+    uint64_t *vivantes = bitgrille -> courant.vivantes;
+
+    for (unsigned int y = 0; y < taille; y++)
+    {
+        uint64_t *ligne = vivantes + (size_t) y * pas;
+        ligne[-1] = ((ligne[(taille - 1) / 64] >> ((taille - 1) % 64)) & 1) << 63;
+
+        if (reste == 0) ligne[dernier + 1] = ligne[0] & 1;
+        else ligne[dernier] = (ligne[dernier] & bitgrille -> masque_fin) | ((ligne[0] & 1) << reste);
+    }
+
+    const uint64_t *premiere = vivantes;
+    const uint64_t *derniere = vivantes + (size_t) (taille - 1) * pas;
+    uint64_t *haut = vivantes - pas;
+    uint64_t *bas = vivantes + (size_t) taille * pas;
+    if (topologie == TOPOLOGIE_TORE)
+    {
+        memcpy(haut - 1, derniere - 1, sizeof(uint64_t) * pas);
+        memcpy(bas - 1, premiere - 1, sizeof(uint64_t) * pas);
+        return;
+    }
+    retourne_ligne(bitgrille, derniere, haut);
+    retourne_ligne(bitgrille, premiere, bas);
+}
+
+
+
+/**
+ * @brief Remet à 0 les bits inutilisés du dernier mot de chaque ligne des
+ * plans courants, où maj_bordure_bitgrille() a pu écrire la colonne fantôme de
+ * droite (les autres moteurs et la détection de cycles lisent les mots entiers).
+ *
+ * @param bitgrille Un pointeur sur la bitgrille concernée
+ */
+void vide_bordure_bitgrille(BitGrille *bitgrille)
+{
+    // + lisible
+    unsigned int pas = bitgrille -> pas;
+    uint64_t *dernier = bitgrille -> courant.vivantes + bitgrille -> nb_mots - 1;
+
+    if (bitgrille -> taille % 64 == 0) return;
+    for (unsigned int y = 0; y < bitgrille -> taille; y++) dernier[(size_t) y * pas] &= bitgrille -> masque_fin;
+}
+
+
+
+/**
+ * @brief Permet de savoir si une des tuiles de la ligne ty contenant les
+ * colonnes [debut, fin] a changé. Les colonnes -1 et taille sont celles du
+ * bord opposé.
+ */
+static char colonnes_actives(const Tuiles *tuiles, unsigned int taille, unsigned int ty, int debut, int fin)
+{
+    // + lisible
+    unsigned int nb = tuiles -> nb;
+    const unsigned char *ligne = tuiles -> active + (size_t) ty * nb;
+
+    if (debut < 0 && ligne[nb - 1]) return 1;
+    if (fin >= (int) taille && ligne[0]) return 1;
+
+    if (debut < 0) debut = 0;
+    if (fin >= (int) taille) fin = taille - 1;
+    for (int t = debut / TAILLE_TUILE; t <= fin / TAILLE_TUILE; t++)
+    {
+        if (ligne[t]) return 1;
+    }
+    return 0;
+}
+
+
+
+/**
+ * @brief Permet de savoir si une tuile du bord d'une grille refermée doit
+ * être recalculée, i.e si elle ou une de ses voisines (de l'autre côté du bord
+ * compris) a changé à la dernière génération.
+ *
+ * Dans une bouteille de Klein, les voisines de l'autre côté du haut ou du bas
+ * sont celles qui contiennent les colonnes retournées.
+ *
+ * @param tuiles Un pointeur sur les tuiles de la grille
+ * @param topologie La topologie de la grille (TOPOLOGIE_TORE ou TOPOLOGIE_KLEIN)
+ * @param taille La taille de la grille
+ * @param tx L'abscisse de la tuile
+ * @param ty L'ordonnée de la tuile
+ * @return char 1 si la tuile doit être recalculée, 0 sinon
+ */
+char tuile_bord_a_calculer(const Tuiles *tuiles, Topologie topologie, unsigned int taille, unsigned int tx, unsigned int ty)
+{
+    // + lisible
+    int nb = (int) tuiles -> nb;
+
+    // Les colonnes de la tuile et leurs voisines
+    int debut = (int) tx * TAILLE_TUILE - 1;
+    int fin = (int) tx * TAILLE_TUILE + TAILLE_TUILE;
+    if (fin > (int) taille) fin = taille;
+
+    for (int y = (int) ty - 1; y <= (int) ty + 1; y++)
+    {
+        if (y >= 0 && y < nb)
+        {
+            if (colonnes_actives(tuiles, taille, y, debut, fin)) return 1;
+            continue;
+        }
+
+        // De l'autre côté du haut ou du bas
+        unsigned int ligne = (y < 0) ? nb - 1 : 0;
+        if (topologie == TOPOLOGIE_KLEIN && colonnes_actives(tuiles, taille, ligne, taille - 1 - fin, taille - 1 - debut)) return 1;
+        if (topologie == TOPOLOGIE_TORE && colonnes_actives(tuiles, taille, ligne, debut, fin)) return 1;
+    }
+    return 0;
+}
@@ -12,7 +12,16 @@
 #include "types.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include "utilitaires.h"
+#include "parallele.h"
+#include "hashlife.h"
+#include "journal.h"
+#include "logique.h"
+#include "cycles.h"
+#include "mesures.h"
+#include "pyramide.h"
+#include "regle.h"
 
 
 
@@ -29,12 +38,14 @@ Camera *init_camera(unsigned int taille, unsigned int taille_max)
 
     cam -> width = taille;
     cam -> max_width = taille_max;
+    cam -> pixels = taille_max;
     
     // On centre la caméra dans la grille
     cam -> centre_x = taille_max / 2;
     cam -> centre_y = taille_max / 2;
     cam -> origin_x = cam -> centre_x - (taille / 2);
     cam -> origin_y = cam -> centre_y - (taille / 2);
+    cam -> est_bornee = 1;
     return cam;
 }
 
@@ -56,6 +67,8 @@ Jeu *init_jeu(unsigned int taille_choisie, unsigned int largeur_f, unsigned int
     if (jeu == NULL) quitter("Impossible d'allouer de la mémoire pour le Jeu\n", 2);
 
     jeu -> grille = init_grille(min_uint(largeur_f, hauteur_f));
+    jeu -> tampon = NULL;        // Allouées au lancement de la simulation si besoin
+    jeu -> bitgrille = NULL;
     jeu -> cam = init_camera(taille_choisie, jeu -> grille -> taille);
 
     jeu -> statistiques = init_stats();
@@ -63,38 +76,81 @@ Jeu *init_jeu(unsigned int taille_choisie, unsigned int largeur_f, unsigned int
     // On initialisera dans init_GUI()
     jeu -> fenetre = NULL;
     jeu -> renderer = NULL;
+    jeu -> texture = NULL;
 
     jeu -> estPause = 0;
     jeu -> estCouleur = 0;
+    jeu -> palette = PALETTE_SPECTRE;
     jeu -> estQuadrille = 0;
     jeu -> delay_ms = 50;
+    jeu -> cadence = CADENCE_DELAI;
+    jeu -> budget_ms = 10;
     jeu -> largeur_cell = (jeu -> grille -> taille) / taille_choisie;
+    jeu -> niveau_detail = 0;
+    jeu -> pyramide = NULL;     // Créée au premier dézoom sous 1 pixel par cellule (voir dessine_grille())
+
+    jeu -> moteur = MOTEUR_BITBOARD;
+    jeu -> grille_obsolete = 0;
+
+    // Les threads seront créés au lancement de la simulation (voir init_moteur())
+    jeu -> nb_threads = 1;
+    jeu -> pool = NULL;
+    jeu -> stats_threads = NULL;
+    jeu -> tuiles = NULL;
+
+    jeu -> hashlife = NULL;
+    jeu -> saut = 1;
+    jeu -> budget_hashlife = (size_t) 512 << 20;
+
+    jeu -> univers = NULL;
+    jeu -> fenetre_x = 0;
+    jeu -> fenetre_y = 0;
+
+    jeu -> fichier_sauvegarde = NULL;
+    jeu -> sauvegarde_tous = 0;
+    jeu -> derniere_sauvegarde = 0;
+    jeu -> demandes_sauvegarde = 0;
+
+    jeu -> niveau_stats = STATS_TOTAUX;
+    jeu -> journal = NULL;
+
+    jeu -> regle = regle_vie();
+    jeu -> topologie = TOPOLOGIE_BORNEE;
+    jeu -> cycles = NULL;
+    jeu -> generation_demandee = 0;
+    jeu -> saisie_active = 0;
+    jeu -> generation_saisie = 0;
+    jeu -> mesures = NULL;
     return jeu;
 }
 
 
 
 /**
- * @brief Permet d'initialiser une matrice carrée de cellules.
- * Met toutes les cellules à 0.
- * Attention: il faudra libérer la mémoire allouée.
+ * @brief Permet d'initialiser une matrice carrée de cellules, en une seule
+ * allocation alignée et entourée d'une bordure (voir Grille).
+ * Met toutes les cellules à 0 (bordure comprise).
+ * Attention: il faudra libérer la mémoire allouée avec free_matrice().
  *
  * @param taille La taille de la matrice
- * @return unsigned int** Un pointeur sur la matrice créée
+ * @param pas Un pointeur sur l'entier où stocker le nombre d'octets par ligne
+ * @return cellule* Un pointeur sur la cellule (0, 0) de la matrice créée
  */
-cellule **init_matrice(unsigned int taille)
+cellule *init_matrice(unsigned int taille, unsigned int *pas)
 {
-    // On alloue de la mémoire
-    cellule **grille = (cellule **) malloc(sizeof(cellule *) * taille);
-    if (grille == NULL) quitter("Impossible d'allouer de la mémoire pour la matrice", 1);
-
-    for (unsigned int i = 0; i < taille; i++)
-    {
-        grille[i] = (cellule *) calloc(taille, sizeof(cellule));
-        if (grille[i] == NULL) quitter("Impossible d'allouer de la mémoire pour la matrice", 1);
-    }
-
-    return grille;
+    /* Bordure à gauche + la ligne + au moins une colonne fantôme à droite,
+    arrondi au multiple de l'alignement supérieur */
+    *pas = ((ALIGNEMENT_GRILLE + taille + 1 + ALIGNEMENT_GRILLE - 1) / ALIGNEMENT_GRILLE) * ALIGNEMENT_GRILLE;
+
+    /* + 2 lignes pour la bordure du haut et du bas, et une marge à la fin pour que les
+    lectures vectorielles de la dernière ligne ne sortent pas de l'allocation (voir simd.c) */
+    size_t taille_alloc = (size_t) (taille + 2) * (*pas) + ALIGNEMENT_GRILLE;
+    cellule *memoire = (cellule *) aligned_alloc(ALIGNEMENT_GRILLE, taille_alloc);
+    if (memoire == NULL) quitter("Impossible d'allouer de la mémoire pour la matrice", 1);
+    memset(memoire, 0, taille_alloc);
+
+    // On saute la ligne du haut et la bordure de gauche
+    return memoire + *pas + ALIGNEMENT_GRILLE;
 }
 
 
@@ -112,14 +168,125 @@ Grille *init_grille(unsigned int taille)
     Grille *result = (Grille *) malloc(sizeof(Grille));
     if (result == NULL) quitter("Impossible d'allouer de la mémoire pour la grille", 1);
 
-    result -> matrice = init_matrice(taille);
+    result -> matrice = init_matrice(taille, &(result -> pas));
+    result -> taille = taille;
+    return result;
+}
+
+
+
+
+/**
+ * @brief Permet d'initialiser un plan de bits (voir PlansBits) de taille x taille
+ * bits, entouré d'une bordure d'un mot / d'une ligne. Met tous les bits à 0.
+ * Attention: il faudra libérer la mémoire allouée avec free_plan().
+ * 
+ * @param taille La taille de la grille
+ * @param pas Le nombre de mots par ligne, bordure comprise
+ * @return uint64_t* Un pointeur sur le premier mot de la première ligne (hors
+ * bordure)
+ */
+uint64_t *init_plan(unsigned int taille, unsigned int pas)
+{
+    uint64_t *plan = (uint64_t *) calloc((size_t) (taille + 2) * pas, sizeof(uint64_t));
+    if (plan == NULL) quitter("Impossible d'allouer de la mémoire pour la bitgrille", 1);
+
+    // On saute la ligne et le mot de bordure
+    return plan + pas + 1;
+}
+
+
+
+
+/**
+ * @brief Initialise une instance de la struct BitGrille.
+ * Les plans d'âge ne sont pas alloués (voir suivi_age).
+ * 
+ * @param taille La taille de la grille
+ * @return BitGrille* Un pointeur sur une BitGrille
+ */
+BitGrille *init_bitgrille(unsigned int taille)
+{
+    BitGrille *result = (BitGrille *) malloc(sizeof(BitGrille));
+    if (result == NULL) quitter("Impossible d'allouer de la mémoire pour la bitgrille", 1);
+
     result -> taille = taille;
+    result -> nb_mots = (taille + 63) / 64;
+    result -> pas = result -> nb_mots + 2;
+
+    // Si la taille n'est pas un multiple de 64, le dernier mot n'est pas plein
+    result -> masque_fin = (taille % 64) ? (((uint64_t) 1 << (taille % 64)) - 1) : ~(uint64_t) 0;
+
+    result -> courant.vivantes = init_plan(taille, result -> pas);
+    result -> courant.originelles = init_plan(taille, result -> pas);
+    result -> suivant.vivantes = init_plan(taille, result -> pas);
+    result -> suivant.originelles = init_plan(taille, result -> pas);
+    for (unsigned int k = 0; k < NB_BITS_AGE; k++)
+    {
+        result -> courant.age[k] = NULL;
+        result -> suivant.age[k] = NULL;
+    }
+    result -> suivi_age = 0;
     return result;
 }
 
 
 
 
+/**
+ * @brief Initialise une instance de la struct Tuiles pour une grille de
+ * taille x taille cellules. Toutes les tuiles sont actives au départ.
+ * 
+ * @param taille La taille de la grille
+ * @return Tuiles* Un pointeur sur les Tuiles
+ */
+Tuiles *init_tuiles(unsigned int taille)
+{
+    Tuiles *tuiles = (Tuiles *) malloc(sizeof(Tuiles));
+    if (tuiles == NULL) quitter("Impossible d'allouer de la mémoire pour les tuiles\n", 2);
+
+    tuiles -> nb = (taille + TAILLE_TUILE - 1) / TAILLE_TUILE;
+    size_t nb_tuiles = (size_t) tuiles -> nb * tuiles -> nb;
+
+    tuiles -> active = (unsigned char *) malloc(nb_tuiles);
+    tuiles -> prochaine = (unsigned char *) calloc(nb_tuiles, 1);
+    tuiles -> en_vie = (unsigned long int *) calloc(nb_tuiles, sizeof(unsigned long int));
+    tuiles -> originelles = (unsigned long int *) calloc(nb_tuiles, sizeof(unsigned long int));
+    if (tuiles -> active == NULL || tuiles -> prochaine == NULL || tuiles -> en_vie == NULL || tuiles -> originelles == NULL)
+    {
+        quitter("Impossible d'allouer de la mémoire pour les tuiles\n", 2);
+    }
+    memset(tuiles -> active, 1, nb_tuiles);
+    return tuiles;
+}
+
+
+
+
+/**
+ * @brief Initialise un Univers non borné vide.
+ * 
+ * @return Univers* Un pointeur sur l'Univers
+ */
+Univers *init_univers()
+{
+    Univers *univers = (Univers *) malloc(sizeof(Univers));
+    if (univers == NULL) quitter("Impossible d'allouer de la mémoire pour l'univers\n", 2);
+
+    univers -> nb_blocs = 0;
+    univers -> capacite = 64;
+    univers -> blocs = (Bloc **) malloc(sizeof(Bloc *) * univers -> capacite);
+    univers -> taille_table = 128;
+    univers -> table = (Bloc **) calloc(univers -> taille_table, sizeof(Bloc *));
+    if (univers -> blocs == NULL || univers -> table == NULL) quitter("Impossible d'allouer de la mémoire pour l'univers\n", 2);
+
+    univers -> courant = 0;
+    return univers;
+}
+
+
+
+
 /**
  * @brief Initialise une instance de la struct Stats
  * 
@@ -137,6 +304,10 @@ Stats *init_stats()
     to_return -> nb_cell_originelles = 0;
     to_return -> nb_cellules_depart = 0;
     to_return -> en_vie = 0;
+    to_return -> generations = 0;
+    to_return -> nb_tuiles_actives = 0;
+    to_return -> periode = 0;
+    to_return -> debut_cycle = 0;
     return to_return;
 }
 
@@ -152,19 +323,14 @@ Grille *copie_grille(Grille *grille)
 {
     // + lisible
     unsigned int taille = grille -> taille;
-    cellule **matrice = grille -> matrice;
+    unsigned int pas = grille -> pas;
 
     // On alloue de la mémoire
     Grille *result = init_grille(taille);
-    cellule **new_matrice = result -> matrice;
 
-    for (unsigned int i = 0; i < taille; i++)
-    {
-        for (unsigned int j = 0; j < taille; j++)
-        {
-            new_matrice[i][j] = matrice[i][j];
-        }
-    }
+    // Les 2 matrices ont la même disposition: on copie tout d'un coup (bordure comprise)
+    memcpy(result -> matrice - pas - ALIGNEMENT_GRILLE, grille -> matrice - pas - ALIGNEMENT_GRILLE,
+           (size_t) (taille + 2) * pas);
 
     return result;
 }
@@ -183,6 +349,10 @@ void affiche_stats(Stats *statistiques)
     printf("  - %lu cellules sont mortes\n", statistiques -> nb_cell_mortes);
     printf("  - %lu cellules étaient en vie à la fin de la simulation\n", statistiques -> en_vie);
     printf("  - %lu de ces %lu cellules sont des cellules originelles\n", statistiques -> nb_cell_originelles, statistiques -> en_vie);
+    printf("  - %lu tuiles ont été recalculées à la dernière génération\n", statistiques -> nb_tuiles_actives);
+    if (statistiques -> periode == 1) printf("  - la configuration est stable depuis la génération %lu\n", statistiques -> debut_cycle);
+    else if (statistiques -> periode) printf("  - la configuration est périodique depuis la génération %lu (période %lu)\n",
+                                             statistiques -> debut_cycle, statistiques -> periode);
 }
 
 
@@ -194,7 +364,7 @@ void affiche_stats(Stats *statistiques)
  */
 void free_grille(Grille *grille)
 {
-    free_matrice(grille -> matrice, grille -> taille);
+    free_matrice(grille -> matrice, grille -> pas);
     free(grille);
     grille = NULL;
 }
@@ -209,11 +379,26 @@ void free_grille(Grille *grille)
 void free_jeu(Jeu *jeu)
 {
     free(jeu -> cam);
+    // La dernière ligne du journal a besoin de la configuration actuelle (voir journal.c)
+    if (jeu -> journal != NULL) ferme_journal(jeu -> journal, compte_originelles(jeu));
+
     free_grille(jeu -> grille);
+    if (jeu -> tampon != NULL) free_grille(jeu -> tampon);
+    if (jeu -> bitgrille != NULL) free_bitgrille(jeu -> bitgrille);
+    if (jeu -> pool != NULL) free_pool(jeu -> pool);
+    free(jeu -> stats_threads);
+    if (jeu -> tuiles != NULL) free_tuiles(jeu -> tuiles);
+    if (jeu -> hashlife != NULL) free_hashlife(jeu -> hashlife);
+    if (jeu -> univers != NULL) free_univers(jeu -> univers);
+    if (jeu -> cycles != NULL) free_cycles(jeu -> cycles);
+    if (jeu -> mesures != NULL) free_mesures(jeu -> mesures);
+    if (jeu -> pyramide != NULL) free_pyramide(jeu -> pyramide);
     free(jeu -> statistiques);
 
-    SDL_DestroyRenderer(jeu -> renderer);
-    SDL_DestroyWindow(jeu -> fenetre);
+    // Pas de fenêtre en mode headless
+    if (jeu -> texture != NULL) SDL_DestroyTexture(jeu -> texture);
+    if (jeu -> renderer != NULL) SDL_DestroyRenderer(jeu -> renderer);
+    if (jeu -> fenetre != NULL) SDL_DestroyWindow(jeu -> fenetre);
 
     free(jeu);
     jeu = NULL;
@@ -224,16 +409,76 @@ void free_jeu(Jeu *jeu)
 /**
  * @brief Permet de libérer la mémoire allouée dans init_matrice()
  *
- * @param matrice La matrice à libérer
- * @param taille La taille de la grille à libérer
+ * @param matrice La matrice à libérer (telle que retournée par init_matrice())
+ * @param pas Le nombre d'octets par ligne de la matrice
  */
-void free_matrice(cellule **matrice, unsigned int taille)
+void free_matrice(cellule *matrice, unsigned int pas)
 {
-    for (unsigned int i = 0; i < taille; i++)
+    free(matrice - pas - ALIGNEMENT_GRILLE);
+    matrice = NULL;
+}
+
+
+
+/**
+ * @brief Permet de libérer la mémoire allouée dans init_plan()
+ * 
+ * @param plan Le plan à libérer (tel que retourné par init_plan())
+ * @param pas Le nombre de mots par ligne, bordure comprise
+ */
+void free_plan(uint64_t *plan, unsigned int pas)
+{
+    if (plan == NULL) return;
+    free(plan - pas - 1);
+}
+
+
+
+/**
+ * @brief Libère la mémoire allouée dans init_bitgrille()
+ * 
+ * @param bitgrille Un pointeur sur la BitGrille à libérer
+ */
+void free_bitgrille(BitGrille *bitgrille)
+{
+    unsigned int pas = bitgrille -> pas;
+    PlansBits *plans[2] = {&(bitgrille -> courant), &(bitgrille -> suivant)};
+    for (unsigned int i = 0; i < 2; i++)
     {
-        free(matrice[i]);
-        matrice[i] = NULL;
+        free_plan(plans[i] -> vivantes, pas);
+        free_plan(plans[i] -> originelles, pas);
+        for (unsigned int k = 0; k < NB_BITS_AGE; k++) free_plan(plans[i] -> age[k], pas);
     }
-    free(matrice);
-    matrice = NULL;
-}
\ No newline at end of file
+    free(bitgrille);
+}
+
+
+
+/**
+ * @brief Libère la mémoire allouée dans init_tuiles()
+ * 
+ * @param tuiles Un pointeur sur les Tuiles à libérer
+ */
+void free_tuiles(Tuiles *tuiles)
+{
+    free(tuiles -> active);
+    free(tuiles -> prochaine);
+    free(tuiles -> en_vie);
+    free(tuiles -> originelles);
+    free(tuiles);
+}
+
+
+
+/**
+ * @brief Libère la mémoire allouée dans init_univers() (et tous les blocs)
+ * 
+ * @param univers Un pointeur sur l'Univers à libérer
+ */
+void free_univers(Univers *univers)
+{
+    for (size_t i = 0; i < univers -> nb_blocs; i++) free(univers -> blocs[i]);
+    free(univers -> blocs);
+    free(univers -> table);
+    free(univers);
+}
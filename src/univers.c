@@ -0,0 +1,436 @@
+/**
+ * @file univers.c
+ * @author M3tex
+ * @brief Fichier contenant le moteur 'univers': un univers non borné découpé
+ * en blocs de 64 x 64 cellules (1 bit par cellule), rangés dans une table de
+ * hachage selon leurs coordonnées.
+ *
+ * Un bloc est créé quand des cellules peuvent naître sur son bord (un voisin
+ * a des cellules vivantes contre ce bord), et libéré dès qu'il est vide. La
+ * génération suivante d'un bloc est calculée avec le même noyau que le moteur
+ * bitboard (voir bloc_suivant()). Comme les tuiles des moteurs bornés, un bloc
+ * n'est recalculé que si lui ou un de ses voisins a changé.
+ * @version 0.1
+ * @date 2022-12-19
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "univers.h"
+#include "bitboard.h"
+#include "cycles.h"
+#include "utilitaires.h"
+
+
+
+
+/**
+ * @brief Fonction de hachage des coordonnées d'un bloc.
+ */
+static inline size_t hache_bloc(int64_t bx, int64_t by)
+{
+    uint64_t h = (uint64_t) bx * 0x9E3779B97F4A7C15ull ^ (uint64_t) by * 0xC2B2AE3D27D4EB4Full;
+    return (size_t) (h ^ (h >> 29));
+}
+
+
+
+/**
+ * @brief Retourne le bloc de coordonnées (bx, by), NULL s'il n'existe pas.
+ */
+static Bloc *cherche_bloc(Univers *univers, int64_t bx, int64_t by)
+{
+    size_t masque = univers -> taille_table - 1;
+    for (size_t h = hache_bloc(bx, by) & masque; univers -> table[h] != NULL; h = (h + 1) & masque)
+    {
+        Bloc *bloc = univers -> table[h];
+        if (bloc -> bx == bx && bloc -> by == by) return bloc;
+    }
+    return NULL;
+}
+
+
+
+/**
+ * @brief Range un bloc dans la table de hachage (il ne doit pas y être déjà).
+ */
+static void range_bloc(Univers *univers, Bloc *bloc)
+{
+    size_t masque = univers -> taille_table - 1;
+    size_t h = hache_bloc(bloc -> bx, bloc -> by) & masque;
+    while (univers -> table[h] != NULL) h = (h + 1) & masque;
+    univers -> table[h] = bloc;
+}
+
+
+
+/**
+ * @brief Retire un bloc de la table de hachage (sans le libérer). Les blocs
+ * qui suivent dans la même suite de cases sont recalés vers l'arrière, pour
+ * que la recherche ne s'arrête pas sur la case libérée.
+ */
+static void retire_bloc(Univers *univers, Bloc *bloc)
+{
+    size_t masque = univers -> taille_table - 1;
+    size_t trou = hache_bloc(bloc -> bx, bloc -> by) & masque;
+    while (univers -> table[trou] != bloc) trou = (trou + 1) & masque;
+
+    for (size_t h = (trou + 1) & masque; univers -> table[h] != NULL; h = (h + 1) & masque)
+    {
+        // Le bloc en h peut venir dans le trou si sa case idéale n'est pas entre le trou et h
+        Bloc *suivant = univers -> table[h];
+        size_t ideale = hache_bloc(suivant -> bx, suivant -> by) & masque;
+        if (((h - ideale) & masque) < ((h - trou) & masque)) continue;
+        univers -> table[trou] = suivant;
+        trou = h;
+    }
+    univers -> table[trou] = NULL;
+}
+
+
+
+/**
+ * @brief Reconstruit la table de hachage à partir de la liste des blocs (si
+ * elle est trop remplie, ou trop grande après la suppression de blocs).
+ */
+static void reconstruit_table(Univers *univers)
+{
+    // On garde la table remplie au plus à moitié
+    size_t taille = 128;
+    while (taille < 2 * univers -> nb_blocs) taille *= 2;
+
+    if (taille != univers -> taille_table)
+    {
+        free(univers -> table);
+        univers -> table = (Bloc **) malloc(sizeof(Bloc *) * taille);
+        if (univers -> table == NULL) quitter("Impossible d'allouer de la mémoire pour l'univers\n", 2);
+        univers -> taille_table = taille;
+    }
+    memset(univers -> table, 0, sizeof(Bloc *) * taille);
+    for (size_t i = 0; i < univers -> nb_blocs; i++) range_bloc(univers, univers -> blocs[i]);
+}
+
+
+
+/**
+ * @brief Retourne le bloc de coordonnées (bx, by), en le créant (vide) s'il
+ * n'existe pas encore.
+ */
+static Bloc *obtient_bloc(Univers *univers, int64_t bx, int64_t by)
+{
+    Bloc *bloc = cherche_bloc(univers, bx, by);
+    if (bloc != NULL) return bloc;
+
+    bloc = (Bloc *) calloc(1, sizeof(Bloc));
+    if (bloc == NULL) quitter("Impossible d'allouer de la mémoire pour l'univers\n", 2);
+    bloc -> bx = bx;
+    bloc -> by = by;
+    bloc -> a_calculer = 1;
+
+    if (univers -> nb_blocs == univers -> capacite)
+    {
+        univers -> capacite *= 2;
+        univers -> blocs = (Bloc **) realloc(univers -> blocs, sizeof(Bloc *) * univers -> capacite);
+        if (univers -> blocs == NULL) quitter("Impossible d'allouer de la mémoire pour l'univers\n", 2);
+    }
+    univers -> blocs[univers -> nb_blocs++] = bloc;
+
+    if (2 * univers -> nb_blocs > univers -> taille_table) reconstruit_table(univers);
+    else range_bloc(univers, bloc);
+    return bloc;
+}
+
+
+
+/**
+ * @brief Crée les voisins d'un bloc dans lesquels des cellules peuvent naître
+ * à la génération suivante: ceux qui touchent un bord (ou un coin) du bloc
+ * contenant des cellules vivantes.
+ */
+static void cree_voisins(Univers *univers, Bloc *bloc)
+{
+    // + lisible
+    const uint64_t *vivantes = bloc -> vivantes[univers -> courant];
+    int64_t bx = bloc -> bx, by = bloc -> by;
+
+    uint64_t colonnes = 0;
+    for (unsigned int r = 0; r < TAILLE_BLOC; r++) colonnes |= vivantes[r];
+    if (colonnes == 0) return;
+
+    // La colonne de gauche est le bit 0, celle de droite le bit 63
+    uint64_t haut = vivantes[0], bas = vivantes[TAILLE_BLOC - 1];
+    if (haut) obtient_bloc(univers, bx, by - 1);
+    if (bas) obtient_bloc(univers, bx, by + 1);
+    if (colonnes & 1) obtient_bloc(univers, bx - 1, by);
+    if (colonnes >> 63) obtient_bloc(univers, bx + 1, by);
+    if (haut & 1) obtient_bloc(univers, bx - 1, by - 1);
+    if (haut >> 63) obtient_bloc(univers, bx + 1, by - 1);
+    if (bas & 1) obtient_bloc(univers, bx - 1, by + 1);
+    if (bas >> 63) obtient_bloc(univers, bx + 1, by + 1);
+}
+
+
+
+/**
+ * @brief Demande le calcul d'un bloc et de ses 8 voisins à la prochaine
+ * génération (après un changement du bloc).
+ */
+static void reveille_voisins(Univers *univers, Bloc *bloc)
+{
+    for (int64_t i = -1; i <= 1; i++)
+    {
+        for (int64_t j = -1; j <= 1; j++)
+        {
+            Bloc *voisin = (i == 0 && j == 0) ? bloc : cherche_bloc(univers, bloc -> bx + j, bloc -> by + i);
+            if (voisin != NULL) voisin -> a_calculer = 1;
+        }
+    }
+}
+
+
+
+/**
+ * @brief Remplit la fenêtre utilisée par bloc_suivant(): le bloc et une
+ * bordure d'une cellule prise dans ses 8 voisins (0 si le voisin n'existe pas).
+ */
+static void remplit_fenetre(Univers *univers, Bloc *bloc, uint64_t fenetre[TAILLE_BLOC + 2][3])
+{
+    unsigned int c = univers -> courant;
+    Bloc *voisins[3][3];
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+        {
+            voisins[i][j] = (i == 1 && j == 1) ? bloc : cherche_bloc(univers, bloc -> bx + j - 1, bloc -> by + i - 1);
+        }
+    }
+
+    // Lignes du dessus et du dessous
+    for (int j = 0; j < 3; j++)
+    {
+        fenetre[0][j] = voisins[0][j] != NULL ? voisins[0][j] -> vivantes[c][TAILLE_BLOC - 1] : 0;
+        fenetre[TAILLE_BLOC + 1][j] = voisins[2][j] != NULL ? voisins[2][j] -> vivantes[c][0] : 0;
+    }
+
+    // Le bloc et les mots de gauche et de droite
+    for (unsigned int r = 0; r < TAILLE_BLOC; r++)
+    {
+        fenetre[r + 1][0] = voisins[1][0] != NULL ? voisins[1][0] -> vivantes[c][r] : 0;
+        fenetre[r + 1][1] = bloc -> vivantes[c][r];
+        fenetre[r + 1][2] = voisins[1][2] != NULL ? voisins[1][2] -> vivantes[c][r] : 0;
+    }
+}
+
+
+
+/**
+ * @brief Calcule la génération suivante de tout l'univers: on crée d'abord
+ * les blocs où des cellules peuvent naître, on calcule les blocs qui peuvent
+ * changer, puis on libère ceux qui sont devenus vides.
+ *
+ * Un bloc stable dont les voisins sont stables ne peut pas changer: il n'est
+ * pas recalculé (ses 2 générations sont déjà identiques). Les blocs qui ont
+ * changé réveillent leurs voisins pour la génération suivante.
+ *
+ * @param univers Un pointeur sur l'univers à mettre à jour
+ * @param regle Un pointeur sur la règle du jeu (sans naissance à 0 voisin)
+ * @param partielles Un pointeur sur les statistiques (additionnées, comme pour
+ * maj_bitgrille()), NULL pour ne pas les calculer
+ * @param empreinte Un pointeur sur l'empreinte de la génération, mise à jour
+ * avec les lignes qui changent (voir cycles.c), NULL pour ne pas la calculer
+ */
+void maj_univers(Univers *univers, const Regle *regle, Stats *partielles, uint64_t *empreinte)
+{
+    // Les blocs créés ici sont vides: pas besoin de regarder leurs voisins
+    size_t nb_blocs = univers -> nb_blocs;
+    for (size_t i = 0; i < nb_blocs; i++) cree_voisins(univers, univers -> blocs[i]);
+
+    unsigned int c = univers -> courant;
+    unsigned long int en_vie = 0, originelles = 0, nes = 0, mortes = 0, calcules = 0;
+    uint64_t fenetre[TAILLE_BLOC + 2][3];
+
+    // change[i] vaut 1 si le bloc i a changé (les blocs ne sont réveillés qu'une fois tous calculés)
+    char *change = (char *) calloc(univers -> nb_blocs, 1);
+    if (change == NULL && univers -> nb_blocs) quitter("Impossible d'allouer de la mémoire pour l'univers\n", 2);
+    for (size_t i = 0; i < univers -> nb_blocs; i++)
+    {
+        Bloc *bloc = univers -> blocs[i];
+
+        // Rien n'a pu changer: la génération suivante est déjà dans vivantes[1 - c]
+        if (!bloc -> a_calculer)
+        {
+            if (partielles == NULL) continue;
+            for (unsigned int r = 0; r < TAILLE_BLOC; r++)
+            {
+                en_vie += __builtin_popcountll(bloc -> vivantes[c][r]);
+                originelles += __builtin_popcountll(bloc -> originelles[r]);
+            }
+            continue;
+        }
+
+        remplit_fenetre(univers, bloc, fenetre);
+        bloc_suivant((const uint64_t (*)[3]) fenetre, bloc -> vivantes[1 - c], regle);
+        bloc -> a_calculer = 0;
+        calcules++;
+
+        for (unsigned int r = 0; r < TAILLE_BLOC; r++)
+        {
+            uint64_t ancien = bloc -> vivantes[c][r], nouveau = bloc -> vivantes[1 - c][r];
+            if (ancien != nouveau)
+            {
+                change[i] = 1;
+                if (empreinte != NULL) *empreinte ^= empreinte_mot(ancien, cle_bloc(bloc, r)) ^ empreinte_mot(nouveau, cle_bloc(bloc, r));
+            }
+            if (partielles == NULL) continue;
+            en_vie += __builtin_popcountll(ancien);
+            originelles += __builtin_popcountll(bloc -> originelles[r]);
+            nes += __builtin_popcountll(nouveau & ~ancien);
+            mortes += __builtin_popcountll(ancien & ~nouveau);
+        }
+    }
+    if (partielles != NULL)
+    {
+        partielles -> en_vie += en_vie;
+        partielles -> nb_cell_originelles += originelles;
+        partielles -> nb_cell_nes += nes;
+        partielles -> nb_cell_mortes += mortes;
+        partielles -> nb_tuiles_actives += calcules;
+    }
+
+    // La génération suivante devient la génération courante
+    c = univers -> courant = 1 - c;
+
+    // Les voisins des blocs qui ont changé (même s'ils sont devenus vides) devront être recalculés
+    for (size_t i = 0; i < univers -> nb_blocs; i++)
+    {
+        if (change[i]) reveille_voisins(univers, univers -> blocs[i]);
+    }
+    free(change);
+
+    // On libère les blocs vides (on ne peut plus le faire pendant le calcul)
+    size_t garde = 0;
+    for (size_t i = 0; i < univers -> nb_blocs; i++)
+    {
+        Bloc *bloc = univers -> blocs[i];
+        uint64_t vivantes = 0;
+        for (unsigned int r = 0; r < TAILLE_BLOC; r++)
+        {
+            bloc -> originelles[r] &= bloc -> vivantes[c][r];
+            vivantes |= bloc -> vivantes[c][r];
+        }
+
+        if (vivantes != 0)
+        {
+            univers -> blocs[garde++] = bloc;
+            continue;
+        }
+        retire_bloc(univers, bloc);
+        free(bloc);
+    }
+    univers -> nb_blocs = garde;
+
+    // La table ne rétrécit que si elle est devenue beaucoup trop grande
+    if (univers -> taille_table > 128 && 8 * univers -> nb_blocs < univers -> taille_table) reconstruit_table(univers);
+}
+
+
+
+/**
+ * @brief Compte les cellules originelles de l'univers (à la génération actuelle).
+ *
+ * @param univers Un pointeur sur l'univers
+ * @return unsigned long int Le nombre de cellules originelles
+ */
+unsigned long int originelles_univers(const Univers *univers)
+{
+    unsigned long int originelles = 0;
+    for (size_t i = 0; i < univers -> nb_blocs; i++)
+    {
+        for (unsigned int r = 0; r < TAILLE_BLOC; r++) originelles += __builtin_popcountll(univers -> blocs[i] -> originelles[r]);
+    }
+    return originelles;
+}
+
+
+
+/**
+ * @brief Charge le contenu d'une Grille dans l'univers: la cellule (i, j) de
+ * la grille devient la cellule (x + i, y + j) de l'univers. Les cellules déjà
+ * dans l'univers sont gardées.
+ *
+ * @param grille Un pointeur sur la grille à charger
+ * @param univers Un pointeur sur l'univers
+ * @param x L'abscisse dans l'univers de la colonne 0 de la grille
+ * @param y L'ordonnée dans l'univers de la ligne 0 de la grille
+ */
+void grille2univers(Grille *grille, Univers *univers, int64_t x, int64_t y)
+{
+    // + lisible
+    unsigned int taille = grille -> taille;
+    unsigned int c = univers -> courant;
+
+    for (unsigned int i = 0; i < taille; i++)
+    {
+        for (unsigned int j = 0; j < taille; j++)
+        {
+            cellule cell = CELLULE(grille, i, j);
+            if (!cell) continue;
+
+            // Division arrondie vers -l'infini (les coordonnées peuvent être négatives)
+            int64_t ux = x + j, uy = y + i;
+            int64_t bx = (ux >= 0) ? ux / TAILLE_BLOC : -((-ux + TAILLE_BLOC - 1) / TAILLE_BLOC);
+            int64_t by = (uy >= 0) ? uy / TAILLE_BLOC : -((-uy + TAILLE_BLOC - 1) / TAILLE_BLOC);
+            unsigned int bj = ux - bx * TAILLE_BLOC, bi = uy - by * TAILLE_BLOC;
+
+            Bloc *bloc = obtient_bloc(univers, bx, by);
+            bloc -> vivantes[c][bi] |= (uint64_t) 1 << bj;
+            bloc -> originelles[bi] |= (uint64_t) (cell >> 7) << bj;
+        }
+    }
+
+    // Les blocs ont pu changer: tout est recalculé à la prochaine génération
+    for (size_t i = 0; i < univers -> nb_blocs; i++) univers -> blocs[i] -> a_calculer = 1;
+}
+
+
+
+/**
+ * @brief Écrit dans la grille la partie de l'univers dont le coin supérieur
+ * gauche est (x, y). L'âge des cellules n'est pas suivi: les cellules vivantes
+ * ont un âge de 1.
+ *
+ * @param univers Un pointeur sur l'univers
+ * @param grille Un pointeur sur la grille où écrire
+ * @param x L'abscisse dans l'univers de la colonne 0 de la grille
+ * @param y L'ordonnée dans l'univers de la ligne 0 de la grille
+ */
+void univers2grille(Univers *univers, Grille *grille, int64_t x, int64_t y)
+{
+    // + lisible
+    int64_t taille = grille -> taille;
+    unsigned int c = univers -> courant;
+
+    memset(grille -> matrice - grille -> pas - ALIGNEMENT_GRILLE, 0, (size_t) (taille + 2) * grille -> pas);
+    for (size_t i = 0; i < univers -> nb_blocs; i++)
+    {
+        Bloc *bloc = univers -> blocs[i];
+        int64_t x0 = bloc -> bx * TAILLE_BLOC - x, y0 = bloc -> by * TAILLE_BLOC - y;
+        if (x0 >= taille || y0 >= taille || x0 + TAILLE_BLOC <= 0 || y0 + TAILLE_BLOC <= 0) continue;
+
+        for (int64_t r = 0; r < TAILLE_BLOC; r++)
+        {
+            if (y0 + r < 0 || y0 + r >= taille) continue;
+
+            uint64_t vivantes = bloc -> vivantes[c][r];
+            while (vivantes)
+            {
+                int64_t j = __builtin_ctzll(vivantes);
+                vivantes &= vivantes - 1;
+                if (x0 + j < 0 || x0 + j >= taille) continue;
+                CELLULE(grille, y0 + r, x0 + j) = (cellule) ((((bloc -> originelles[r] >> j) & 1) << 7) | 1);
+            }
+        }
+    }
+}
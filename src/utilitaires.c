@@ -227,6 +227,34 @@ char string2uint(char *s, unsigned int *result)
 
 
 
+/**
+ * @brief Permet de convertir une chaîne de caractères en entier non signé
+ * sur 64 bits (pour les graines). Prend en charge la chaine "0".
+ *
+ * @param s La chaîne à convertir
+ * @param result Le pointeur vers l'entier où stocker le résultat.
+ * @return int 1 si conversion réussie, 0 sinon.
+ */
+char string2uint64(char *s, uint64_t *result)
+{
+    int len = strlen(s);
+    if (len == 0 || !is_int(s) || s[0] == '-') return 0;
+
+    uint64_t tmp = 0;
+    for (int i = 0; i < len; i++)
+    {
+        // tmp = 10 * tmp + s[i], sans dépasser la taille d'un uint64_t
+        if (__builtin_mul_overflow(tmp, 10, &tmp) || __builtin_add_overflow(tmp, (uint64_t) (s[i] - '0'), &tmp))
+        {
+            return 0;
+        }
+    }
+    *result = tmp;
+    return 1;
+}
+
+
+
 /**
  * @brief Demande à l'utilisateur de saisir un entier.
  *